@@ -1,6 +1,8 @@
 /* bt_example_posix.c
- * POSIX demo for the simplified Behavior Tree (no parallel/repeater/timer).
- * Demonstrates: SEQUENCE / SELECTOR / INVERTER, with blackboard and user_data.
+ * POSIX demo for the simplified Behavior Tree.
+ * Demonstrates: SEQUENCE / SELECTOR, with blackboard and user_data, ticked by
+ * bt_tick_exec() with a timer wheel so that sleeping leaves cost nothing, and a
+ * multi-tick leaf written as a coroutine (bt_co.h).
  *
  * Scenario:
  *   Root = SELECTOR(
@@ -15,38 +17,67 @@
  *                 upload_once                  // attempt once; if fails, sequence fails
  *               )
  *             ),
- *             recharge                          // fallback if work fails
+ *             recharge                          // fallback if work fails (sleeps while charging)
  *          )
  *
  * Expected behavior:
  *  - When battery is sufficient, the device works: collect progresses (RUNNING),
  *    obstacle is handled or passed, upload attempts once (fails in this demo),
  *    causing the outer SELECTOR to switch to recharge.
+ *  - Recharge arms its time anchor and is parked in the timer wheel. The host
+ *    loop is tickless: while only anchors are pending it sleeps until the
+ *    earliest one instead of ticking every period.
  *  - After recharge, battery is full and the loop repeats.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "bt.h"
+#include "bt_co.h"
+#include "bt_exec.h"
+#include "bt_timer.h"
 
 #include <stdio.h>
-#include <sys/time.h>
-#include <unistd.h>
+#include <time.h>
+
+/* Tick period while some leaf is polling */
+#define APP_PERIOD_MS (500U)
 
-/* Helper: get current time in milliseconds (wrap to uint32_t) */
+/* Helper: get monotonic time in milliseconds (wrap to uint32_t) */
 static uint32_t bt_get_time_ms(void) {
-  struct timeval tv;
-  (void)gettimeofday(&tv, BT_NULL);
-  return (uint32_t)(tv.tv_sec * 1000UL + (uint32_t)(tv.tv_usec / 1000UL));
+  struct timespec ts;
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL);
+}
+
+/* Helper: sleep until deadline_ms on the bt_get_time_ms() clock.
+ * The wake-up time is absolute, so time spent ticking does not add drift.
+ */
+static void app_sleep_until(uint32_t deadline_ms) {
+  const int32_t delay = (int32_t)(deadline_ms - bt_get_time_ms());
+
+  if (delay > 0) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += (time_t)(delay / 1000);
+    ts.tv_nsec += (long)(delay % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+    }
+    (void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, BT_NULL);
+  }
 }
 
-/* Forward declaration: time-anchor checker used by leaf callbacks */
-static bool bt_time_anchor_ready(bt_node_t* node);
+/* How long recharging keeps the recharge leaf asleep */
+#define APP_CHARGE_MS (1200U)
 
 /* ===== Blackboard / context ===== */
 typedef struct {
   uint32_t battery;          /* [0..100] percent */
-  uint32_t collect_progress; /* 0..N, when reaches threshold => success */
   uint32_t obstacle_flag;    /* 0 = none, 1 = present */
   uint32_t upload_attempt;   /* count attempts; we demo failure at first try */
+  uint32_t charging;         /* 1 while the charger is connected */
 } app_ctx_t;
 
 /* ===== Leaf callbacks ===== */
@@ -56,9 +87,6 @@ static bt_status_t cb_check_battery(bt_node_t* node) {
   bt_status_t res = BT_ERROR;
 
   if ((node != BT_NULL) && (node->blackboard != BT_NULL)) {
-    if (!bt_time_anchor_ready(node)) {
-      return BT_RUNNING;
-    }
     const app_ctx_t* ctx = (const app_ctx_t*)node->blackboard;
     const uint32_t* threshold = (const uint32_t*)node->user_data;
     uint32_t th = 30U;
@@ -79,40 +107,27 @@ static bt_status_t cb_check_battery(bt_node_t* node) {
   return res;
 }
 
-/* Action: collect data (takes N ticks to complete; N stored in user_data as uint32_t*) */
+/* Action: collect data (takes N ticks to complete; N stored in user_data as uint32_t*).
+ * Written as a coroutine: the step count lives in its bt_co_t (BT_CO_VAR), and
+ * the leaf starts over by itself each time it is entered again.
+ */
 static bt_status_t cb_collect(bt_node_t* node) {
-  bt_status_t res = BT_ERROR;
+  app_ctx_t* ctx = (app_ctx_t*)node->blackboard;
+  const uint32_t* need_ptr = (const uint32_t*)node->user_data;
+  const uint32_t need = (need_ptr != BT_NULL) ? *need_ptr : 3U;
 
-  if ((node != BT_NULL) && (node->blackboard != BT_NULL)) {
-    if (!bt_time_anchor_ready(node)) {
-      return BT_RUNNING;
-    }
-    app_ctx_t* ctx = (app_ctx_t*)node->blackboard;
-    const uint32_t* need_ptr = (const uint32_t*)node->user_data;
-    uint32_t need = 3U;
+  BT_CO_BEGIN(node);
+  for (BT_CO_VAR(node, 0U) = 1U; BT_CO_VAR(node, 0U) <= need; BT_CO_VAR(node, 0U)++) {
+    (void)printf("[collect] progress=%u/%u, battery=%u%%\n", (unsigned)BT_CO_VAR(node, 0U), (unsigned)need,
+                 (unsigned)ctx->battery);
 
-    if (need_ptr != BT_NULL) {
-      need = *need_ptr;
+    if (ctx->battery > 0U) {
+      ctx->battery--;
     }
-
-    if (ctx->collect_progress < need) {
-      ctx->collect_progress++;
-      (void)printf("[collect] progress=%u/%u, battery=%u%%\n", (unsigned)ctx->collect_progress, (unsigned)need,
-                   (unsigned)ctx->battery);
-
-      if (ctx->battery > 0U) {
-        ctx->battery--;
-      }
-      res = BT_RUNNING;
-    } else {
-      (void)printf("[collect] done.\n");
-      res = BT_SUCCESS;
-    }
-  } else {
-    res = BT_ERROR;
+    BT_CO_YIELD(node);
   }
-
-  return res;
+  (void)printf("[collect] done.\n");
+  BT_CO_END(node, BT_SUCCESS);
 }
 
 /* Action: handle obstacle if present; succeed only if obstacle_flag==1, then clear it */
@@ -120,9 +135,6 @@ static bt_status_t cb_handle_obstacle(bt_node_t* node) {
   bt_status_t res = BT_ERROR;
 
   if ((node != BT_NULL) && (node->blackboard != BT_NULL)) {
-    if (!bt_time_anchor_ready(node)) {
-      return BT_RUNNING;
-    }
     app_ctx_t* ctx = (app_ctx_t*)node->blackboard;
 
     if (ctx->obstacle_flag != 0U) {
@@ -144,9 +156,6 @@ static bt_status_t cb_pass_through(bt_node_t* node) {
   bt_status_t res = BT_ERROR;
 
   if ((node != BT_NULL) && (node->blackboard != BT_NULL)) {
-    if (!bt_time_anchor_ready(node)) {
-      return BT_RUNNING;
-    }
     (void)node;
     (void)printf("[avoid] nothing to do, pass-through.\n");
     res = BT_SUCCESS;
@@ -162,9 +171,6 @@ static bt_status_t cb_upload_once(bt_node_t* node) {
   bt_status_t res = BT_ERROR;
 
   if ((node != BT_NULL) && (node->blackboard != BT_NULL)) {
-    if (!bt_time_anchor_ready(node)) {
-      return BT_RUNNING;
-    }
     app_ctx_t* ctx = (app_ctx_t*)node->blackboard;
     ctx->upload_attempt++;
 
@@ -187,15 +193,21 @@ static bt_status_t cb_recharge(bt_node_t* node) {
   bt_status_t res = BT_ERROR;
 
   if ((node != BT_NULL) && (node->blackboard != BT_NULL)) {
-    if (!bt_time_anchor_ready(node)) {
-      return BT_RUNNING;
-    }
     app_ctx_t* ctx = (app_ctx_t*)node->blackboard;
-    (void)printf("[recharge] charging...\n");
-    ctx->battery = 100U;
-    ctx->collect_progress = 0U;
-    /* NOTE: keep upload_attempt as-is so upload attempts persist across cycles */
-    res = BT_SUCCESS;
+
+    if (ctx->charging == 0U) {
+      /* Sleep until charged: the engine parks this leaf until the anchor */
+      (void)printf("[recharge] charging for %u ms...\n", (unsigned)APP_CHARGE_MS);
+      ctx->charging = 1U;
+      node->time_anchor_ms = bt_get_time_ms() + APP_CHARGE_MS;
+      res = BT_RUNNING;
+    } else {
+      (void)printf("[recharge] done.\n");
+      ctx->charging = 0U;
+      ctx->battery = 100U;
+      /* NOTE: keep upload_attempt as-is so upload attempts persist across cycles */
+      res = BT_SUCCESS;
+    }
   } else {
     res = BT_ERROR;
   }
@@ -216,30 +228,19 @@ static const char* bt_node_type_to_str(uint32_t type) {
       return "CONDITION";
     case BT_INVERTER:
       return "INVERTER";
+    case BT_PARALLEL:
+      return "PARALLEL";
+    case BT_ASYNC:
+      return "ASYNC";
+    case BT_REACTIVE_SEQUENCE:
+      return "REACTIVE_SEQUENCE";
+    case BT_REACTIVE_SELECTOR:
+      return "REACTIVE_SELECTOR";
     default:
       return "UNKNOWN";
   }
 }
 
-/* Check time anchor: if time_anchor_ms==0 => ready; otherwise wait until now >= anchor.
- * When anchor reached, clear it (set to 0) so logic runs only once.
- */
-static bool bt_time_anchor_ready(bt_node_t* node) {
-  if ((node == BT_NULL) || (node->time_anchor_ms == 0U)) {
-    return true;
-  }
-
-  uint32_t now = bt_get_time_ms();
-  if (now >= node->time_anchor_ms) {
-    node->time_anchor_ms = 0U; /* consume anchor */
-    return true;
-  }
-
-  (void)printf("[time] node type=%s waiting until %u ms (now %u)\n", bt_node_type_to_str((uint32_t)node->type),
-               (unsigned)node->time_anchor_ms, (unsigned)now);
-  return false;
-}
-
 static void on_enter_log(bt_node_t* node) {
   if (node != BT_NULL) {
     (void)printf(">> enter node type=%s\n", bt_node_type_to_str((uint32_t)node->type));
@@ -253,12 +254,11 @@ static void on_exit_log(bt_node_t* node) {
   }
 }
 
-/* on_enter for the outer work sequence: reset collect progress at start of work */
+/* on_enter for the outer work sequence: log the start of a work cycle */
 static void on_enter_work(bt_node_t* node) {
   if ((node != BT_NULL) && (node->blackboard != BT_NULL)) {
-    app_ctx_t* ctx = (app_ctx_t*)node->blackboard;
-    ctx->collect_progress = 0U;
-    (void)printf(">> work sequence enter: reset collect_progress\n");
+    const app_ctx_t* ctx = (const app_ctx_t*)node->blackboard;
+    (void)printf(">> work sequence enter: battery=%u%%\n", (unsigned)ctx->battery);
   }
 }
 
@@ -270,13 +270,24 @@ int main(void) {
   uint32_t collect_ticks_need = 3U;
 
   ctx.battery = 35U; /* start slightly above threshold so we see work first */
-  ctx.collect_progress = 0U;
   ctx.obstacle_flag = 1U; /* there is an obstacle initially */
   ctx.upload_attempt = 0U;
+  ctx.charging = 0U;
+
+  /* Engine: frame stack for the 5-level tree, timer wheel for time anchors */
+  BT_EXEC_FRAMES(frames, 5U);
+  bt_exec_t exec;
+  bt_timer_wheel_t timers;
+  bt_timer_entry_t timer_entries[1]; /* Only Recharge sleeps */
+
+  (void)BT_TIMER_INIT(&timers, timer_entries, bt_get_time_ms());
+  (void)BT_EXEC_INIT(&exec, frames);
+  bt_exec_set_timers(&exec, &timers);
 
   /* Declare nodes */
   bt_node_t nd_check_batt;
   bt_node_t nd_collect;
+  bt_co_t collect_co; /* Resume point and step count of Collect */
   bt_node_t nd_handle_obst;
   bt_node_t nd_pass_through;
   bt_node_t nd_upload_once;
@@ -296,6 +307,7 @@ int main(void) {
   /* Initialize leaves */
   bt_init(&nd_check_batt, BT_CONDITION, cb_check_battery, BT_NULL, 0U, &battery_threshold);
   bt_init(&nd_collect, BT_ACTION, cb_collect, BT_NULL, 0U, &collect_ticks_need);
+  (void)bt_set_co(&nd_collect, &collect_co);
   bt_init(&nd_handle_obst, BT_ACTION, cb_handle_obstacle, BT_NULL, 0U, BT_NULL);
   bt_init(&nd_pass_through, BT_ACTION, cb_pass_through, BT_NULL, 0U, BT_NULL);
   bt_init(&nd_upload_once, BT_ACTION, cb_upload_once, BT_NULL, 0U, BT_NULL);
@@ -321,15 +333,27 @@ int main(void) {
   nd_pass_through.blackboard = &ctx;
   nd_upload_once.blackboard = &ctx;
   nd_recharge.blackboard = &ctx;
-  /* give the outer work sequence access so its on_enter hook can reset progress */
+  /* give the outer work sequence access so its on_enter hook can log the battery */
   nd_work_sequence_outer.blackboard = &ctx;
 
   /* Drive the tree for several iterations */
   for (uint32_t i = 0U; i < 20U; i++) {
-    const bt_status_t s = bt_tick(&nd_root_selector);
+    /* One clock read per frame; expired anchors wake their nodes */
+    const uint32_t now = bt_get_time_ms();
+    bt_wake_t wake;
+
+    (void)bt_timer_advance(&timers, now);
+
+    const bt_status_t s = bt_tick_exec_next(&exec, &nd_root_selector, &wake);
     (void)printf("[main] tick=%u => root status=%u, battery=%u%%\n", (unsigned)i, (unsigned)s, (unsigned)ctx.battery);
 
-    (void)usleep(500000); /* 500 ms */
+    if (wake.kind == BT_WAKE_TIMER) {
+      /* Only waiting on anchors: sleep straight to the earliest one */
+      (void)printf("[main] idle, sleeping %u ms\n", (unsigned)(wake.deadline_ms - now));
+      app_sleep_until(wake.deadline_ms);
+    } else {
+      app_sleep_until(now + APP_PERIOD_MS);
+    }
 
     /* Drain battery faster after a few ticks to trigger recharge path */
     if (i == 8U) {
@@ -341,9 +365,11 @@ int main(void) {
 }
 
 /*
-$ gcc -Wall -Wextra -O2 bt_example_posix.c c-behavior-tree.c -o bt_demo
+Build with the bt_example_posix CMake target, or by hand:
+$ gcc -Wall -Wextra -O2 -Iinclude examples/bt_example_posix.c src/bt.c src/bt_async.c src/bt_exec.c \
+      src/bt_timer.c src/bt_trace.c -o bt_demo
 $ ./bt_demo
->> work sequence enter: reset collect_progress
+>> work sequence enter: battery=35%
 >> enter node type=SEQUENCE
 [collect] progress=1/3, battery=35%
 [main] tick=0 => root status=2, battery=34%
@@ -355,56 +381,58 @@ $ ./bt_demo
 [avoid] obstacle detected -> avoiding...
 [upload] attempt #1 -> FAILURE
 << exit  node type=SEQUENCE with status=1
-[recharge] charging...
-[main] tick=3 => root status=0, battery=100%
->> work sequence enter: reset collect_progress
+[recharge] charging for 1200 ms...
+[main] tick=3 => root status=2, battery=32%
+[main] idle, sleeping 1200 ms
+[recharge] done.
+[main] tick=4 => root status=0, battery=100%
+>> work sequence enter: battery=100%
 >> enter node type=SEQUENCE
 [collect] progress=1/3, battery=100%
-[main] tick=4 => root status=2, battery=99%
+[main] tick=5 => root status=2, battery=99%
 [collect] progress=2/3, battery=99%
-[main] tick=5 => root status=2, battery=98%
+[main] tick=6 => root status=2, battery=98%
 [collect] progress=3/3, battery=98%
-[main] tick=6 => root status=2, battery=97%
+[main] tick=7 => root status=2, battery=97%
 [collect] done.
 [avoid] nothing to do, pass-through.
 [upload] attempt #2 -> SUCCESS
 << exit  node type=SEQUENCE with status=0
-[main] tick=7 => root status=0, battery=97%
->> work sequence enter: reset collect_progress
->> enter node type=SEQUENCE
-[collect] progress=1/3, battery=97%
-[main] tick=8 => root status=2, battery=96%
-[collect] progress=2/3, battery=10%
-[main] tick=9 => root status=2, battery=9%
-[collect] progress=3/3, battery=9%
-[main] tick=10 => root status=2, battery=8%
-[collect] done.
-[avoid] nothing to do, pass-through.
-[upload] attempt #3 -> SUCCESS
-<< exit  node type=SEQUENCE with status=0
-[main] tick=11 => root status=0, battery=8%
->> work sequence enter: reset collect_progress
-[recharge] charging...
-[main] tick=12 => root status=0, battery=100%
->> work sequence enter: reset collect_progress
+[main] tick=8 => root status=0, battery=97%
+>> work sequence enter: battery=10%
+[recharge] charging for 1200 ms...
+[main] tick=9 => root status=2, battery=10%
+[main] idle, sleeping 1200 ms
+[recharge] done.
+[main] tick=10 => root status=0, battery=100%
+>> work sequence enter: battery=100%
 >> enter node type=SEQUENCE
 [collect] progress=1/3, battery=100%
-[main] tick=13 => root status=2, battery=99%
+[main] tick=11 => root status=2, battery=99%
 [collect] progress=2/3, battery=99%
-[main] tick=14 => root status=2, battery=98%
+[main] tick=12 => root status=2, battery=98%
 [collect] progress=3/3, battery=98%
-[main] tick=15 => root status=2, battery=97%
+[main] tick=13 => root status=2, battery=97%
 [collect] done.
 [avoid] nothing to do, pass-through.
-[upload] attempt #4 -> SUCCESS
+[upload] attempt #3 -> SUCCESS
 << exit  node type=SEQUENCE with status=0
-[main] tick=16 => root status=0, battery=97%
->> work sequence enter: reset collect_progress
+[main] tick=14 => root status=0, battery=97%
+>> work sequence enter: battery=97%
 >> enter node type=SEQUENCE
 [collect] progress=1/3, battery=97%
-[main] tick=17 => root status=2, battery=96%
+[main] tick=15 => root status=2, battery=96%
 [collect] progress=2/3, battery=96%
-[main] tick=18 => root status=2, battery=95%
+[main] tick=16 => root status=2, battery=95%
 [collect] progress=3/3, battery=95%
-[main] tick=19 => root status=2, battery=94%
-*/
\ No newline at end of file
+[main] tick=17 => root status=2, battery=94%
+[collect] done.
+[avoid] nothing to do, pass-through.
+[upload] attempt #4 -> SUCCESS
+<< exit  node type=SEQUENCE with status=0
+[main] tick=18 => root status=0, battery=94%
+>> work sequence enter: battery=94%
+>> enter node type=SEQUENCE
+[collect] progress=1/3, battery=94%
+[main] tick=19 => root status=2, battery=93%
+*/
@@ -4,9 +4,9 @@
  * Public API for a simplified Behavior Tree (BT) core.
  * This header defines the BT node types, status codes, the core
  * node structure `bt_node_t`, and the public functions used to
- * initialize nodes and tick the tree. Advanced features (parallel, repeaters, timers)
- * are omitted. The `time_anchor_ms` field is provided as an
- * optional placeholder for user-defined timing/decorator logic.
+ * initialize nodes and tick the tree. Advanced features (repeaters, timers)
+ * are omitted from the core. The `time_anchor_ms` field lets a node sleep
+ * until a given time when ticked by an engine with a timer wheel (bt_timer.h).
  */
 
 #ifndef C_BEHAVIOR_TREE_H
@@ -27,6 +27,14 @@
 #define BT_COUNT_OF(arr) (uint16_t)(sizeof(arr) / sizeof((arr)[0]))
 #endif
 
+/* Most children a PARALLEL node can have (width of its per-child bitsets) */
+#define BT_PARALLEL_MAX_CHILDREN (32U)
+
+#ifndef BT_VALIDATE_MAX_DEPTH
+/* Deepest tree accepted by bt_validate() (root = depth 1) */
+#define BT_VALIDATE_MAX_DEPTH (64U)
+#endif
+
 /* ===== Status and type enumerations ===== */
 
 typedef enum {
@@ -37,11 +45,15 @@ typedef enum {
 } bt_status_t;
 
 typedef enum {
-  BT_ACTION = 0U, /* Leaf node (perform an action)        */
-  BT_CONDITION,   /* Leaf node (check a condition)        */
-  BT_SEQUENCE,    /* Composite: run children in order     */
-  BT_SELECTOR,    /* Composite: first child that succeeds */
-  BT_INVERTER     /* Decorator: invert child status       */
+  BT_ACTION = 0U,       /* Leaf node (perform an action)        */
+  BT_CONDITION,         /* Leaf node (check a condition)        */
+  BT_SEQUENCE,          /* Composite: run children in order     */
+  BT_SELECTOR,          /* Composite: first child that succeeds */
+  BT_INVERTER,          /* Decorator: invert child status       */
+  BT_PARALLEL,          /* Composite: tick all children at once */
+  BT_ASYNC,             /* Leaf node (async operation)          */
+  BT_REACTIVE_SEQUENCE, /* SEQUENCE re-checking its guards      */
+  BT_REACTIVE_SELECTOR  /* SELECTOR re-checking its guards      */
 } bt_node_type_t;
 
 /* ===== Forward declarations ===== */
@@ -53,17 +65,43 @@ typedef bt_status_t (*bt_tick_fn)(struct bt_node_s* node);
 typedef void (*bt_enter_fn)(struct bt_node_s* node);
 typedef void (*bt_exit_fn)(struct bt_node_s* node);
 
+/* State of a PARALLEL node, attached with bt_set_parallel() */
+typedef struct {
+  uint16_t success_threshold; /* SUCCESS once this many children succeeded */
+  uint16_t failure_threshold; /* FAILURE once this many children failed */
+  uint32_t done_mask;         /* Children that finished in the current run (bit i = child i) */
+  uint32_t success_mask;      /* Children that finished with SUCCESS */
+} bt_parallel_t;
+
+/* State of a BT_ASYNC leaf's operation, attached with bt_set_async() (bt_async.h) */
+typedef struct {
+  uint32_t gen;       /* Incremented each time the leaf starts an operation */
+  bt_status_t result; /* BT_RUNNING while pending, then the posted status */
+} bt_async_op_t;
+
 /* ===== Core node structure =====
  * Notes:
  *  - No dynamic allocation is performed by the library.
  *  - Users create nodes statically or on stack and wire the tree manually.
- *  - time_anchor_ms is optional and unused by the core (reserved for user/decorators).
+ *  - time_anchor_ms is optional; bt_tick() ignores it, bt_tick_exec() with a
+ *    timer wheel skips the node until it is reached.
+ *  - BT_ASYNC leaves call tick once to start an operation and then wait for
+ *    its completion to be posted and drained (bt_async.h).
+ *  - Leaf callbacks written as coroutines keep their resume point and locals
+ *    in a bt_co_t attached to the node (bt_co.h).
+ *  - Reactive composites behave like SEQUENCE/SELECTOR, except that while a
+ *    child is RUNNING each tick first re-ticks the CONDITION children before
+ *    it (the guards). A guard that no longer gives the result that let the
+ *    composite move past it halts the running child (see bt_halt()) and
+ *    decides the tick in its place. Other earlier children are not
+ *    revisited. bt_tick() and bt_tick_exec() only: compiled trees, images and
+ *    generated code reject these types.
  */
 typedef struct bt_node_s {
   bt_node_type_t type;
   bt_status_t status;
 
-  /* Leaf behavior (ACTION/CONDITION) */
+  /* Leaf behavior (ACTION/CONDITION/ASYNC) */
   bt_tick_fn tick;
 
   /* Children (for composites/decorators) */
@@ -72,13 +110,24 @@ typedef struct bt_node_s {
 
   /* Runtime bookkeeping */
   uint16_t current_child; /* For SEQUENCE/SELECTOR progress */
+  uint16_t id;            /* Pre-order index from bt_assign_ids() (0 until assigned) */
+  bool validated;         /* Subtree passed bt_validate(); bt_tick() skips per-node checks */
+
+  /* Type-specific state, NULL when unused: bt_parallel_t of a PARALLEL,
+   * bt_async_op_t of a BT_ASYNC leaf, bt_co_t of a coroutine leaf */
+  void* ext;
 
   /* Optional lifecycle hooks (for any node type) */
   bt_enter_fn on_enter; /* Optional */
   bt_exit_fn on_exit;   /* Optional */
 
-  /* Optional POSIX time anchor placeholder (unused by core) */
+  /* Optional time anchor in ms: the node is not ticked before it (see bt_timer.h).
+   * bt_tick() ignores it; engines bound to a timer wheel park the node instead. */
   uint32_t time_anchor_ms;
+  uint16_t timer_entry; /* 1 + index of the wheel entry holding the node, 0 when not parked */
+
+  /* Blackboard keys the node reads, bit k = key k (see bt_watch.h) */
+  uint64_t reads;
 
   /* User payloads */
   void* user_data;  /* Opaque per-node data (optional) */
@@ -96,7 +145,57 @@ void bt_init(bt_node_t* node, bt_node_type_t type, bt_tick_fn tick_fn, bt_node_t
 /* Convenience helper to infer children_count for static arrays */
 #define BT_INIT(nodePtr, typeVal, fn, arr, data) bt_init((nodePtr), (typeVal), (fn), (arr), BT_COUNT_OF(arr), (data))
 
+/* Attach state to a PARALLEL node and set its thresholds.
+ * Every PARALLEL needs this before it is ticked (or validated); one without
+ * state settles BT_ERROR. state must outlive the node and is not shared; use
+ * success_threshold = children_count and failure_threshold = 1 for "all must
+ * succeed, any failure fails".
+ * Returns BT_SUCCESS, or BT_ERROR when node/state is NULL, node is not a
+ * PARALLEL node, has more than BT_PARALLEL_MAX_CHILDREN children, or a
+ * threshold is outside 1..children_count (node and state are then unchanged).
+ */
+bt_status_t bt_set_parallel(bt_node_t* node, bt_parallel_t* state, uint16_t success_threshold,
+                            uint16_t failure_threshold);
+
+/* Number the nodes of a tree in pre-order, the layout bt_compile() uses, so
+ * node->id matches the compiled index (root = 0). Ids identify nodes in
+ * traces and per-node statistics.
+ * Returns the number of nodes numbered (0 when root is NULL).
+ */
+uint16_t bt_assign_ids(bt_node_t* root);
+
+/* Check a whole tree once: every node reachable from root has a known type,
+ * leaves have a tick callback, BT_ASYNC leaves have operation state (see
+ * bt_set_async()), composites have a children array whose entries
+ * are all set, INVERTERs have exactly one child, PARALLEL policies are valid
+ * (see bt_set_parallel()), there is no cycle and no path is deeper than
+ * BT_VALIDATE_MAX_DEPTH.
+ * On success every node is flagged validated and bt_tick() on any of them
+ * runs a dispatch path without per-visit checks. The flag describes the
+ * wiring at the time of the call: bt_init() clears it on a node, and a tree
+ * must be validated again after any other change to types, children or
+ * callbacks.
+ * Returns BT_SUCCESS, or BT_ERROR (root's flag cleared) for an invalid tree.
+ */
+bt_status_t bt_validate(bt_node_t* root);
+
 /* Tick from the given node (usually the root) */
 bt_status_t bt_tick(bt_node_t* root);
 
+/* Abandon a RUNNING subtree: walk only its RUNNING path from node down
+ * (current_child of sequences and selectors, the child of an INVERTER, the
+ * unfinished children of a PARALLEL) and reset every node on it, so the cost
+ * is O(active path) rather than O(tree size).
+ * Each halted node gets the status bt_init() gives (BT_FAILURE) and cleared
+ * progress (current_child, PARALLEL bitsets), so its next tick enters it
+ * afresh; a coroutine leaf restarts and a pending BT_ASYNC completion becomes
+ * stale. on_exit fires on the halted composites and decorators, deepest
+ * first. Parked time anchors are left in their wheel; halt trees ticked with
+ * bt_tick_exec() through bt_exec_halt(), which cancels them.
+ * Halting a child of a RUNNING node leaves the parent RUNNING; its next tick
+ * enters the halted child again.
+ * Returns the number of nodes halted (0 when node is NULL or not RUNNING).
+ */
+uint16_t bt_halt(bt_node_t* node);
+
 #endif /* C_BEHAVIOR_TREE_H */
@@ -0,0 +1,115 @@
+/*
+ * bt_async.h
+ *
+ * Asynchronous leaves and their completion queue.
+ * A BT_ASYNC leaf's tick callback starts a long-running operation (I/O, a
+ * motion command, ...), hands bt_async_token(node) to whoever performs it and
+ * returns BT_RUNNING. The callback is not called again while the operation is
+ * pending. When the operation ends, any thread posts the token and the final
+ * status with bt_async_complete(); the ticking thread drains the queue before
+ * its next tick, and the leaf then reports that status. Until then the leaf
+ * costs no callback and no polling.
+ */
+
+#ifndef C_BEHAVIOR_TREE_ASYNC_H
+#define C_BEHAVIOR_TREE_ASYNC_H
+
+#include <stdatomic.h>
+
+#include "bt.h"
+
+/* ===== Tokens ===== */
+
+/* Identifies one operation of one BT_ASYNC leaf. A token whose operation was
+ * abandoned (the leaf finished or restarted) is stale; its completion is
+ * dropped when drained.
+ */
+typedef struct {
+  bt_node_t* node;
+  uint32_t gen; /* Operation generation (bt_async_op_t) when it started */
+} bt_async_token_t;
+
+/* ===== Completion queue =====
+ * Notes:
+ *  - Bounded multi-producer, single-consumer ring in caller-provided slots;
+ *    no allocation and no locks. Producers claim a slot with one CAS on tail
+ *    and publish it through the slot's sequence number.
+ *  - bt_async_complete() may be called from any thread (not from signal
+ *    handlers); bt_async_drain() only from the thread that ticks the tree.
+ *  - The capacity must be a power of two. A full queue rejects the post, so
+ *    size it for the operations that can be pending at once.
+ */
+typedef struct {
+  atomic_uint seq;         /* Slot turn: index when free, index + 1 when filled */
+  bt_async_token_t token;  /* Completed operation */
+  bt_status_t status;      /* Its final status */
+} bt_async_slot_t;
+
+/* Called by the producer after each post, e.g. to wake a sleeping host */
+typedef void (*bt_async_notify_fn)(void* ctx);
+
+typedef struct {
+  bt_async_slot_t* slots;         /* Caller-provided ring */
+  uint32_t mask;                  /* Capacity - 1 */
+  bt_async_notify_fn notify;      /* Optional */
+  void* notify_ctx;               /* Passed to notify */
+  _Alignas(64) atomic_uint tail;  /* Next position producers claim */
+  _Alignas(64) uint32_t head;     /* Next position the consumer reads */
+} bt_async_queue_t;
+
+/* ===== Public API ===== */
+
+/* Bind a ring of slots to a queue.
+ * Returns BT_SUCCESS, or BT_ERROR when queue/slots is NULL or capacity is not
+ * a power of two.
+ */
+bt_status_t bt_async_init(bt_async_queue_t* queue, bt_async_slot_t slots[], uint32_t capacity);
+
+/* Convenience helper for slot arrays with a static size */
+#define BT_ASYNC_INIT(queuePtr, slots) bt_async_init((queuePtr), (slots), BT_COUNT_OF(slots))
+
+/* Attach operation state to a BT_ASYNC leaf. Every BT_ASYNC leaf needs it
+ * before it is ticked (or validated); one without state settles BT_ERROR.
+ * op must outlive the node and is not shared.
+ * Returns BT_SUCCESS, or BT_ERROR when node/op is NULL or node is not BT_ASYNC.
+ */
+bt_status_t bt_set_async(bt_node_t* node, bt_async_op_t* op);
+
+/* Set (or clear with NULL) the hook called after each successful post. */
+void bt_async_set_notify(bt_async_queue_t* queue, bt_async_notify_fn notify, void* ctx);
+
+/* Token of the operation a BT_ASYNC leaf is starting; call it from the leaf's
+ * tick callback.
+ */
+static inline bt_async_token_t bt_async_token(bt_node_t* node) {
+  bt_async_token_t token;
+
+  token.node = node;
+  token.gen = ((const bt_async_op_t*)node->ext)->gen;
+  return token;
+}
+
+/* Post the final status of an operation. Thread-safe and lock-free.
+ * Returns:
+ *   - BT_SUCCESS when queued
+ *   - BT_FAILURE when the queue is full (retry later)
+ *   - BT_ERROR when queue or token.node is NULL, or status is not
+ *     BT_SUCCESS/BT_FAILURE/BT_ERROR
+ */
+bt_status_t bt_async_complete(bt_async_queue_t* queue, bt_async_token_t token, bt_status_t status);
+
+/* Deliver queued completions to their leaves; at most one queue capacity per
+ * call, so producers cannot keep the ticking thread here.
+ * Returns the number of leaves that received their status (stale ones are
+ * dropped and not counted). bt_tick_exec() calls it for its bound queue;
+ * with bt_tick(), call it before each tick.
+ */
+uint32_t bt_async_drain(bt_async_queue_t* queue);
+
+/* True while a BT_ASYNC leaf waits for its completion to be drained. */
+static inline bool bt_async_pending(const bt_node_t* node) {
+  return (node->type == BT_ASYNC) && (node->status == BT_RUNNING) && (node->ext != BT_NULL) &&
+         (((const bt_async_op_t*)node->ext)->result == BT_RUNNING);
+}
+
+#endif /* C_BEHAVIOR_TREE_ASYNC_H */
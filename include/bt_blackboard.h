@@ -0,0 +1,380 @@
+/*
+ * bt_blackboard.h
+ *
+ * Optional typed blackboard for node->blackboard.
+ * Keys are small integer ids assigned in declaration order (0, 1, 2, ...),
+ * so an enum of keys declared in the same order gives compile-time ids;
+ * loaders can intern keys by name instead and keep the returned id. Each key
+ * owns one typed slot in a caller-provided array, and reads and writes index
+ * it directly: names are hashed only by bt_blackboard_declare() and
+ * bt_blackboard_find(), never on the access path.
+ *
+ * Every slot carries a version counter that is bumped when its value
+ * changes, and the blackboard collects the changed keys as a bt_keys_t set,
+ * so conditions can cache results per version and hosts can feed
+ * bt_watch_touch() with bt_blackboard_changes().
+ *
+ * Subscribers register a key set and a callback instead of polling versions.
+ * Writes only mark keys; bt_blackboard_flush(), called once per tick, takes
+ * the batch and calls each subscriber whose keys changed once, with the
+ * changed subset, however many writes happened in between.
+ *
+ * Both calls take (and clear) the same changed set, so a host uses exactly
+ * one of them: bt_blackboard_changes() without subscribers, or
+ * bt_blackboard_flush() once any are bound, feeding its result to
+ * bt_watch_touch().
+ *
+ * Example:
+ *   enum { KEY_ENEMY_DIST, KEY_HP };
+ *   bt_blackboard_declare(&bb, "enemy_dist", BT_BB_F32);   -> KEY_ENEMY_DIST
+ *   bt_blackboard_declare(&bb, "hp", BT_BB_I32);           -> KEY_HP
+ *   bt_blackboard_set_f32(&bb, KEY_ENEMY_DIST, 12.5f);
+ *   bt_watch_touch(&watch, bt_blackboard_changes(&bb));   (no subscribers)
+ *   bt_watch_touch(&watch, bt_blackboard_flush(&bb));     (with subscribers)
+ */
+
+#ifndef C_BEHAVIOR_TREE_BLACKBOARD_H
+#define C_BEHAVIOR_TREE_BLACKBOARD_H
+
+#include <stddef.h>
+
+#include "bt.h"
+#include "bt_watch.h"
+
+/* ===== Keys and slots ===== */
+
+/* Key id: index of its slot */
+typedef uint16_t bt_bb_key_t;
+
+/* Returned when a key cannot be declared or found */
+#define BT_BB_NO_KEY ((bt_bb_key_t)0xFFFFU)
+
+/* Value type of a slot */
+typedef enum {
+  BT_BB_BOOL = 1U, /* bool     */
+  BT_BB_I32,       /* int32_t  */
+  BT_BB_U32,       /* uint32_t */
+  BT_BB_F32,       /* float    */
+  BT_BB_PTR        /* void*    */
+} bt_bb_type_t;
+
+/* Slot value; bits is zeroed before a narrower member is stored, so equal
+ * values compare equal as bits. */
+typedef union {
+  uint64_t bits;
+  bool b;
+  int32_t i32;
+  uint32_t u32;
+  float f32;
+  void* ptr;
+} bt_bb_value_t;
+
+/* One key's storage, laid out contiguously in the slot array */
+typedef struct {
+  bt_bb_value_t value;
+  uint32_t version; /* Bumped on each change, 0 until the first one */
+  uint8_t type;     /* bt_bb_type_t */
+} bt_bb_slot_t;
+
+/* Name index entry (open addressing, see bt_registry.h) */
+typedef struct {
+  const char* name; /* Not copied: must outlive the blackboard (NULL = free entry) */
+  uint32_t hash;    /* bt_registry_hash() of name */
+  uint16_t len;     /* strlen(name) */
+  bt_bb_key_t key;  /* Slot of the name */
+} bt_bb_name_t;
+
+/* Change callback: keys holds the subscribed keys that changed in the batch */
+typedef void (*bt_bb_notify_fn)(void* ctx, bt_keys_t keys);
+
+/* Subscription handle: generation of its entry in the high 16 bits, index of
+ * the entry in the low 16 bits. A removed subscription's handle stays
+ * invalid after its entry is reused. */
+typedef uint32_t bt_bb_sub_id_t;
+
+/* Returned when a subscription cannot be added */
+#define BT_BB_NO_SUB ((bt_bb_sub_id_t)0xFFFFFFFFU)
+
+/* Subscription entry */
+typedef struct {
+  bt_keys_t keys;     /* Keys of interest */
+  bt_bb_notify_fn fn; /* NULL = free entry */
+  void* ctx;          /* Passed to fn */
+  uint16_t gen;       /* Bumped when the entry is freed */
+} bt_bb_sub_t;
+
+/* Notes:
+ *  - Storage is provided by the caller; no allocation.
+ *  - The name index is optional; its capacity is a power of two larger than
+ *    the slot count, so a lookup always reaches a free entry.
+ *  - Not thread-safe: declare, write, subscribe and flush from one thread.
+ */
+typedef struct {
+  bt_bb_slot_t* slots;   /* Caller-provided, indexed by key id */
+  uint16_t capacity;     /* Slots available */
+  uint16_t count;        /* Keys declared */
+  bt_bb_name_t* names;   /* Caller-provided name index, or NULL */
+  uint32_t mask;         /* Name index capacity - 1 */
+  bt_keys_t changed;     /* Keys changed since the last bt_blackboard_changes() */
+  bt_bb_sub_t* subs;     /* Caller-provided subscription table, or NULL */
+  uint16_t sub_capacity; /* Entries in subs */
+} bt_blackboard_t;
+
+/* ===== Public API ===== */
+
+/* Bind storage to an empty blackboard.
+ * names may be NULL (with name_capacity 0) when keys are never looked up by
+ * name.
+ * Returns BT_SUCCESS, or BT_ERROR when bb/slots is NULL, slot_count is 0 or
+ * above 0xFFFE, or the name index is not a power of two larger than
+ * slot_count.
+ */
+bt_status_t bt_blackboard_init(bt_blackboard_t* bb, bt_bb_slot_t slots[], uint16_t slot_count, bt_bb_name_t names[],
+                               uint32_t name_capacity);
+
+/* Convenience helper for slot and name arrays with a static size */
+#define BT_BLACKBOARD_INIT(bbPtr, slots, names) \
+  bt_blackboard_init((bbPtr), (slots), BT_COUNT_OF(slots), (names), BT_COUNT_OF(names))
+
+/* Declare (or intern) a key. A new key takes the next id, with a zero value
+ * and version 0; a name already declared with the same type returns its id.
+ * name may be NULL for a key that is only used by id.
+ * Returns the key id, or BT_BB_NO_KEY when an argument is invalid, the name
+ * exists with another type, or the blackboard (or its name index) is full.
+ */
+bt_bb_key_t bt_blackboard_declare(bt_blackboard_t* bb, const char* name, bt_bb_type_t type);
+
+/* Find the key declared for the len bytes at name (need not be
+ * NUL-terminated).
+ * Returns the key id, or BT_BB_NO_KEY when the name is unknown.
+ */
+bt_bb_key_t bt_blackboard_find(const bt_blackboard_t* bb, const char* name, size_t len);
+
+/* Bind a subscription table (initially empty) to a blackboard.
+ * Returns BT_SUCCESS, or BT_ERROR when bb/subs is NULL or count is 0 or
+ * above 0xFFFE.
+ */
+bt_status_t bt_blackboard_subscribers(bt_blackboard_t* bb, bt_bb_sub_t subs[], uint16_t count);
+
+/* Subscribe fn(ctx, changed) to a set of keys (e.g.
+ * BT_KEY(KEY_HP) | BT_KEY(KEY_ALERT), or a tree's bt_watch_keys()).
+ * Returns the handle, or BT_BB_NO_SUB when an argument is invalid (keys 0,
+ * fn NULL), no table is bound or the table is full.
+ */
+bt_bb_sub_id_t bt_blackboard_subscribe(bt_blackboard_t* bb, bt_keys_t keys, bt_bb_notify_fn fn, void* ctx);
+
+/* Remove a subscription; it is not called again, even later in a running
+ * bt_blackboard_flush().
+ * Returns BT_SUCCESS, or BT_ERROR for an unknown or already removed handle
+ * (also once its entry holds a newer subscription).
+ */
+bt_status_t bt_blackboard_unsubscribe(bt_blackboard_t* bb, bt_bb_sub_id_t sub);
+
+/* Deliver the batch: take the changed keys (as bt_blackboard_changes()) and
+ * call every subscriber whose keys intersect them once, in table order.
+ * Call once per tick. Writes made by the callbacks are delivered by the next
+ * flush; a subscription added during a flush may or may not see this batch.
+ * Returns the keys taken, so the same batch can feed bt_watch_touch()
+ * (0 when bb is NULL). Do not also call bt_blackboard_changes(): whichever
+ * runs first consumes the batch and the other sees nothing.
+ */
+bt_keys_t bt_blackboard_flush(bt_blackboard_t* bb);
+
+/* bt_watch_wake() as a bt_bb_notify_fn; ctx is the bt_watch_tree_t. */
+void bt_blackboard_wake(void* ctx, bt_keys_t keys);
+
+/* Slot of a declared key with the given type, or NULL. */
+static inline bt_bb_slot_t* bt_blackboard_slot(const bt_blackboard_t* bb, bt_bb_key_t key, bt_bb_type_t type) {
+  bt_bb_slot_t* slot = BT_NULL;
+
+  if ((bb != BT_NULL) && (key < bb->count) && (bb->slots[key].type == (uint8_t)type)) {
+    slot = &bb->slots[key];
+  } else {
+    /* Unknown key or wrong type */
+  }
+
+  return slot;
+}
+
+/* Mark a key changed without writing it (e.g. after changing what a
+ * BT_BB_PTR slot points to).
+ * Returns BT_SUCCESS, or BT_ERROR for an undeclared key.
+ */
+static inline bt_status_t bt_blackboard_touch(bt_blackboard_t* bb, bt_bb_key_t key) {
+  bt_status_t result = BT_ERROR;
+
+  if ((bb != BT_NULL) && (key < bb->count)) {
+    bb->slots[key].version++;
+    bb->changed |= BT_KEY(key);
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Store a value of the slot's type; the version is bumped only when the
+ * value changes.
+ * Returns BT_SUCCESS, or BT_ERROR for an undeclared key or a type mismatch.
+ */
+static inline bt_status_t bt_blackboard_set(bt_blackboard_t* bb, bt_bb_key_t key, bt_bb_type_t type,
+                                            bt_bb_value_t value) {
+  bt_bb_slot_t* slot = bt_blackboard_slot(bb, key, type);
+  bt_status_t result = BT_ERROR;
+
+  if (slot == BT_NULL) {
+    result = BT_ERROR;
+  } else {
+    if (slot->value.bits != value.bits) {
+      slot->value = value;
+      slot->version++;
+      bb->changed |= BT_KEY(key);
+    } else {
+      /* Same value: no change to report */
+    }
+    result = BT_SUCCESS;
+  }
+
+  return result;
+}
+
+/* Version counter of a key (0 for an undeclared key). */
+static inline uint32_t bt_blackboard_version(const bt_blackboard_t* bb, bt_bb_key_t key) {
+  return ((bb != BT_NULL) && (key < bb->count)) ? bb->slots[key].version : 0U;
+}
+
+/* Take the set of keys changed since the previous call (0 when bb is NULL).
+ * For hosts without subscribers: it consumes the batch bt_blackboard_flush()
+ * delivers, so once subscribers are bound use the keys flush returns instead.
+ */
+static inline bt_keys_t bt_blackboard_changes(bt_blackboard_t* bb) {
+  bt_keys_t changed = 0U;
+
+  if (bb != BT_NULL) {
+    changed = bb->changed;
+    bb->changed = 0U;
+  } else {
+    /* No action */
+  }
+
+  return changed;
+}
+
+/* ===== Typed access =====
+ * Setters return bt_blackboard_set()'s status. Getters store the value in
+ * *out and return BT_SUCCESS, or BT_ERROR (out untouched) for an undeclared
+ * key or a type mismatch.
+ */
+
+static inline bt_status_t bt_blackboard_set_bool(bt_blackboard_t* bb, bt_bb_key_t key, bool v) {
+  bt_bb_value_t value = {0U};
+
+  value.b = v;
+  return bt_blackboard_set(bb, key, BT_BB_BOOL, value);
+}
+
+static inline bt_status_t bt_blackboard_set_i32(bt_blackboard_t* bb, bt_bb_key_t key, int32_t v) {
+  bt_bb_value_t value = {0U};
+
+  value.i32 = v;
+  return bt_blackboard_set(bb, key, BT_BB_I32, value);
+}
+
+static inline bt_status_t bt_blackboard_set_u32(bt_blackboard_t* bb, bt_bb_key_t key, uint32_t v) {
+  bt_bb_value_t value = {0U};
+
+  value.u32 = v;
+  return bt_blackboard_set(bb, key, BT_BB_U32, value);
+}
+
+static inline bt_status_t bt_blackboard_set_f32(bt_blackboard_t* bb, bt_bb_key_t key, float v) {
+  bt_bb_value_t value = {0U};
+
+  value.f32 = v;
+  return bt_blackboard_set(bb, key, BT_BB_F32, value);
+}
+
+static inline bt_status_t bt_blackboard_set_ptr(bt_blackboard_t* bb, bt_bb_key_t key, void* v) {
+  bt_bb_value_t value = {0U};
+
+  value.ptr = v;
+  return bt_blackboard_set(bb, key, BT_BB_PTR, value);
+}
+
+static inline bt_status_t bt_blackboard_get_bool(const bt_blackboard_t* bb, bt_bb_key_t key, bool* out) {
+  const bt_bb_slot_t* slot = bt_blackboard_slot(bb, key, BT_BB_BOOL);
+
+  bt_status_t result = BT_ERROR;
+
+  if (slot != BT_NULL) {
+    *out = slot->value.b;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+static inline bt_status_t bt_blackboard_get_i32(const bt_blackboard_t* bb, bt_bb_key_t key, int32_t* out) {
+  const bt_bb_slot_t* slot = bt_blackboard_slot(bb, key, BT_BB_I32);
+
+  bt_status_t result = BT_ERROR;
+
+  if (slot != BT_NULL) {
+    *out = slot->value.i32;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+static inline bt_status_t bt_blackboard_get_u32(const bt_blackboard_t* bb, bt_bb_key_t key, uint32_t* out) {
+  const bt_bb_slot_t* slot = bt_blackboard_slot(bb, key, BT_BB_U32);
+
+  bt_status_t result = BT_ERROR;
+
+  if (slot != BT_NULL) {
+    *out = slot->value.u32;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+static inline bt_status_t bt_blackboard_get_f32(const bt_blackboard_t* bb, bt_bb_key_t key, float* out) {
+  const bt_bb_slot_t* slot = bt_blackboard_slot(bb, key, BT_BB_F32);
+
+  bt_status_t result = BT_ERROR;
+
+  if (slot != BT_NULL) {
+    *out = slot->value.f32;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+static inline bt_status_t bt_blackboard_get_ptr(const bt_blackboard_t* bb, bt_bb_key_t key, void** out) {
+  const bt_bb_slot_t* slot = bt_blackboard_slot(bb, key, BT_BB_PTR);
+
+  bt_status_t result = BT_ERROR;
+
+  if (slot != BT_NULL) {
+    *out = slot->value.ptr;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+#endif /* C_BEHAVIOR_TREE_BLACKBOARD_H */
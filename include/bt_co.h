@@ -0,0 +1,132 @@
+/*
+ * bt_co.h
+ *
+ * Stackless coroutines (protothreads) for leaf tick callbacks.
+ * A multi-step leaf can be written as straight-line code that yields
+ * BT_RUNNING and continues after the yield on its next tick. The resume point
+ * and BT_CO_VARS small locals live in a caller-provided bt_co_t attached to
+ * the leaf with bt_set_co(), so no progress counters are needed in the
+ * blackboard.
+ *
+ * Example:
+ *   static bt_status_t cb_steps(bt_node_t* node) {
+ *     BT_CO_BEGIN(node);
+ *     for (BT_CO_VAR(node, 0U) = 0U; BT_CO_VAR(node, 0U) < 3U; BT_CO_VAR(node, 0U)++) {
+ *       step(BT_CO_VAR(node, 0U));
+ *       BT_CO_YIELD(node);
+ *     }
+ *     BT_CO_WAIT_UNTIL(node, device_ready());
+ *     BT_CO_END(node, BT_SUCCESS);
+ *   }
+ *
+ *   static bt_co_t steps_co;
+ *   bt_init(&n_steps, BT_ACTION, cb_steps, BT_NULL, 0U, BT_NULL);
+ *   (void)bt_set_co(&n_steps, &steps_co);
+ *
+ * Rules (as for any switch-based protothread):
+ *  - C locals do not survive a yield; keep such values in BT_CO_VAR().
+ *  - At most one yield/wait per source line, and no yield inside a nested
+ *    switch statement of the callback.
+ *  - The coroutine restarts from BT_CO_BEGIN() whenever the leaf is entered
+ *    with a status other than BT_RUNNING.
+ *  - A leaf without an attached bt_co_t reports BT_ERROR from BT_CO_BEGIN().
+ *  - One bt_co_t cannot follow the many instances of a compiled flat tree, so
+ *    bt_compile() rejects coroutine leaves; use bt_tick() or bt_tick_exec().
+ */
+
+#ifndef C_BEHAVIOR_TREE_CO_H
+#define C_BEHAVIOR_TREE_CO_H
+
+#include "bt.h"
+
+#ifndef BT_CO_VARS
+/* Coroutine locals kept per leaf in its bt_co_t */
+#define BT_CO_VARS (3U)
+#endif
+
+/* ===== Coroutine state ===== */
+
+typedef struct {
+  uint32_t line;             /* Resume point, 0 = start */
+  uint32_t vars[BT_CO_VARS]; /* Locals that survive a yield */
+} bt_co_t;
+
+/* Attach coroutine state to an ACTION or CONDITION leaf (through node->ext).
+ * co must outlive the node and is not shared; it starts at the top.
+ * Returns BT_SUCCESS, or BT_ERROR when node/co is NULL or node is not a leaf
+ * of those types.
+ */
+static inline bt_status_t bt_set_co(bt_node_t* node, bt_co_t* co) {
+  bt_status_t result = BT_ERROR;
+
+  if ((node != BT_NULL) && (co != BT_NULL) && ((node->type == BT_ACTION) || (node->type == BT_CONDITION))) {
+    uint32_t i;
+
+    co->line = 0U;
+    for (i = 0U; i < BT_CO_VARS; i++) {
+      co->vars[i] = 0U;
+    }
+    node->ext = co;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* ===== Coroutine macros ===== */
+
+/* Coroutine state of a leaf (bt_co_t*) */
+#define BT_CO_STATE(node) ((bt_co_t*)(node)->ext)
+
+/* Open the coroutine body: jump to the last resume point, or start over when
+ * the leaf is not RUNNING. Reports BT_ERROR when no bt_co_t is attached.
+ */
+#define BT_CO_BEGIN(node)                                                                  \
+  if ((node)->ext == BT_NULL) {                                                            \
+    return BT_ERROR;                                                                       \
+  }                                                                                        \
+  BT_CO_STATE(node)->line = ((node)->status == BT_RUNNING) ? BT_CO_STATE(node)->line : 0U; \
+  switch (BT_CO_STATE(node)->line) {                                                       \
+    case 0U:
+
+/* Return BT_RUNNING and continue right after this point on the next tick. */
+#define BT_CO_YIELD(node)                         \
+  do {                                            \
+    BT_CO_STATE(node)->line = (uint32_t)__LINE__; \
+    return BT_RUNNING;                            \
+    case __LINE__:;                               \
+  } while (0)
+
+/* Return BT_RUNNING on every tick until cond holds, then continue. */
+#define BT_CO_WAIT_UNTIL(node, cond) \
+  do {                               \
+    while (!(cond)) {                \
+      BT_CO_YIELD(node);             \
+    }                                \
+  } while (0)
+
+/* Finish early with a terminal status; the next entry starts over. */
+#define BT_CO_RETURN(node, result) \
+  do {                             \
+    BT_CO_STATE(node)->line = 0U;  \
+    return (result);               \
+  } while (0)
+
+/* Close the coroutine body and finish with a terminal status.
+ * An unknown resume point (corrupted state) reports BT_ERROR.
+ */
+#define BT_CO_END(node, result)     \
+    break;                          \
+    default:                        \
+      BT_CO_STATE(node)->line = 0U; \
+      return BT_ERROR;              \
+  }                                 \
+  BT_CO_STATE(node)->line = 0U;     \
+  return (result)
+
+/* Local slot i (0..BT_CO_VARS-1) that survives yields; a uint32_t lvalue. */
+#define BT_CO_VAR(node, i) (BT_CO_STATE(node)->vars[(i)])
+
+#endif /* C_BEHAVIOR_TREE_CO_H */
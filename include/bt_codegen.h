@@ -0,0 +1,61 @@
+/*
+ * bt_codegen.h
+ *
+ * Ahead-of-time code generation: turn a fixed tree into straight-line C.
+ * Every node becomes a small static function with its children's calls and
+ * the resume logic spelled out, and leaves call their callback by name, so
+ * the compiler sees the whole tree (and, when the generated file is included
+ * after the callbacks, their bodies) and can inline it into one function.
+ *
+ * The generated code keeps its state in the tree's own nodes (status,
+ * current_child, PARALLEL bitsets) and ticks them with the same
+ * RUNNING-resume semantics and hook calls as bt_tick(), so the two can be
+ * swapped on the same tree. It does not emit trace records or profile
+ * samples, and it never revisits the structure: the tree must not be
+ * rewired while generated code ticks it.
+ *
+ * Generated interface, for name "patrol":
+ *   #define patrol_NODES (N)
+ *   bt_status_t patrol_bind(bt_node_t* root, bt_node_t* n[patrol_NODES]);
+ *     fills n in pre-order and checks that root has the generated shape
+ *     (types, child counts, thresholds, hooks present, leaf callbacks);
+ *     BT_ERROR when it does not
+ *   bt_status_t patrol_tick(bt_node_t* const n[patrol_NODES]);
+ *     one tick of a bound tree, as bt_tick(root)
+ *
+ * tools/bt_codegen.c drives this from the XML format of bt_xml.h.
+ */
+
+#ifndef C_BEHAVIOR_TREE_CODEGEN_H
+#define C_BEHAVIOR_TREE_CODEGEN_H
+
+#include <stdio.h>
+
+#include "bt.h"
+
+/* ===== Symbol table ===== */
+
+/* C name of a leaf callback */
+typedef struct {
+  bt_tick_fn tick;       /* Leaf tick callback */
+  const void* user_data; /* Leaf user_data to match, NULL to match any */
+  const char* symbol;    /* C identifier the generated code calls */
+} bt_codegen_symbol_t;
+
+/* ===== Public API ===== */
+
+/* Write C code ticking the tree at root.
+ * The tree is checked with bt_validate() first. name prefixes every
+ * generated identifier; each leaf calls the symbol of the first entry with
+ * its tick and a matching user_data. The output includes "bt.h" and
+ * declares every symbol as bt_status_t symbol(bt_node_t* node); static
+ * callbacks are fine when the output is #include'd after their definitions.
+ * Returns BT_SUCCESS, or BT_ERROR on invalid arguments, a tree that fails
+ * bt_validate(), an ASYNC leaf, a reactive composite, a leaf without a
+ * matching symbol, a name or symbol that is not a C identifier, or a write
+ * error.
+ */
+bt_status_t bt_codegen_write(FILE* out, const char* name, bt_node_t* root, const bt_codegen_symbol_t symbols[],
+                             uint16_t symbol_count);
+
+#endif /* C_BEHAVIOR_TREE_CODEGEN_H */
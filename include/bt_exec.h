@@ -0,0 +1,124 @@
+/*
+ * bt_exec.h
+ *
+ * Non-recursive tick engine for wired bt_node_t trees.
+ * bt_tick_exec() drives the same node semantics as bt_tick(), but keeps the
+ * path from the root to the node being ticked in a caller-provided, fixed-size
+ * frame stack instead of the C call stack. Each level of the tree costs one
+ * frame (a node pointer) and one loop iteration, so deep trees can be ticked
+ * from threads with small stacks.
+ */
+
+#ifndef C_BEHAVIOR_TREE_EXEC_H
+#define C_BEHAVIOR_TREE_EXEC_H
+
+#include "bt.h"
+#include "bt_async.h"
+#include "bt_timer.h"
+
+/* ===== Public constants and helpers ===== */
+
+#ifndef BT_EXEC_MAX_DEPTH
+/* Upper bound for frame stacks declared with BT_EXEC_FRAMES */
+#define BT_EXEC_MAX_DEPTH (64U)
+#endif
+
+/* Declare frame storage for a tree at most `depth` levels deep.
+ * The depth is checked against BT_EXEC_MAX_DEPTH at compile time.
+ */
+#define BT_EXEC_FRAMES(name, depth)                                                                    \
+  _Static_assert(((depth) > 0U) && ((depth) <= BT_EXEC_MAX_DEPTH), "frame stack exceeds BT_EXEC_MAX_DEPTH"); \
+  bt_node_t* name[(depth)]
+
+/* ===== Engine context =====
+ * Notes:
+ *  - frames[0] is the root while a tick is in progress; frames[depth - 1] is
+ *    the node currently being ticked.
+ *  - A tree deeper than capacity does not overflow: the child that would not
+ *    fit reports BT_ERROR to its parent, which unwinds normally.
+ *  - When a tick ends RUNNING because a single leaf is RUNNING, frames[0..path_len)
+ *    still holds the root-to-leaf path. The next tick starts at that leaf and
+ *    only unwinds through the ancestors once its status changes.
+ *  - With a timer wheel bound, a node whose time_anchor_ms is in the future is
+ *    parked and reports RUNNING without being ticked (leaves also store
+ *    RUNNING). A leaf that returns RUNNING with a future anchor is parked
+ *    right away. If the cached leaf is parked, the whole tick returns RUNNING
+ *    without touching the tree.
+ *  - With a completion queue bound, it is drained at the start of each tick.
+ *    A pending BT_ASYNC leaf reports RUNNING without being ticked and does
+ *    not count as polling; if it is the cached leaf, the tick returns at once.
+ *  - Reactive composites re-tick their guards in place on every tick, so no
+ *    RUNNING path through one is cached. A guard parked on its time anchor
+ *    reports RUNNING, like any parked leaf; one that returns RUNNING polls.
+ */
+typedef struct {
+  bt_node_t** frames;        /* Caller-provided frame stack */
+  uint16_t capacity;         /* Number of frames available */
+  uint16_t depth;            /* Frames in use during a tick */
+  uint16_t path_len;         /* Cached RUNNING path length (0 = none) */
+  bt_timer_wheel_t* timers;  /* Wheel for time anchors, NULL to ignore them */
+  bt_async_queue_t* async;   /* Completions drained before each tick, or NULL */
+  bool polling;              /* Last tick left a RUNNING leaf that is not parked */
+} bt_exec_t;
+
+/* ===== Tickless scheduling ===== */
+
+/* What the host should wait for before the next tick */
+typedef enum {
+  BT_WAKE_POLL = 0U, /* A leaf polls (or the tree finished): tick on the host's normal period */
+  BT_WAKE_TIMER,     /* Only time anchors pending: tick at deadline_ms */
+  BT_WAKE_IDLE       /* Nothing timed: tick on external events only (e.g. async completions) */
+} bt_wake_kind_t;
+
+typedef struct {
+  bt_wake_kind_t kind;
+  uint32_t deadline_ms; /* Earliest anchor in the wheel; valid for BT_WAKE_TIMER */
+} bt_wake_t;
+
+/* ===== Public API ===== */
+
+/* Bind a frame stack to an engine context.
+ * Returns BT_SUCCESS, or BT_ERROR when exec/frames is NULL or capacity is 0.
+ */
+bt_status_t bt_exec_init(bt_exec_t* exec, bt_node_t* frames[], uint16_t capacity);
+
+/* Convenience helper for frame arrays declared with BT_EXEC_FRAMES */
+#define BT_EXEC_INIT(execPtr, frames) bt_exec_init((execPtr), (frames), BT_COUNT_OF(frames))
+
+/* Tick from the given root without recursion. Returns the root status. */
+bt_status_t bt_tick_exec(bt_exec_t* exec, bt_node_t* root);
+
+/* Tick like bt_tick_exec(), then report when the tree next needs a tick.
+ * With BT_WAKE_TIMER the host can sleep (e.g. clock_nanosleep) until
+ * deadline_ms on the wheel's clock, or until an external event arrives.
+ * deadline_ms is the earliest anchor of the whole wheel, so it also covers
+ * other engines sharing it.
+ */
+bt_status_t bt_tick_exec_next(bt_exec_t* exec, bt_node_t* root, bt_wake_t* wake);
+
+/* Bind a timer wheel (or NULL to ignore time anchors, the default).
+ * Several engines may share one wheel; the host advances it with
+ * bt_timer_advance() before ticking.
+ */
+void bt_exec_set_timers(bt_exec_t* exec, bt_timer_wheel_t* wheel);
+
+/* Bind a completion queue for BT_ASYNC leaves (or NULL, the default: drain
+ * it yourself with bt_async_drain() before ticking).
+ */
+void bt_exec_set_async(bt_exec_t* exec, bt_async_queue_t* queue);
+
+/* bt_halt() for a tree ticked with this engine: also removes the nodes met on
+ * the walk from the bound timer wheel (clearing their anchors, so a halted
+ * node is entered afresh instead of sleeping out the abandoned wait) and drops
+ * the cached RUNNING path. Settling PARALLEL and reactive composites halt
+ * their abandoned children this way during bt_tick_exec().
+ * Returns the number of nodes halted, as bt_halt() (0 when exec is NULL).
+ */
+uint16_t bt_exec_halt(bt_exec_t* exec, bt_node_t* node);
+
+/* Drop the cached RUNNING path. Call after changing the tree outside of
+ * bt_tick_exec() (re-initializing nodes, ticking it with another engine, ...).
+ */
+void bt_exec_reset(bt_exec_t* exec);
+
+#endif /* C_BEHAVIOR_TREE_EXEC_H */
@@ -0,0 +1,118 @@
+/*
+ * bt_executor.h
+ *
+ * Multi-threaded executor for large agent populations (POSIX threads).
+ * The agents of one compiled definition are cut into fixed-size chunks; each
+ * round, every worker owns a contiguous range of chunks in a per-worker
+ * deque, ticks them from one end and, once its own range is drained, steals
+ * chunks from the other end of its peers' deques. Agents whose running leaves
+ * are expensive therefore do not leave other cores idle.
+ */
+
+#ifndef C_BEHAVIOR_TREE_EXECUTOR_H
+#define C_BEHAVIOR_TREE_EXECUTOR_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "bt.h"
+#include "bt_flat.h"
+
+/* ===== Public constants ===== */
+
+#ifndef BT_EXECUTOR_MAX_WORKERS
+/* Number of worker slots reserved in bt_executor_t */
+#define BT_EXECUTOR_MAX_WORKERS (32U)
+#endif
+
+#ifndef BT_EXECUTOR_CHUNK
+/* Default number of agents per chunk (unit of work and of stealing) */
+#define BT_EXECUTOR_CHUNK (64U)
+#endif
+
+/* ===== Statistics ===== */
+
+/* Per-worker counters, accumulated over rounds until bt_executor_reset_stats().
+ * Utilisation is busy_ns / wall_ns.
+ */
+typedef struct {
+  uint64_t busy_ns; /* Time spent ticking chunks */
+  uint64_t wall_ns; /* Duration of the rounds this worker took part in */
+  uint32_t rounds;  /* bt_executor_tick_all() calls */
+  uint32_t chunks;  /* Chunks ticked (own + stolen) */
+  uint32_t agents;  /* Agents ticked */
+  uint32_t steals;  /* Chunks taken from other workers */
+} bt_worker_stats_t;
+
+/* ===== Executor =====
+ * Notes:
+ *  - Storage is provided by the caller (typically static); no allocation.
+ *  - A deque holds chunk indices [top, bottom): the owner pops at bottom,
+ *    thieves take from top. All chunks are assigned before a round starts,
+ *    so deques only shrink while workers run.
+ *  - Worker fields are cache-line aligned to avoid false sharing.
+ */
+struct bt_executor_s;
+
+typedef struct {
+  _Alignas(64) atomic_int top; /* Next chunk thieves take */
+  atomic_int bottom;           /* One past the next chunk the owner takes */
+  bt_worker_stats_t stats;     /* Owning worker during a round, caller between rounds */
+  pthread_t thread;
+  struct bt_executor_s* owner;
+  uint16_t index;
+} bt_worker_t;
+
+typedef struct bt_executor_s {
+  bt_worker_t workers[BT_EXECUTOR_MAX_WORKERS];
+  uint16_t worker_count;
+
+  /* Population */
+  const bt_flat_tree_t* def;
+  bt_instance_t* states;
+  void* const* blackboards;
+  bt_status_t* results;
+  uint32_t agent_count;
+  uint32_t chunk_size;
+  uint32_t chunk_count;
+
+  /* Round synchronization */
+  pthread_mutex_t lock;
+  pthread_cond_t start_cv;
+  pthread_cond_t done_cv;
+  uint32_t generation; /* Incremented to start a round */
+  bool stopping;
+  atomic_uint pending; /* Workers still busy in the current round */
+} bt_executor_t;
+
+/* ===== Public API ===== */
+
+/* Start worker_count threads over a population of agents.
+ * Parameters:
+ *   - ex: executor storage
+ *   - worker_count: 1..BT_EXECUTOR_MAX_WORKERS
+ *   - def: shared compiled definition
+ *   - states/blackboards/results: per-agent arrays as for bt_tick_batch()
+ *   - agent_count: number of agents
+ *   - chunk_size: agents per chunk, 0 for BT_EXECUTOR_CHUNK
+ * Returns BT_SUCCESS, or BT_ERROR on invalid arguments or thread creation failure.
+ */
+bt_status_t bt_executor_start(bt_executor_t* ex, uint16_t worker_count, const bt_flat_tree_t* def,
+                              bt_instance_t states[], void* const blackboards[], bt_status_t results[],
+                              uint32_t agent_count, uint32_t chunk_size);
+
+/* Tick every agent exactly once and return when all of them are done.
+ * Returns BT_SUCCESS, or BT_ERROR if the executor is not running.
+ */
+bt_status_t bt_executor_tick_all(bt_executor_t* ex);
+
+/* Copy one worker's counters. Call between rounds. */
+bt_status_t bt_executor_stats(const bt_executor_t* ex, uint16_t worker, bt_worker_stats_t* out);
+
+/* Clear all worker counters. Call between rounds. */
+void bt_executor_reset_stats(bt_executor_t* ex);
+
+/* Stop and join all workers. */
+void bt_executor_stop(bt_executor_t* ex);
+
+#endif /* C_BEHAVIOR_TREE_EXECUTOR_H */
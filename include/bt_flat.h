@@ -0,0 +1,184 @@
+/*
+ * bt_flat.h
+ *
+ * Compiled (flattened) representation of a Behavior Tree.
+ * bt_compile() walks a wired bt_node_t graph once and lays it out as a
+ * contiguous pre-order array in caller-provided storage. Each entry keeps
+ * the index of its parent and the index one past its own subtree, so the
+ * first child of node i is i + 1 and its next sibling is nodes[i + 1].next.
+ * The array is a read-only definition; mutable state (one status byte per
+ * node, cursor slots per composite) lives in a bt_instance_t, so a single
+ * definition can drive many agents. bt_tick_instance() drives the same
+ * SUCCESS/FAILURE/RUNNING semantics as bt_tick() over that array without
+ * recursion or child pointer chasing.
+ *
+ * Migration: bt_tick_compiled(&tree) from earlier versions kept the runtime
+ * state inside the compiled nodes and is gone. Initialize one bt_instance_t
+ * per tree with bt_instance_init() and call bt_tick_instance(&tree, &inst,
+ * NULL); statuses read from tree.nodes[i].status are now inst.status[i].
+ */
+
+#ifndef C_BEHAVIOR_TREE_FLAT_H
+#define C_BEHAVIOR_TREE_FLAT_H
+
+#include "bt.h"
+
+/* ===== Public constants ===== */
+
+/* Sentinel index (no parent / no node) */
+#define BT_FLAT_NONE ((uint16_t)0xFFFFU)
+
+/* Largest number of nodes a compiled tree can hold */
+#define BT_FLAT_MAX_NODES ((uint16_t)0xFFFEU)
+
+#ifndef BT_FLAT_THREADED
+/* 1: bt_tick_instance_threaded()/bt_tick_batch_threaded() dispatch through
+ * computed goto (a GNU C extension); 0: they run the portable switch engine */
+#if defined(__GNUC__)
+#define BT_FLAT_THREADED (1)
+#else
+#define BT_FLAT_THREADED (0)
+#endif
+#endif
+
+#ifndef BT_FLAT_MAX_DEPTH
+/* Deepest nesting accepted by bt_compile (bounds the compile-time walk stack) */
+#define BT_FLAT_MAX_DEPTH (64U)
+#endif
+
+/* ===== Compiled node (read-only definition) =====
+ * Notes:
+ *  - Nodes are stored in pre-order; the root is always index 0.
+ *  - Children of node i occupy [i + 1, next); siblings are chained via next.
+ *  - The structure of a node (bt_flat_link_t) holds indices only, so the same
+ *    engine runs over compiled nodes and over tree images (bt_image.h).
+ *  - src is only dereferenced for leaf callbacks, lifecycle hooks and PARALLEL
+ *    thresholds.
+ *  - Nothing here changes while ticking, so one definition can be shared by
+ *    any number of instances (and threads).
+ */
+
+/* Position-independent structure of a node */
+typedef struct {
+  uint16_t parent; /* Index of the parent node, BT_FLAT_NONE for the root */
+  uint16_t next;   /* Index one past this subtree (next sibling / skip offset) */
+  uint16_t slot;   /* Cursor slot in bt_instance_t (composites), BT_FLAT_NONE for leaves */
+  uint8_t type;    /* bt_node_type_t */
+  uint8_t ordinal; /* Position among its siblings (bit index under a PARALLEL parent) */
+} bt_flat_link_t;
+
+typedef struct {
+  union {
+    bt_flat_link_t link; /* Read by the engine */
+    struct {
+      uint16_t parent;
+      uint16_t next;
+      uint16_t slot;
+      uint8_t type;
+      uint8_t ordinal;
+    };
+  };
+  bt_node_t* src; /* Source node (tick callback, hooks, user_data, default blackboard) */
+} bt_flat_node_t;
+
+/* Node of a tree image: structure plus a binding id instead of a pointer.
+ * Fixed 16-byte layout, see bt_image.h.
+ */
+typedef struct {
+  bt_flat_link_t link;
+  uint16_t ref;              /* Index into the binding table, BT_FLAT_NONE for none */
+  uint8_t success_threshold; /* PARALLEL: successes needed */
+  uint8_t failure_threshold; /* PARALLEL: failures tolerated + 1 */
+  uint8_t children;          /* PARALLEL: number of children */
+  uint8_t reserved[3];       /* Zero */
+} bt_image_node_t;
+
+/* Compiled tree definition
+ * Exactly one of nodes (bt_compile()) and image (bt_image_load()) is set.
+ */
+typedef struct {
+  const bt_flat_node_t* nodes;    /* nodes[0] is the root */
+  uint16_t count;                 /* Number of nodes (status bytes per instance) */
+  uint16_t slots;                 /* Number of cursor slots per instance */
+  const bt_image_node_t* image;   /* Image nodes, image[0] is the root */
+  const bt_node_t* bindings;      /* Image binding table (callbacks, hooks, user_data) */
+  uint16_t binding_count;         /* Entries in bindings */
+} bt_flat_tree_t;
+
+/* ===== Per-instance runtime state =====
+ * Notes:
+ *  - status holds one byte per node (bt_status_t), cursor one uint16_t per
+ *    composite (five per PARALLEL: cursor plus its two 32-bit bitsets); both
+ *    are caller-provided and sized from the definition.
+ *  - active caches the leaf that kept the root RUNNING on the last tick; the
+ *    next tick starts there and walks parent indices only when it settles.
+ *  - Leaf callbacks and hooks receive a per-call copy of the source node whose
+ *    status and blackboard come from the instance. Writes to that copy are not
+ *    kept, so per-instance data belongs in the blackboard; leaves that keep
+ *    state behind ext (coroutines) are rejected by bt_compile().
+ */
+typedef struct {
+  uint8_t* status;  /* status[def->count] */
+  uint16_t* cursor; /* cursor[def->slots]: index of the current child */
+  uint16_t active;  /* Cached RUNNING leaf, BT_FLAT_NONE when there is none */
+} bt_instance_t;
+
+/* ===== Public API ===== */
+
+/* Count the nodes reachable from root (0 if the tree cannot be compiled).
+ * Useful to size the storage passed to bt_compile().
+ */
+uint16_t bt_count_nodes(const bt_node_t* root);
+
+/* Flatten the tree rooted at root into nodes[0..capacity).
+ * Returns BT_SUCCESS, or BT_ERROR when the tree is invalid (NULL child,
+ * leaf without tick callback, leaf with state attached through ext such as a
+ * coroutine (bt_co.h), INVERTER arity != 1, PARALLEL thresholds
+ * rejected by bt_set_parallel(), unknown type, nesting
+ * deeper than BT_FLAT_MAX_DEPTH) or does not fit in capacity.
+ */
+bt_status_t bt_compile(bt_node_t* root, bt_flat_node_t nodes[], uint16_t capacity, bt_flat_tree_t* tree);
+
+/* Bind and reset per-instance state for a compiled definition.
+ * Parameters:
+ *   - def: compiled definition
+ *   - inst: instance to initialize
+ *   - status: def->count bytes
+ *   - cursor: def->slots entries (may be NULL when def->slots == 0)
+ * Returns BT_SUCCESS, or BT_ERROR on invalid arguments.
+ */
+bt_status_t bt_instance_init(const bt_flat_tree_t* def, bt_instance_t* inst, uint8_t status[], uint16_t cursor[]);
+
+/* Tick one instance of a compiled definition from its root.
+ * blackboard is handed to callbacks as node->blackboard; pass NULL to keep
+ * each source node's own blackboard. Returns the root status.
+ */
+bt_status_t bt_tick_instance(const bt_flat_tree_t* def, bt_instance_t* state, void* blackboard);
+
+/* Tick count instances of one definition in a single call.
+ * Parameters:
+ *   - def: shared compiled definition
+ *   - states: per-agent instances
+ *   - blackboards: per-agent blackboards, or NULL to use the source nodes' own
+ *   - results: receives each agent's root status
+ *   - count: number of agents
+ * Returns BT_SUCCESS once every agent was ticked, BT_ERROR on invalid arguments.
+ */
+bt_status_t bt_tick_batch(const bt_flat_tree_t* def, bt_instance_t states[], void* const blackboards[],
+                          bt_status_t results[], uint32_t count);
+
+/* bt_tick_instance() through the direct-threaded interpreter.
+ * Same arguments, state and results as bt_tick_instance(); each node type
+ * has its own handler ending in its own indirect jump, which predicts better
+ * than one switch when trees mix node types. With BT_FLAT_THREADED == 0 this
+ * is the switch engine.
+ */
+bt_status_t bt_tick_instance_threaded(const bt_flat_tree_t* def, bt_instance_t* state, void* blackboard);
+
+/* bt_tick_batch() through the direct-threaded interpreter; see
+ * bt_tick_instance_threaded().
+ */
+bt_status_t bt_tick_batch_threaded(const bt_flat_tree_t* def, bt_instance_t states[], void* const blackboards[],
+                                   bt_status_t results[], uint32_t count);
+
+#endif /* C_BEHAVIOR_TREE_FLAT_H */
@@ -0,0 +1,96 @@
+/*
+ * bt_image.h
+ *
+ * Position-independent binary tree images.
+ * An image is a compiled tree written to a file: a fixed header followed by
+ * the pre-order node array (bt_image_node_t) that the flat engine ticks
+ * directly. Nodes refer to each other by index and to code by binding id, an
+ * index into a table of bt_node_t entries the program supplies when loading
+ * (tick callback, hooks, user_data, default blackboard). Loading checks the
+ * header and points a bt_flat_tree_t at the nodes in place: no per-node
+ * parsing, allocation or relocation, so a file mapped with mmap() is ready to
+ * tick at once, whatever its size.
+ *
+ * File layout (little-endian, nodes 16-byte aligned):
+ *   bt_image_header_t (32 bytes)
+ *   bt_image_node_t nodes[count] (16 bytes each)
+ */
+
+#ifndef C_BEHAVIOR_TREE_IMAGE_H
+#define C_BEHAVIOR_TREE_IMAGE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "bt.h"
+#include "bt_flat.h"
+
+/* ===== Public constants ===== */
+
+/* Format version written to and required in image headers */
+#define BT_IMAGE_VERSION (1U)
+
+/* "BTIMAGE\0" */
+#define BT_IMAGE_MAGIC "BTIMAGE"
+
+/* ===== File header ===== */
+
+typedef struct {
+  char magic[8];         /* BT_IMAGE_MAGIC with its terminating NUL */
+  uint32_t version;      /* BT_IMAGE_VERSION */
+  uint16_t header_size;  /* sizeof(bt_image_header_t): offset of nodes[0] */
+  uint16_t node_size;    /* sizeof(bt_image_node_t) */
+  uint16_t count;        /* Number of nodes */
+  uint16_t slots;        /* Cursor slots per instance */
+  uint16_t bindings;     /* Smallest binding table that covers every id */
+  uint16_t reserved;     /* Zero */
+  uint32_t checksum;     /* FNV-1a of the node array, see bt_image_verify() */
+  uint32_t reserved2;    /* Zero */
+} bt_image_header_t;
+
+/* A mapped image file (see bt_image_open()) */
+typedef struct {
+  void* base;  /* Start of the mapping */
+  size_t size; /* Length of the mapping */
+} bt_image_map_t;
+
+/* ===== Public API ===== */
+
+/* Write a compiled tree as an image.
+ * Every node whose source has a tick callback or a hook is given the id of the
+ * first binding with the same tick, on_enter, on_exit and user_data; other
+ * nodes get no binding.
+ * Returns BT_SUCCESS, or BT_ERROR on invalid arguments, a leaf or hooked node
+ * without a matching binding, or a write error.
+ */
+bt_status_t bt_image_write(FILE* out, const bt_flat_tree_t* def, const bt_node_t bindings[], uint16_t binding_count);
+
+/* Turn image bytes (mapped or read into memory) into a definition, in place.
+ * Checks the header only, in constant time: magic, version, byte order,
+ * layout sizes, that size covers the node array, 16-byte alignment and that
+ * the binding table is large enough. The data must stay valid and unchanged
+ * while def is used.
+ * Returns BT_SUCCESS, or BT_ERROR when the image is rejected.
+ */
+bt_status_t bt_image_load(const void* data, size_t size, const bt_node_t bindings[], uint16_t binding_count,
+                          bt_flat_tree_t* def);
+
+/* Check a loaded image in full before ticking it: the checksum, the
+ * parent/next/slot structure, node types, PARALLEL thresholds and that every
+ * leaf is bound to a callback without leaf state (ext, see bt_compile()). Linear in the node count; use it for images
+ * from untrusted sources (bt_image_load() alone trusts the node array).
+ * Returns BT_SUCCESS, or BT_ERROR on the first inconsistency.
+ */
+bt_status_t bt_image_verify(const bt_flat_tree_t* def);
+
+/* Map an image file read-only and load it (see bt_image_load()).
+ * Returns BT_SUCCESS, or BT_ERROR when the file cannot be mapped or is
+ * rejected (nothing stays mapped then).
+ */
+bt_status_t bt_image_open(const char* path, bt_image_map_t* map, const bt_node_t bindings[], uint16_t binding_count,
+                          bt_flat_tree_t* def);
+
+/* Unmap a file mapped by bt_image_open(). */
+void bt_image_close(bt_image_map_t* map);
+
+#endif /* C_BEHAVIOR_TREE_IMAGE_H */
@@ -0,0 +1,144 @@
+/*
+ * bt_profile.h
+ *
+ * Optional per-node profiling of the recursive engine (bt_tick()).
+ * With BT_PROFILE=1 the dispatcher counts, for every node, its ticks and
+ * outcomes, its inclusive time (the node and its subtree), its exclusive time
+ * (inclusive minus the time spent in its children) and a histogram of its
+ * inclusive time per tick. Times are bt_trace_clock() ticks; bt_profile_hz()
+ * converts them.
+ *
+ * Counters live in a caller-provided table indexed by node id (see
+ * bt_assign_ids()) and attached to the ticking thread, as for trace rings.
+ * With BT_PROFILE=0 (the default) the dispatcher contains no profiling code
+ * at all and attached tables stay zero.
+ */
+
+#ifndef C_BEHAVIOR_TREE_PROFILE_H
+#define C_BEHAVIOR_TREE_PROFILE_H
+
+#include "bt.h"
+#include "bt_trace.h"
+
+/* ===== Public constants ===== */
+
+#ifndef BT_PROFILE
+/* 1 = bt_tick() updates the attached profile table; 0 = compiled out */
+#define BT_PROFILE (0)
+#endif
+
+#ifndef BT_PROFILE_BUCKETS
+/* Histogram buckets; bucket b counts ticks that took [2^(b-1), 2^b) clock
+ * ticks (bucket 0: zero ticks), the last bucket also counts anything longer.
+ */
+#define BT_PROFILE_BUCKETS (32U)
+#endif
+
+/* ===== Counters ===== */
+
+/* Counters of one node */
+typedef struct {
+  uint64_t ticks;                    /* Times the node was ticked */
+  uint64_t success;                  /* Ticks that returned BT_SUCCESS */
+  uint64_t failure;                  /* Ticks that returned BT_FAILURE */
+  uint64_t running;                  /* Ticks that returned BT_RUNNING */
+  uint64_t error;                    /* Ticks that returned BT_ERROR */
+  uint64_t inclusive;                /* Total time including children */
+  uint64_t exclusive;                /* Total time excluding children */
+  uint64_t max;                      /* Longest single tick (inclusive) */
+  uint64_t hist[BT_PROFILE_BUCKETS]; /* Log2 histogram of inclusive time */
+} bt_profile_node_t;
+
+/* Profile table
+ * Notes:
+ *  - Only the thread it is attached to writes it; snapshot it from that
+ *    thread, or while that thread is not ticking.
+ *  - Nodes whose id is not below count are not profiled; their time counts
+ *    as exclusive time of the nearest profiled ancestor.
+ */
+typedef struct {
+  bt_profile_node_t* nodes; /* Caller-provided storage, indexed by node id */
+  uint16_t count;           /* Entries in nodes */
+  uint64_t child_time;      /* Dispatcher scratch: time of profiled children */
+  uint64_t clock0;          /* bt_trace_clock() at init/reset, for calibration */
+  uint64_t ns0;             /* CLOCK_MONOTONIC at init/reset, in ns */
+} bt_profile_t;
+
+/* Table the calling thread's bt_tick() updates (NULL = not profiling) */
+extern _Thread_local bt_profile_t* bt_profile_tls;
+
+/* ===== Public API ===== */
+
+/* Bind storage to a profile table and zero it.
+ * Returns BT_SUCCESS, or BT_ERROR when prof/nodes is NULL or count is 0.
+ */
+bt_status_t bt_profile_init(bt_profile_t* prof, bt_profile_node_t nodes[], uint16_t count);
+
+/* Convenience helper for node arrays with a static size */
+#define BT_PROFILE_INIT(profPtr, nodes) bt_profile_init((profPtr), (nodes), BT_COUNT_OF(nodes))
+
+/* Make prof the calling thread's profile table (NULL stops profiling). */
+void bt_profile_attach(bt_profile_t* prof);
+
+/* Copy the counters of nodes 0..max-1 into out.
+ * Returns the number of entries copied (at most prof->count).
+ */
+uint16_t bt_profile_snapshot(const bt_profile_t* prof, bt_profile_node_t out[], uint16_t max);
+
+/* Zero all counters and restart clock calibration. */
+void bt_profile_reset(bt_profile_t* prof);
+
+/* Estimate bt_trace_clock() ticks per second from the time since
+ * bt_profile_init()/bt_profile_reset(); returns 0 when too little time has
+ * passed to tell.
+ */
+uint64_t bt_profile_hz(const bt_profile_t* prof);
+
+/* Add one tick of a node to its counters (used by the dispatcher).
+ * Parameters:
+ *   - entry: the node's counters
+ *   - status: what the tick returned
+ *   - inclusive: time of the tick, children included
+ *   - children: part of inclusive spent in profiled children
+ */
+static inline void bt_profile_record(bt_profile_node_t* entry, bt_status_t status, uint64_t inclusive,
+                                     uint64_t children) {
+  uint64_t rest = inclusive;
+  uint32_t bucket = 0U;
+  uint32_t shift = 32U;
+
+  /* Bit length of inclusive, by halving */
+  while (shift > 0U) {
+    if ((rest >> shift) != 0U) {
+      rest >>= shift;
+      bucket += shift;
+    } else {
+      /* Upper half empty */
+    }
+    shift >>= 1U;
+  }
+  bucket += (uint32_t)rest; /* rest is 0 or 1 here */
+  bucket = (bucket < BT_PROFILE_BUCKETS) ? bucket : (BT_PROFILE_BUCKETS - 1U);
+
+  entry->ticks++;
+  switch (status) {
+    case BT_SUCCESS:
+      entry->success++;
+      break;
+    case BT_FAILURE:
+      entry->failure++;
+      break;
+    case BT_RUNNING:
+      entry->running++;
+      break;
+    default:
+      entry->error++;
+      break;
+  }
+  entry->inclusive += inclusive;
+  entry->exclusive += (inclusive > children) ? (inclusive - children) : 0U;
+  entry->max = (inclusive > entry->max) ? inclusive : entry->max;
+  entry->hist[bucket]++;
+}
+
+#endif /* C_BEHAVIOR_TREE_PROFILE_H */
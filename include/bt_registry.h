@@ -0,0 +1,67 @@
+/*
+ * bt_registry.h
+ *
+ * Name-to-callback registry for trees described as data (bt_xml.h).
+ * An open-addressing hash table in caller-provided storage maps leaf names
+ * ("BatteryOK", "MoveTo", ...) to a node type, a tick callback and the
+ * user_data given to the nodes created for that name. Lookups take a length,
+ * so names can be matched in place inside a larger text.
+ */
+
+#ifndef C_BEHAVIOR_TREE_REGISTRY_H
+#define C_BEHAVIOR_TREE_REGISTRY_H
+
+#include "bt.h"
+
+/* ===== Registry ===== */
+
+/* One registered leaf */
+typedef struct {
+  const char* name; /* Not copied: must outlive the registry (NULL = free slot) */
+  uint32_t hash;    /* bt_registry_hash() of name */
+  uint16_t len;     /* strlen(name) */
+  uint8_t type;     /* BT_ACTION, BT_CONDITION or BT_ASYNC */
+  bt_tick_fn tick;  /* Leaf callback */
+  void* user_data;  /* user_data of the nodes created for this name */
+} bt_registry_entry_t;
+
+/* Notes:
+ *  - Capacity is a power of two; at most capacity - 1 names can be added, so
+ *    a lookup always reaches a free slot.
+ *  - Adding is not thread-safe; lookups on a registry that is no longer
+ *    modified are.
+ */
+typedef struct {
+  bt_registry_entry_t* entries; /* Caller-provided storage */
+  uint32_t mask;                /* Capacity - 1 */
+  uint32_t count;               /* Names added */
+} bt_registry_t;
+
+/* ===== Public API ===== */
+
+/* FNV-1a hash of len bytes of name. */
+uint32_t bt_registry_hash(const char* name, size_t len);
+
+/* Bind storage to an empty registry.
+ * Returns BT_SUCCESS, or BT_ERROR when reg/entries is NULL or capacity is not
+ * a power of two (>= 2).
+ */
+bt_status_t bt_registry_init(bt_registry_t* reg, bt_registry_entry_t entries[], uint32_t capacity);
+
+/* Convenience helper for entry arrays with a static size */
+#define BT_REGISTRY_INIT(regPtr, entries) bt_registry_init((regPtr), (entries), BT_COUNT_OF(entries))
+
+/* Register a leaf name.
+ * Returns BT_SUCCESS, or BT_ERROR when an argument is invalid (type other than
+ * ACTION/CONDITION/ASYNC, NULL tick, empty or over-long name), the name is
+ * already registered or the registry is full.
+ */
+bt_status_t bt_registry_add(bt_registry_t* reg, const char* name, bt_node_type_t type, bt_tick_fn tick,
+                            void* user_data);
+
+/* Find the entry for the len bytes at name (need not be NUL-terminated).
+ * Returns the entry, or NULL when the name is not registered.
+ */
+const bt_registry_entry_t* bt_registry_find(const bt_registry_t* reg, const char* name, size_t len);
+
+#endif /* C_BEHAVIOR_TREE_REGISTRY_H */
@@ -0,0 +1,190 @@
+/*
+ * bt_rom.h
+ *
+ * Trees declared as constant data.
+ * A tree is written once as a list of node macros in pre-order, and
+ * BT_ROM_TREE() turns that list into a `static const` bt_flat_tree_t over a
+ * tree image (bt_flat.h) and its binding table. Indices, subtree ends,
+ * cursor slots, child ordinals and PARALLEL child counts are all computed by
+ * the compiler, so the tree can be placed in flash and needs no init code;
+ * the only RAM a tree uses is the per-instance state of bt_instance_t.
+ *
+ * Example:
+ *   #define PATROL(t)                                                \
+ *     BT_ROM_COMPOSITE(t, root, BT_SELECTOR)                         \
+ *       BT_ROM_COMPOSITE(t, guard, BT_SEQUENCE)                      \
+ *         BT_ROM_LEAF(t, battery, BT_CONDITION, cb_battery_ok, NULL) \
+ *         BT_ROM_LEAF(t, move, BT_ACTION, cb_move, NULL)             \
+ *       BT_ROM_END(t, guard)                                         \
+ *       BT_ROM_LEAF(t, idle, BT_ACTION, cb_idle, NULL)               \
+ *     BT_ROM_END(t, root)
+ *
+ *   BT_ROM_TREE(patrol, PATROL);
+ *
+ *   static uint8_t status[BT_ROM_COUNT(patrol)];
+ *   static uint16_t cursor[BT_ROM_SLOTS(patrol)];
+ *   bt_instance_init(&patrol, &inst, status, cursor);
+ *   bt_tick_instance(&patrol, &inst, &blackboard);
+ *
+ * Rules:
+ *  - Every BT_ROM_COMPOSITE/BT_ROM_PARALLEL is closed by a BT_ROM_END with
+ *    the same name, and the list holds exactly one root.
+ *  - Node names are used to build identifiers, so they must be unique within
+ *    a tree; different trees may reuse them.
+ *  - Leaves are ACTION or CONDITION nodes with a tick callback; user_data
+ *    must be an address constant (or NULL). Composites carry no hooks.
+ *  - Shape errors (unbalanced END, INVERTER without exactly one child,
+ *    PARALLEL thresholds out of range) are reported at compile time.
+ */
+
+#ifndef C_BEHAVIOR_TREE_ROM_H
+#define C_BEHAVIOR_TREE_ROM_H
+
+#include "bt.h"
+#include "bt_flat.h"
+
+/* ===== Tree definition ===== */
+
+/* Define `static const bt_flat_tree_t tree` from list, a function-like macro
+ * taking one argument and expanding to the node macros below.
+ */
+#define BT_ROM_TREE(tree, list)                                                                                   \
+  enum { list((IDX, tree)) BT_ROM_I(tree, _count) };                                                              \
+  enum { list((SLOT, tree)) BT_ROM_S(tree, _count) };                                                             \
+  enum { list((ORD, tree)) BT_ROM_O(tree, _end) };                                                                \
+  enum { BT_ROM_P(tree, _init) = (int)BT_FLAT_NONE - 1, list((PAR, tree)) BT_ROM_P(tree, _end) };                 \
+  enum { list((REF, tree)) BT_ROM_R(tree, _count) };                                                              \
+  list((CHECK, tree))                                                                                             \
+  _Static_assert(BT_ROM_O(tree, _end) == 1, #tree ": the list must hold exactly one root");                       \
+  _Static_assert(BT_ROM_P(tree, _end) == (int)BT_FLAT_NONE, #tree ": unclosed BT_ROM_COMPOSITE/BT_ROM_PARALLEL"); \
+  _Static_assert(BT_ROM_I(tree, _count) <= (int)BT_FLAT_MAX_NODES, #tree ": too many nodes");                     \
+  _Static_assert(BT_ROM_R(tree, _count) > 0, #tree ": a tree needs at least one leaf");                           \
+  static const bt_image_node_t tree##_bt_rom_nodes[] = {list((NODE, tree))};                                      \
+  static const bt_node_t tree##_bt_rom_bindings[] = {list((BIND, tree))};                                         \
+  static const bt_flat_tree_t tree = {.nodes = BT_NULL,                                                           \
+                                      .count = (uint16_t)BT_ROM_I(tree, _count),                                  \
+                                      .slots = (uint16_t)BT_ROM_S(tree, _count),                                  \
+                                      .image = tree##_bt_rom_nodes,                                               \
+                                      .bindings = tree##_bt_rom_bindings,                                         \
+                                      .binding_count = (uint16_t)BT_ROM_R(tree, _count)}
+
+/* Number of nodes (status bytes per instance) of a BT_ROM_TREE() */
+#define BT_ROM_COUNT(tree) ((uint16_t)BT_ROM_I(tree, _count))
+
+/* Number of cursor slots per instance of a BT_ROM_TREE() */
+#define BT_ROM_SLOTS(tree) ((uint16_t)BT_ROM_S(tree, _count))
+
+/* ===== Node macros (used inside the list) ===== */
+
+/* SEQUENCE, SELECTOR or INVERTER; children follow up to BT_ROM_END(t, name). */
+#define BT_ROM_COMPOSITE(t, name, type) BT_ROM_CAT(BT_ROM_C_, BT_ROM_PASS(t))(BT_ROM_TREE_NAME(t), name, type)
+
+/* PARALLEL with the given thresholds (see bt_set_parallel()); children follow
+ * up to BT_ROM_END(t, name). */
+#define BT_ROM_PARALLEL(t, name, success, failure) \
+  BT_ROM_CAT(BT_ROM_P_, BT_ROM_PASS(t))(BT_ROM_TREE_NAME(t), name, success, failure)
+
+/* ACTION or CONDITION leaf. */
+#define BT_ROM_LEAF(t, name, type, tick, user_data) \
+  BT_ROM_CAT(BT_ROM_L_, BT_ROM_PASS(t))(BT_ROM_TREE_NAME(t), name, type, tick, user_data)
+
+/* Close the composite or parallel opened as name. */
+#define BT_ROM_END(t, name) BT_ROM_CAT(BT_ROM_E_, BT_ROM_PASS(t))(BT_ROM_TREE_NAME(t), name)
+
+/* ===== Implementation =====
+ * The list is expanded once per pass; t is the pair (pass, tree). The IDX,
+ * SLOT, ORD and PAR passes are enumerations whose implicit increments do the
+ * counting: an enumerator assigned `x - 1` makes the next one continue from x,
+ * which is how an END restores the counter saved when its node opened.
+ */
+
+#define BT_ROM_CAT_(a, b) a##b
+#define BT_ROM_CAT(a, b) BT_ROM_CAT_(a, b)
+#define BT_ROM_PASS_(pass, tree) pass
+#define BT_ROM_NAME_(pass, tree) tree
+#define BT_ROM_PASS(t) BT_ROM_PASS_ t
+#define BT_ROM_TREE_NAME(t) BT_ROM_NAME_ t
+
+#define BT_ROM_STR_(a) #a
+#define BT_ROM_STR(a) BT_ROM_STR_(a)
+#define BT_ROM_ID_(tree, kind, x) tree##_bt_rom_##kind##_##x
+#define BT_ROM_ID(tree, kind, x) BT_ROM_ID_(tree, kind, x)
+
+#define BT_ROM_I(tree, x) BT_ROM_ID(tree, i, x)   /* Pre-order index */
+#define BT_ROM_E(tree, x) BT_ROM_ID(tree, e, x)   /* Index one past the subtree */
+#define BT_ROM_S(tree, x) BT_ROM_ID(tree, s, x)   /* First cursor slot */
+#define BT_ROM_O(tree, x) BT_ROM_ID(tree, o, x)   /* Ordinal among siblings */
+#define BT_ROM_N(tree, x) BT_ROM_ID(tree, n, x)   /* Number of children */
+#define BT_ROM_P(tree, x) BT_ROM_ID(tree, p, x)   /* Parent index */
+#define BT_ROM_PE(tree, x) BT_ROM_ID(tree, pe, x) /* Open node seen by BT_ROM_END(x) */
+#define BT_ROM_R(tree, x) BT_ROM_ID(tree, r, x)   /* Binding id */
+
+/* IDX: index of every node, end of every subtree */
+#define BT_ROM_C_IDX(tree, x, type) BT_ROM_I(tree, x),
+#define BT_ROM_P_IDX(tree, x, s, f) BT_ROM_I(tree, x),
+#define BT_ROM_L_IDX(tree, x, type, fn, ud) BT_ROM_I(tree, x),
+#define BT_ROM_E_IDX(tree, x) BT_ROM_E(tree, x), BT_ROM_ID(tree, er, x) = BT_ROM_E(tree, x) - 1,
+
+/* SLOT: one cursor slot per composite, five per PARALLEL (as bt_compile()) */
+#define BT_ROM_C_SLOT(tree, x, type) BT_ROM_S(tree, x),
+#define BT_ROM_P_SLOT(tree, x, s, f) BT_ROM_S(tree, x), BT_ROM_ID(tree, sp, x) = BT_ROM_S(tree, x) + 4,
+#define BT_ROM_L_SLOT(tree, x, type, fn, ud) BT_ROM_S(tree, x), BT_ROM_ID(tree, sp, x) = BT_ROM_S(tree, x) - 1,
+#define BT_ROM_E_SLOT(tree, x)
+
+/* ORD: sibling ordinals restart under each node; END records the child count */
+#define BT_ROM_C_ORD(tree, x, type) BT_ROM_O(tree, x), BT_ROM_ID(tree, oo, x) = -1,
+#define BT_ROM_P_ORD(tree, x, s, f) BT_ROM_O(tree, x), BT_ROM_ID(tree, oo, x) = -1,
+#define BT_ROM_L_ORD(tree, x, type, fn, ud) BT_ROM_O(tree, x),
+#define BT_ROM_E_ORD(tree, x) BT_ROM_N(tree, x), BT_ROM_ID(tree, oc, x) = BT_ROM_O(tree, x),
+
+/* PAR: the counter holds the innermost open node */
+#define BT_ROM_C_PAR(tree, x, type) BT_ROM_P(tree, x), BT_ROM_ID(tree, po, x) = BT_ROM_I(tree, x) - 1,
+#define BT_ROM_P_PAR(tree, x, s, f) BT_ROM_P(tree, x), BT_ROM_ID(tree, po, x) = BT_ROM_I(tree, x) - 1,
+#define BT_ROM_L_PAR(tree, x, type, fn, ud) BT_ROM_P(tree, x), BT_ROM_ID(tree, pk, x) = BT_ROM_P(tree, x) - 1,
+#define BT_ROM_E_PAR(tree, x) BT_ROM_PE(tree, x), BT_ROM_ID(tree, pc, x) = BT_ROM_P(tree, x) - 1,
+
+/* REF: one binding per leaf */
+#define BT_ROM_C_REF(tree, x, type)
+#define BT_ROM_P_REF(tree, x, s, f)
+#define BT_ROM_L_REF(tree, x, type, fn, ud) BT_ROM_R(tree, x),
+#define BT_ROM_E_REF(tree, x)
+
+/* CHECK: shape rules */
+#define BT_ROM_C_CHECK(tree, x, type)                                       \
+  _Static_assert(((type) == BT_SEQUENCE) || ((type) == BT_SELECTOR) ||      \
+                     (((type) == BT_INVERTER) && (BT_ROM_N(tree, x) == 1)), \
+                 BT_ROM_STR(tree) "." #x ": composites are SEQUENCE, SELECTOR or single-child INVERTER");
+#define BT_ROM_P_CHECK(tree, x, s, f)                                                                                \
+  _Static_assert((BT_ROM_N(tree, x) <= (int)BT_PARALLEL_MAX_CHILDREN) && ((s) >= 1) && ((s) <= BT_ROM_N(tree, x)) && \
+                     ((f) >= 1) && ((f) <= BT_ROM_N(tree, x)),                                                       \
+                 BT_ROM_STR(tree) "." #x ": PARALLEL thresholds must be within 1..children (at most 32 children)");
+#define BT_ROM_L_CHECK(tree, x, type, fn, ud)                       \
+  _Static_assert(((type) == BT_ACTION) || ((type) == BT_CONDITION), \
+                 BT_ROM_STR(tree) "." #x ": leaves are ACTION or CONDITION");
+#define BT_ROM_E_CHECK(tree, x)                                     \
+  _Static_assert((int)BT_ROM_PE(tree, x) == (int)BT_ROM_I(tree, x), \
+                 BT_ROM_STR(tree) ": BT_ROM_END(" #x ") closes another node");
+
+/* NODE: the image entries */
+#define BT_ROM_LINK(tree, x, next, slot, type)                             \
+  {(uint16_t)BT_ROM_P(tree, x), (uint16_t)(next), (slot), (uint8_t)(type), \
+   (uint8_t)((BT_ROM_O(tree, x) < 0xFF) ? BT_ROM_O(tree, x) : 0xFF)}
+#define BT_ROM_C_NODE(tree, x, type)                                                                     \
+  {BT_ROM_LINK(tree, x, BT_ROM_E(tree, x), (uint16_t)BT_ROM_S(tree, x), type), BT_FLAT_NONE, 0U, 0U, 0U, \
+   {0U, 0U, 0U}},
+#define BT_ROM_P_NODE(tree, x, s, f)                                                                \
+  {BT_ROM_LINK(tree, x, BT_ROM_E(tree, x), (uint16_t)BT_ROM_S(tree, x), BT_PARALLEL), BT_FLAT_NONE, \
+   (uint8_t)(s), (uint8_t)(f), (uint8_t)BT_ROM_N(tree, x), {0U, 0U, 0U}},
+#define BT_ROM_L_NODE(tree, x, type, fn, ud)                                                                 \
+  {BT_ROM_LINK(tree, x, BT_ROM_I(tree, x) + 1, BT_FLAT_NONE, type), (uint16_t)BT_ROM_R(tree, x), 0U, 0U, 0U, \
+   {0U, 0U, 0U}},
+#define BT_ROM_E_NODE(tree, x)
+
+/* BIND: the leaves' callbacks and user_data */
+#define BT_ROM_C_BIND(tree, x, type)
+#define BT_ROM_P_BIND(tree, x, s, f)
+#define BT_ROM_L_BIND(tree, x, kind, fn, ud) \
+  {.type = (kind), .status = BT_FAILURE, .tick = (fn), .user_data = (ud)},
+#define BT_ROM_E_BIND(tree, x)
+
+#endif /* C_BEHAVIOR_TREE_ROM_H */
@@ -0,0 +1,102 @@
+/*
+ * bt_timer.h
+ *
+ * Hierarchical timer wheel for time_anchor_ms.
+ * A node whose time_anchor_ms lies in the future is parked in the wheel
+ * instead of being ticked; the wheel clears the anchor when it expires, and
+ * the node is ticked again from then on. The wheel has BT_TIMER_LEVELS levels
+ * of BT_TIMER_SLOTS slots each; level n covers delays up to
+ * BT_TIMER_SLOTS^(n+1) ms, so parking, cancelling and expiring a node are all
+ * O(1) and a sleeping node costs nothing until its slot comes up.
+ * The clock is whatever millisecond counter the host passes to
+ * bt_timer_advance() (e.g. CLOCK_MONOTONIC); it may wrap.
+ */
+
+#ifndef C_BEHAVIOR_TREE_TIMER_H
+#define C_BEHAVIOR_TREE_TIMER_H
+
+#include "bt.h"
+
+/* ===== Public constants ===== */
+
+/* Bits of the delay resolved per level */
+#define BT_TIMER_BITS (6U)
+/* Slots per level */
+#define BT_TIMER_SLOTS (1U << BT_TIMER_BITS)
+/* Levels; delays beyond BT_TIMER_SLOTS^BT_TIMER_LEVELS ms are re-parked on expiry */
+#define BT_TIMER_LEVELS (4U)
+
+/* Link value for "no entry" */
+#define BT_TIMER_NONE (0xFFFFU)
+
+/* ===== Timer wheel ===== */
+
+/* Wheel storage for one parked node */
+typedef struct {
+  bt_node_t* node; /* Parked node, NULL when the entry is free */
+  uint16_t next;   /* Next entry of the same slot list (of the free list when free) */
+  uint16_t prev;   /* Previous entry of the slot list, BT_TIMER_NONE at its head */
+  uint16_t slot;   /* Slot list holding the entry (level * BT_TIMER_SLOTS + slot) */
+} bt_timer_entry_t;
+
+/* Notes:
+ *  - Parked nodes are chained through a caller-provided pool of entries; a
+ *    node only records which entry it holds (timer_entry), so nodes that are
+ *    never timed carry no wheel state.
+ *  - A node is parked while timer_entry != 0. Do not bt_init() a parked
+ *    node; cancel it first.
+ *  - Size the pool for the most nodes that can sleep at once: when it is
+ *    exhausted, bt_timer_park() fails and the node is ticked as if its
+ *    anchor were due (the anchor is kept).
+ *  - Not thread-safe: park, cancel and advance from the thread that ticks.
+ */
+typedef struct {
+  uint16_t slots[BT_TIMER_LEVELS][BT_TIMER_SLOTS]; /* First entry of each slot list */
+  bt_timer_entry_t* entries;                       /* Caller-provided entry pool */
+  uint16_t capacity;                               /* Number of entries */
+  uint16_t free;                                   /* First free entry, BT_TIMER_NONE when full */
+  uint32_t now;                                    /* Current time in ms */
+  uint32_t parked;                                 /* Number of parked nodes */
+} bt_timer_wheel_t;
+
+/* ===== Public API ===== */
+
+/* Reset a wheel to an empty state at time now_ms, with `capacity` entries
+ * for parked nodes.
+ * Returns BT_SUCCESS, or BT_ERROR when wheel/entries is NULL or capacity is
+ * 0 or BT_TIMER_NONE.
+ */
+bt_status_t bt_timer_init(bt_timer_wheel_t* wheel, bt_timer_entry_t entries[], uint16_t capacity, uint32_t now_ms);
+
+/* Convenience helper for entry arrays */
+#define BT_TIMER_INIT(wheelPtr, entries, nowMs) bt_timer_init((wheelPtr), (entries), BT_COUNT_OF(entries), (nowMs))
+
+/* Move the wheel's clock forward to now_ms and expire every node whose
+ * anchor was reached (its time_anchor_ms is cleared to 0).
+ * Returns the number of nodes that expired.
+ */
+uint32_t bt_timer_advance(bt_timer_wheel_t* wheel, uint32_t now_ms);
+
+/* Park a node until its time_anchor_ms.
+ * Returns:
+ *   - true when the node is parked (already parked, or anchor in the future)
+ *   - false when it has no anchor or the anchor is due; a due anchor is
+ *     cleared so the node runs now
+ *   - false when the anchor is in the future but no entry is free
+ */
+bool bt_timer_park(bt_timer_wheel_t* wheel, bt_node_t* node);
+
+/* Remove a parked node from its wheel (no-op when it is not parked).
+ * time_anchor_ms is left unchanged.
+ */
+void bt_timer_cancel(bt_timer_wheel_t* wheel, bt_node_t* node);
+
+/* Find the earliest anchor among the parked nodes.
+ * Returns true and stores it in *deadline_ms, or false when nothing is parked.
+ */
+bool bt_timer_next_deadline(const bt_timer_wheel_t* wheel, uint32_t* deadline_ms);
+
+/* True while the node is parked in a wheel. */
+static inline bool bt_timer_is_parked(const bt_node_t* node) { return node->timer_entry != 0U; }
+
+#endif /* C_BEHAVIOR_TREE_TIMER_H */
@@ -0,0 +1,175 @@
+/*
+ * bt_trace.h
+ *
+ * Always-on binary tracing of node status transitions.
+ * Every engine reports each change of a node's status (bt_tick(),
+ * bt_tick_exec(), bt_tick_instance()) to the ring attached to the calling
+ * thread. A record is a timestamp from bt_trace_clock(), the node id and the old
+ * and new status, written with a handful of plain stores: no locks, no
+ * system calls, no formatting. The ring keeps the most recent records and can
+ * be snapshotted from any thread, or after the fact, and written to a file
+ * that tools/bt_trace_dump.c decodes.
+ *
+ * Node ids come from bt_assign_ids() for wired trees and are the node index
+ * for compiled trees; both follow the same pre-order, so a wired tree and its
+ * compiled form report the same ids.
+ */
+
+#ifndef C_BEHAVIOR_TREE_TRACE_H
+#define C_BEHAVIOR_TREE_TRACE_H
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "bt.h"
+
+/* ===== Public constants ===== */
+
+#ifndef BT_TRACE
+/* 1 = engines report status transitions to the attached ring; 0 = compiled out */
+#define BT_TRACE (1)
+#endif
+
+/* File format version written by bt_trace_write() */
+#define BT_TRACE_VERSION (1U)
+
+/* ===== Records ===== */
+
+/* One status transition, as returned by bt_trace_snapshot() */
+typedef struct {
+  uint64_t time; /* bt_trace_clock() ticks */
+  uint32_t seq;  /* Low 32 bits of the record's position in its ring */
+  uint16_t node; /* Node id */
+  uint8_t from;  /* Previous status (bt_status_t) */
+  uint8_t to;    /* New status (bt_status_t) */
+} bt_trace_rec_t;
+
+/* Storage for one record inside a ring; use bt_trace_rec_t to read it */
+typedef struct {
+  _Atomic uint64_t time; /* bt_trace_clock() ticks */
+  _Atomic uint64_t info; /* node | from << 16 | to << 24 | seq << 32 */
+} bt_trace_slot_t;
+
+/* ===== Ring =====
+ * Notes:
+ *  - One ring per thread: only the thread it is attached to writes it, so the
+ *    write side needs no atomic read-modify-write.
+ *  - The ring overwrites its oldest records once full (flight recorder).
+ *  - Readers detect records overwritten while they copy and drop them.
+ *  - Storage is provided by the caller; the capacity must be a power of two.
+ */
+typedef struct {
+  bt_trace_slot_t* slots;  /* Caller-provided storage */
+  uint32_t mask;           /* Capacity - 1 */
+  uint32_t tag;            /* Caller's label (thread, agent, ...) */
+  uint64_t clock0;         /* bt_trace_clock() at init, for calibration */
+  uint64_t ns0;            /* CLOCK_MONOTONIC at init, in ns */
+  _Atomic uint64_t head;   /* Records written so far */
+} bt_trace_ring_t;
+
+/* Ring the calling thread writes to (NULL = tracing off for this thread) */
+extern _Thread_local bt_trace_ring_t* bt_trace_tls;
+
+/* ===== Clock ===== */
+
+/* CLOCK_MONOTONIC in ns (calibration reference and portable fallback) */
+uint64_t bt_trace_clock_ns(void);
+
+#ifndef BT_TRACE_CLOCK
+#if defined(__x86_64__) || defined(__i386__)
+/* Time stamp counter */
+#define BT_TRACE_CLOCK() ((uint64_t)__builtin_ia32_rdtsc())
+#elif defined(__aarch64__)
+/* Generic timer virtual count */
+static inline uint64_t bt_trace_cntvct(void) {
+  uint64_t v;
+
+  __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+}
+#define BT_TRACE_CLOCK() bt_trace_cntvct()
+#else
+/* Portable fallback */
+#define BT_TRACE_CLOCK() bt_trace_clock_ns()
+#endif
+#endif
+
+/* Current trace timestamp (units reported by bt_trace_hz()) */
+static inline uint64_t bt_trace_clock(void) { return BT_TRACE_CLOCK(); }
+
+/* ===== Public API ===== */
+
+/* Bind storage to a ring.
+ * Returns BT_SUCCESS, or BT_ERROR when ring/slots is NULL or capacity is not
+ * a power of two.
+ */
+bt_status_t bt_trace_init(bt_trace_ring_t* ring, bt_trace_slot_t slots[], uint32_t capacity, uint32_t tag);
+
+/* Convenience helper for slot arrays with a static size */
+#define BT_TRACE_INIT(ringPtr, slots, tag) bt_trace_init((ringPtr), (slots), BT_COUNT_OF(slots), (tag))
+
+/* Make ring the calling thread's trace target (NULL stops tracing). */
+void bt_trace_attach(bt_trace_ring_t* ring);
+
+/* Record one status transition in the calling thread's ring.
+ * Engines call this on every status store; it does nothing when no ring is
+ * attached or the status did not change.
+ */
+static inline void bt_trace_emit(uint16_t node, bt_status_t from, bt_status_t to) {
+#if BT_TRACE
+  bt_trace_ring_t* const ring = bt_trace_tls;
+
+  if ((ring != BT_NULL) && (from != to)) {
+    const uint64_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    bt_trace_slot_t* const slot = &ring->slots[pos & ring->mask];
+
+    /* Order the previous head update before overwriting this slot (see bt_trace_snapshot) */
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&slot->time, bt_trace_clock(), memory_order_relaxed);
+    atomic_store_explicit(&slot->info,
+                          (uint64_t)node | ((uint64_t)(uint8_t)from << 16U) | ((uint64_t)(uint8_t)to << 24U) |
+                              (pos << 32U),
+                          memory_order_relaxed);
+    atomic_store_explicit(&ring->head, pos + 1U, memory_order_release);
+  } else {
+    /* Tracing off, or no transition */
+  }
+#else
+  (void)node;
+  (void)from;
+  (void)to;
+#endif
+}
+
+/* Copy the newest records, oldest first, into out (at most max).
+ * Safe to call from any thread while the owner keeps writing. Once the ring
+ * has wrapped, the slot the owner would overwrite next is skipped, so at most
+ * capacity - 1 records are returned.
+ * Returns the number of records copied.
+ */
+uint32_t bt_trace_snapshot(const bt_trace_ring_t* ring, bt_trace_rec_t out[], uint32_t max);
+
+/* Estimate bt_trace_clock() ticks per second from the time since
+ * bt_trace_init(); returns 0 when too little time has passed to tell.
+ */
+uint64_t bt_trace_hz(const bt_trace_ring_t* ring);
+
+/* Write records to a binary trace file (see tools/bt_trace_dump.c).
+ * Layout, little-endian: "BTTRACE\0", u32 version, u32 tag, u64 hz,
+ * u64 count, then count records of u64 time, u32 seq, u16 node, u8 from,
+ * u8 to.
+ * Returns BT_SUCCESS, or BT_ERROR on invalid arguments or a write error.
+ */
+bt_status_t bt_trace_write(FILE* out, uint32_t tag, uint64_t hz, const bt_trace_rec_t recs[], uint32_t count);
+
+/* Read the header of a trace file written by bt_trace_write().
+ * Returns BT_SUCCESS, or BT_ERROR when the file is not a trace of this version.
+ */
+bt_status_t bt_trace_read_header(FILE* in, uint32_t* tag, uint64_t* hz, uint64_t* count);
+
+/* Read the next record of a trace file.
+ * Returns BT_SUCCESS, or BT_FAILURE at the end of the file.
+ */
+bt_status_t bt_trace_read_rec(FILE* in, bt_trace_rec_t* rec);
+
+#endif /* C_BEHAVIOR_TREE_TRACE_H */
@@ -0,0 +1,101 @@
+/*
+ * bt_watch.h
+ *
+ * Event-driven ticking of many trees. Nodes declare the blackboard keys they
+ * read in their reads bitset; writers mark the keys they change dirty with
+ * bt_watch_touch(). Each round ticks (with bt_tick_exec_next()) only the
+ * trees that need it:
+ *   - a key the tree watches (the union of its nodes' reads) was touched
+ *     since the previous round started;
+ *   - its last tick left a polling RUNNING leaf (BT_WAKE_POLL while RUNNING);
+ *   - it waits for time anchors and the wheel's clock reached its deadline;
+ *   - it was woken with bt_watch_wake() (e.g. from an async queue's notify
+ *     hook, see bt_watch_notify());
+ *   - it was never ticked since bt_watch_bind().
+ * Every other tree is skipped: a finished tree whose inputs did not change,
+ * or a RUNNING tree that only waits for a timer or a completion. Such trees
+ * are not re-entered every frame, so their actions must not rely on it.
+ * Guards of reactive composites are likewise re-checked only when the tree is
+ * ticked; list the keys they read in their reads so a change wakes the tree.
+ *
+ * Keys are small integers mapped onto a 64-bit set; keys above 63 share bits
+ * with lower ones, which only costs spurious ticks.
+ */
+
+#ifndef C_BEHAVIOR_TREE_WATCH_H
+#define C_BEHAVIOR_TREE_WATCH_H
+
+#include <stdatomic.h>
+
+#include "bt.h"
+#include "bt_exec.h"
+
+/* ===== Keys ===== */
+
+/* Set of blackboard keys (bit k = key k modulo 64) */
+typedef uint64_t bt_keys_t;
+
+/* Set holding one key */
+#define BT_KEY(k) ((bt_keys_t)1U << ((uint32_t)(k) & 63U))
+
+/* ===== Scheduler =====
+ * Notes:
+ *  - Storage is provided by the caller; no allocation.
+ *  - bt_watch_touch() and bt_watch_round() run on the ticking thread; only
+ *    bt_watch_wake() may be called from other threads.
+ *  - Keys touched during a round (by the trees' own actions) are seen by the
+ *    next round, so every tree in a round sees the same set.
+ *  - Advance the trees' timer wheel with bt_timer_advance() before a round.
+ *    The deadline kept per tree is the wheel's earliest anchor, so a tree
+ *    sharing its wheel may be ticked early; that tick returns at once.
+ */
+typedef struct {
+  bt_node_t* root;    /* Tree root */
+  bt_exec_t* exec;    /* Engine that ticks it (with its timers and async queue) */
+  bt_keys_t watched;  /* Keys read anywhere in the tree */
+  bt_status_t status; /* Root status of the last tick */
+  bt_wake_t wake;     /* What the last tick waits for */
+  atomic_bool woken;  /* Tick at the next round regardless of keys */
+} bt_watch_tree_t;
+
+typedef struct {
+  bt_watch_tree_t* trees;
+  uint32_t count;
+  bt_keys_t dirty;  /* Keys touched since the current round started */
+  uint64_t ticked;  /* Trees ticked over all rounds */
+  uint64_t skipped; /* Trees skipped over all rounds */
+} bt_watch_t;
+
+/* ===== Public API ===== */
+
+/* Keys read anywhere in the tree at root (the union of the nodes' reads). */
+bt_keys_t bt_watch_keys(const bt_node_t* root);
+
+/* Bind a tree to its slot. The watched keys are computed once here; bind
+ * again after changing the tree's reads. The tree is ticked at the next round.
+ * Returns BT_SUCCESS, or BT_ERROR when tree, exec or root is NULL.
+ */
+bt_status_t bt_watch_bind(bt_watch_tree_t* tree, bt_exec_t* exec, bt_node_t* root);
+
+/* Attach count bound trees to a scheduler with no key dirty.
+ * Returns BT_SUCCESS, or BT_ERROR when watch is NULL or trees is NULL with
+ * count > 0.
+ */
+bt_status_t bt_watch_init(bt_watch_t* watch, bt_watch_tree_t trees[], uint32_t count);
+
+/* Mark keys as changed. */
+static inline void bt_watch_touch(bt_watch_t* watch, bt_keys_t keys) { watch->dirty |= keys; }
+
+/* Request a tick of one tree at the next round. Thread-safe. */
+void bt_watch_wake(bt_watch_tree_t* tree);
+
+/* bt_watch_wake() as a bt_async_notify_fn; ctx is the bt_watch_tree_t. */
+void bt_watch_notify(void* ctx);
+
+/* Tick every tree that needs it (see above), in array order, and clear the
+ * dirty keys seen by this round.
+ * Returns the number of trees ticked (0 when watch is NULL).
+ */
+uint32_t bt_watch_round(bt_watch_t* watch);
+
+#endif /* C_BEHAVIOR_TREE_WATCH_H */
@@ -0,0 +1,72 @@
+/*
+ * bt_xml.h
+ *
+ * Build a tree from a BehaviorTree.CPP-style XML description.
+ * The text is read in a single forward pass: nodes are created as their
+ * elements open and wired when they close, so there is no document tree and
+ * the cost is linear in the text length. Every node and child array is placed
+ * in one caller-provided arena; leaf names are resolved through a
+ * bt_registry_t.
+ *
+ * Supported subset:
+ *   <root main_tree_to_execute="Main">       optional wrapper
+ *     <BehaviorTree ID="Main">                exactly one root node
+ *       <Sequence> <Fallback> <Selector>      BT_SEQUENCE / BT_SELECTOR
+ *       <ReactiveSequence> <ReactiveFallback> BT_REACTIVE_SEQUENCE / BT_REACTIVE_SELECTOR
+ *       <Parallel success_count="-1" failure_count="1">
+ *                                             BT_PARALLEL (-1 = all children)
+ *       <Inverter>                            BT_INVERTER (one child)
+ *       <Action ID="Name"/> <Condition ID="Name"/> <Name/>
+ *                                             leaf registered as "Name"
+ *     </BehaviorTree>
+ *     <TreeNodesModel> ... </TreeNodesModel>  ignored
+ *   </root>
+ * The tree loaded is the one named by main_tree_to_execute, else the first.
+ * Other attributes (name, ports) are ignored, attribute values are compared
+ * as written (no entity decoding), and SubTree and other decorators are
+ * rejected. Comments, <?...?> and <!...> declarations are skipped.
+ */
+
+#ifndef C_BEHAVIOR_TREE_XML_H
+#define C_BEHAVIOR_TREE_XML_H
+
+#include <stddef.h>
+
+#include "bt.h"
+#include "bt_registry.h"
+
+/* ===== Public constants ===== */
+
+#ifndef BT_XML_MAX_DEPTH
+/* Deepest element nesting accepted (including <root> and <BehaviorTree>) */
+#define BT_XML_MAX_DEPTH (64U)
+#endif
+
+/* ===== Load result ===== */
+
+typedef struct {
+  bt_node_t* root;   /* Root node in the arena (NULL on error or when measuring) */
+  uint16_t nodes;    /* Nodes created, numbered by bt_assign_ids() */
+  size_t used;       /* Arena bytes needed, including temporary child lists */
+  uint32_t line;     /* 1-based line of the error, 0 on success */
+  const char* error; /* Static description of the error, NULL on success */
+} bt_xml_result_t;
+
+/* ===== Public API ===== */
+
+/* Load a tree from len bytes of XML text.
+ * Nodes are bt_init()'ed with the registered tick and user_data, and
+ * blackboard is set on every node; PARALLEL and BT_ASYNC state lives in the
+ * arena. The loaded tree is numbered by bt_assign_ids() and must pass
+ * bt_validate(). With arena == NULL nothing
+ * is built and result->used reports the arena size the same text needs (size
+ * the arena with it, then load again). The arena must be aligned for pointers and stay
+ * valid while the tree is used.
+ * Returns BT_SUCCESS, or BT_ERROR with result->error/line set on a syntax
+ * error, an unknown or unsupported node, a bad PARALLEL policy, too deep
+ * nesting, an arena that is too small or a tree bt_validate() rejects.
+ */
+bt_status_t bt_xml_load(const char* text, size_t len, const bt_registry_t* reg, void* blackboard, void* arena,
+                        size_t arena_size, bt_xml_result_t* result);
+
+#endif /* C_BEHAVIOR_TREE_XML_H */
@@ -3,45 +3,22 @@
  *
  * Implementation of the simplified Behavior Tree (BT) core.
  * Provides the tick dispatcher and node traversal logic for
- * ACTION, CONDITION, SEQUENCE, SELECTOR and INVERTER node types.
+ * ACTION, CONDITION, SEQUENCE, SELECTOR, INVERTER and PARALLEL node types,
+ * and the reactive SEQUENCE/SELECTOR variants.
  * The implementation is small, portable and avoids dynamic memory
  * allocation; users create nodes and wire the tree manually.
  */
 
 #include "bt.h"
 
-/* ===== Internal constants ===== */
-#define UINT16_ZERO ((uint16_t)0)
-#define UINT16_ONE ((uint16_t)1)
+#include "bt_internal.h"
+#include "bt_profile.h"
 
 /* ===== Internal helpers ===== */
 
-/* Call the node's on_enter hook if it exists.
- * Parameters:
- *   - node: pointer to the node (may be NULL). If NULL or no hook set, nothing happens.
- */
-static void bt_call_enter(bt_node_t* node) {
-  if ((node != BT_NULL) && (node->on_enter != BT_NULL)) {
-    node->on_enter(node);
-  } else {
-    /* No action */
-  }
-}
-
-/* Call the node's on_exit hook if it exists.
- * Parameters:
- *   - node: pointer to the node (may be NULL). If NULL or no hook set, nothing happens.
- */
-static void bt_call_exit(bt_node_t* node) {
-  if ((node != BT_NULL) && (node->on_exit != BT_NULL)) {
-    node->on_exit(node);
-  } else {
-    /* No action */
-  }
-}
-
-/* Forward declaration for dispatcher */
+/* Forward declarations for dispatchers */
 static bt_status_t bt_tick_internal(bt_node_t* node);
+static bt_status_t bt_tick_unchecked(bt_node_t* node);
 
 /* Defensive child fetch (returns NULL if out-of-range or array is NULL)
  * Parameters:
@@ -68,7 +45,7 @@ static bt_node_t* bt_child_at(const bt_node_t* node, uint16_t index) {
  * Parameters:
  *   - node: pointer to node to initialize (must not be NULL)
  *   - type: node type (ACTION/CONDITION/SEQUENCE/...)
- *   - tick_fn: leaf tick callback (for ACTION/CONDITION) or NULL
+ *   - tick_fn: leaf tick callback (for ACTION/CONDITION/ASYNC) or NULL
  *   - children: array of child pointers (may be NULL if children_count == 0)
  *   - children_count: number of children in the array
  *   - user_data: opaque pointer stored in node->user_data
@@ -86,7 +63,12 @@ void bt_init(bt_node_t* node, bt_node_type_t type, bt_tick_fn tick_fn, bt_node_t
     node->children = (children_count > UINT16_ZERO) ? (bt_node_t**)children : BT_NULL;
     node->children_count = children_count;
     node->current_child = UINT16_ZERO;
-    node->time_anchor_ms = 0U; /* Optional, unused by core */
+    node->id = UINT16_ZERO; /* See bt_assign_ids() */
+    node->validated = false;  /* See bt_validate() */
+    node->ext = BT_NULL;      /* See bt_set_parallel() */
+    node->time_anchor_ms = 0U; /* Optional, see bt_timer.h */
+    node->timer_entry = UINT16_ZERO; /* Not parked */
+    node->reads = 0U; /* Optional, see bt_watch.h */
     node->user_data = user_data;
     node->blackboard = BT_NULL;
   } else {
@@ -94,7 +76,27 @@ void bt_init(bt_node_t* node, bt_node_type_t type, bt_tick_fn tick_fn, bt_node_t
   }
 }
 
-/* Tick a leaf node (ACTION or CONDITION).
+/* Attach PARALLEL state and thresholds; see bt.h. */
+bt_status_t bt_set_parallel(bt_node_t* node, bt_parallel_t* state, uint16_t success_threshold,
+                            uint16_t failure_threshold) {
+  bt_status_t result = BT_ERROR;
+
+  if ((node != BT_NULL) && (state != BT_NULL) && (node->type == BT_PARALLEL) &&
+      bt_parallel_policy_ok(node->children_count, success_threshold, failure_threshold)) {
+    state->success_threshold = success_threshold;
+    state->failure_threshold = failure_threshold;
+    state->done_mask = 0U;
+    state->success_mask = 0U;
+    node->ext = state;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Tick a leaf node (ACTION, CONDITION or ASYNC).
  * Parameters:
  *   - node: leaf node pointer
  * Returns:
@@ -110,11 +112,11 @@ static bt_status_t bt_tick_leaf(bt_node_t* node) {
   } else {
     if (node->tick == BT_NULL) {
       result = BT_ERROR;
-      node->status = BT_ERROR;
+      bt_set_status(node, BT_ERROR);
     } else {
-      /* User code decides status */
-      result = node->tick(node);
-      node->status = result;
+      /* User code decides status; an ASYNC leaf reports its pending operation */
+      result = (node->type == BT_ASYNC) ? bt_async_step(node) : node->tick(node);
+      bt_set_status(node, result);
     }
   }
 
@@ -151,7 +153,7 @@ static bt_status_t bt_tick_sequence(bt_node_t* node) {
 
       if (child == BT_NULL) {
         result = BT_ERROR;
-        node->status = BT_ERROR;
+        bt_set_status(node, BT_ERROR);
         break;
       } else {
         cs = bt_tick_internal(child);
@@ -159,17 +161,17 @@ static bt_status_t bt_tick_sequence(bt_node_t* node) {
 
       if (cs == BT_RUNNING) {
         node->current_child = i; /* Stay on this child */
-        node->status = BT_RUNNING;
+        bt_set_status(node, BT_RUNNING);
         result = BT_RUNNING;
         break;
       } else if (cs == BT_FAILURE) {
         node->current_child = i;
-        node->status = BT_FAILURE;
+        bt_set_status(node, BT_FAILURE);
         result = BT_FAILURE;
         break;
       } else if (cs == BT_ERROR) {
         node->current_child = i;
-        node->status = BT_ERROR;
+        bt_set_status(node, BT_ERROR);
         result = BT_ERROR;
         break;
       } else {
@@ -181,7 +183,7 @@ static bt_status_t bt_tick_sequence(bt_node_t* node) {
 
     /* If all children consumed without RUNNING/FAILURE/ERROR, sequence succeeded */
     if ((result != BT_RUNNING) && (node->current_child >= node->children_count)) {
-      node->status = BT_SUCCESS;
+      bt_set_status(node, BT_SUCCESS);
       result = BT_SUCCESS;
     }
 
@@ -226,7 +228,7 @@ static bt_status_t bt_tick_selector(bt_node_t* node) {
 
       if (child == BT_NULL) {
         result = BT_ERROR;
-        node->status = BT_ERROR;
+        bt_set_status(node, BT_ERROR);
         break;
       } else {
         cs = bt_tick_internal(child);
@@ -234,17 +236,17 @@ static bt_status_t bt_tick_selector(bt_node_t* node) {
 
       if (cs == BT_RUNNING) {
         node->current_child = i;
-        node->status = BT_RUNNING;
+        bt_set_status(node, BT_RUNNING);
         result = BT_RUNNING;
         break;
       } else if (cs == BT_SUCCESS) {
         node->current_child = i;
-        node->status = BT_SUCCESS;
+        bt_set_status(node, BT_SUCCESS);
         result = BT_SUCCESS;
         break;
       } else if (cs == BT_ERROR) {
         node->current_child = i;
-        node->status = BT_ERROR;
+        bt_set_status(node, BT_ERROR);
         result = BT_ERROR;
         break;
       } else {
@@ -256,7 +258,7 @@ static bt_status_t bt_tick_selector(bt_node_t* node) {
 
     /* If we ran out of children and none succeeded or ran, selector fails */
     if ((result != BT_RUNNING) && (node->current_child >= node->children_count)) {
-      node->status = BT_FAILURE;
+      bt_set_status(node, BT_FAILURE);
       result = BT_FAILURE;
     }
 
@@ -304,7 +306,7 @@ static bt_status_t bt_tick_inverter(bt_node_t* node) {
         result = cs;
       }
 
-      node->status = result;
+      bt_set_status(node, result);
 
       if ((result == BT_SUCCESS) || (result == BT_FAILURE) || (result == BT_ERROR)) {
         bt_call_exit(node);
@@ -317,8 +319,212 @@ static bt_status_t bt_tick_inverter(bt_node_t* node) {
   return result;
 }
 
+/* Tick a PARALLEL composite node.
+ * Behavior:
+ *   - Ticks, in order, every child that has not finished in the current run;
+ *     children that already succeeded or failed are not ticked again.
+ *   - Succeeds once success_threshold children succeeded, fails once
+ *     failure_threshold children failed or success can no longer be reached,
+ *     and stays RUNNING otherwise. It settles as soon as the outcome is known,
+ *     so later children are not ticked on that tick.
+ *   - A child ERROR (or a NULL child) makes the parallel return ERROR.
+ * Notes:
+ *   - Finished children are tracked in done_mask/success_mask, cleared on entry.
+ *   - Children still RUNNING when the parallel settles are halted (see
+ *     bt_halt()) before its on_exit, so its next entry starts them afresh.
+ *   - Invalid thresholds return ERROR without firing hooks (see bt_set_parallel()).
+ */
+static bt_status_t bt_tick_parallel(bt_node_t* node) {
+  bt_status_t result = BT_ERROR;
+  bt_parallel_t* par = BT_NULL;
+  uint16_t i = UINT16_ZERO;
+
+  if (node == BT_NULL) {
+    result = BT_ERROR;
+  } else if (!bt_parallel_ok(node)) {
+    result = BT_ERROR;
+    bt_set_status(node, BT_ERROR);
+  } else {
+    par = bt_parallel_of(node);
+    if (node->status != BT_RUNNING) {
+      par->done_mask = 0U;
+      par->success_mask = 0U;
+      bt_call_enter(node);
+    }
+
+    result = BT_RUNNING;
+
+    for (i = UINT16_ZERO; (i < node->children_count) && (result == BT_RUNNING); i++) {
+      const uint32_t bit = (uint32_t)1U << i;
+
+      if ((par->done_mask & bit) == 0U) {
+        bt_node_t* child = bt_child_at(node, i);
+        const bt_status_t cs = (child != BT_NULL) ? bt_tick_internal(child) : BT_ERROR;
+
+        if (cs == BT_SUCCESS) {
+          par->done_mask |= bit;
+          par->success_mask |= bit;
+        } else if (cs == BT_FAILURE) {
+          par->done_mask |= bit;
+        } else {
+          /* RUNNING: tick again next time; ERROR is handled below */
+        }
+
+        result = (cs == BT_ERROR) ? BT_ERROR : bt_parallel_decide(node, par->done_mask, par->success_mask);
+      } else {
+        /* Finished earlier in this run */
+      }
+    }
+
+    bt_set_status(node, result);
+
+    if ((result == BT_SUCCESS) || (result == BT_FAILURE) || (result == BT_ERROR)) {
+      bt_parallel_halt_rest(node, BT_NULL);
+      bt_call_exit(node);
+    } else {
+      /* Still running */
+    }
+  }
+
+  return result;
+}
+
+/* Halt a node left RUNNING and the RUNNING path below it; see bt.h.
+ * Behavior:
+ *   - Follows current_child of SEQUENCE/SELECTOR (and their reactive
+ *     variants), the child of an INVERTER and the unfinished children of a
+ *     PARALLEL; nodes that are not RUNNING end the walk.
+ *   - With timers, every node met on the walk (including the idle one that
+ *     ends it, e.g. a parked composite) is removed from the wheel and its
+ *     anchor cleared: the wait belonged to the abandoned run.
+ *   - Children are halted before their parent, so on_exit fires deepest first.
+ */
+uint16_t bt_halt_in(bt_node_t* node, bt_timer_wheel_t* timers) {
+  uint16_t halted = UINT16_ZERO;
+  uint16_t i = UINT16_ZERO;
+
+  if ((node != BT_NULL) && (timers != BT_NULL) && bt_timer_is_parked(node)) {
+    bt_timer_cancel(timers, node);
+    node->time_anchor_ms = bt_timer_is_parked(node) ? node->time_anchor_ms : 0U; /* Kept if in another wheel */
+  } else {
+    /* Not parked */
+  }
+
+  if ((node != BT_NULL) && (node->status == BT_RUNNING)) {
+    switch (node->type) {
+      case BT_SEQUENCE:
+      case BT_SELECTOR:
+      case BT_REACTIVE_SEQUENCE:
+      case BT_REACTIVE_SELECTOR: {
+        halted = bt_halt_in(bt_child_at(node, node->current_child), timers);
+        break;
+      }
+
+      case BT_INVERTER: {
+        halted = bt_halt_in(bt_child_at(node, UINT16_ZERO), timers);
+        break;
+      }
+
+      case BT_PARALLEL: {
+        bt_parallel_t* const par = bt_parallel_of(node);
+
+        for (i = UINT16_ZERO; (par != BT_NULL) && (i < node->children_count) && (i < BT_PARALLEL_MAX_CHILDREN);
+             i++) {
+          if ((par->done_mask & ((uint32_t)1U << i)) == 0U) {
+            halted = (uint16_t)(halted + bt_halt_in(bt_child_at(node, i), timers));
+          } else {
+            /* Finished in this run */
+          }
+        }
+        if (par != BT_NULL) {
+          par->done_mask = 0U;
+          par->success_mask = 0U;
+        }
+        break;
+      }
+
+      default: {
+        /* Leaves have no children */
+        break;
+      }
+    }
+
+    node->current_child = UINT16_ZERO;
+    bt_set_status(node, BT_FAILURE);
+    halted++;
+
+    if ((node->type != BT_ACTION) && (node->type != BT_CONDITION) && (node->type != BT_ASYNC)) {
+      bt_call_exit(node);
+    } else {
+      /* Leaves have no hooks */
+    }
+  } else {
+    /* Idle or finished: nothing to halt */
+  }
+
+  return halted;
+}
+
+uint16_t bt_halt(bt_node_t* node) { return bt_halt_in(node, BT_NULL); }
+
+/* Tick a reactive SEQUENCE (keep_going = SUCCESS) or SELECTOR (FAILURE).
+ * Parameters:
+ *   - node: reactive composite
+ *   - keep_going: child status that moves on to the next child
+ *   - tick: engine used for children (checked or unchecked)
+ * Behavior:
+ *   - Entered (not RUNNING): runs like bt_tick_sequence()/bt_tick_selector().
+ *   - Resumed: re-ticks only the guards (CONDITION children) before
+ *     current_child. The first one
+ *     that does not return keep_going halts the running child, becomes
+ *     current_child and its status is the composite's; when all hold, the
+ *     running child is resumed as usual.
+ */
+static bt_status_t bt_tick_reactive(bt_node_t* node, bt_status_t keep_going, bt_status_t (*tick)(bt_node_t* node)) {
+  bt_status_t result = keep_going;
+  uint16_t i = UINT16_ZERO;
+
+  if (node->status != BT_RUNNING) {
+    node->current_child = UINT16_ZERO;
+    bt_call_enter(node);
+  } else {
+    for (i = UINT16_ZERO; (i < node->current_child) && (result == keep_going); i++) {
+      bt_node_t* guard = bt_child_at(node, i);
+
+      if ((guard != BT_NULL) && (guard->type == BT_CONDITION)) {
+        result = tick(guard);
+        if (result != keep_going) {
+          (void)bt_halt(bt_child_at(node, node->current_child));
+          node->current_child = i;
+        } else {
+          /* Guard still holds */
+        }
+      } else {
+        /* Not a guard: finished for this run */
+      }
+    }
+  }
+
+  /* Resume (or start) at current_child unless a guard decided the tick */
+  for (i = node->current_child; (i < node->children_count) && (result == keep_going); i++) {
+    bt_node_t* child = bt_child_at(node, i);
+
+    result = (child != BT_NULL) ? tick(child) : BT_ERROR;
+    node->current_child = (result == keep_going) ? (uint16_t)(i + UINT16_ONE) : i;
+  }
+
+  bt_set_status(node, result);
+  if (bt_is_terminal(result)) {
+    bt_call_exit(node);
+  } else {
+    /* Still running */
+  }
+
+  return result;
+}
+
 /* Internal dispatcher: call appropriate tick based on node->type. */
-static bt_status_t bt_tick_internal(bt_node_t* node) {
+static bt_status_t bt_tick_dispatch(bt_node_t* node) {
   bt_status_t result = BT_ERROR;
 
   if (node == BT_NULL) {
@@ -326,7 +532,8 @@ static bt_status_t bt_tick_internal(bt_node_t* node) {
   } else {
     switch (node->type) {
       case BT_ACTION:
-      case BT_CONDITION: {
+      case BT_CONDITION:
+      case BT_ASYNC: {
         result = bt_tick_leaf(node);
         break;
       }
@@ -346,9 +553,24 @@ static bt_status_t bt_tick_internal(bt_node_t* node) {
         break;
       }
 
+      case BT_PARALLEL: {
+        result = bt_tick_parallel(node);
+        break;
+      }
+
+      case BT_REACTIVE_SEQUENCE: {
+        result = bt_tick_reactive(node, BT_SUCCESS, bt_tick_internal);
+        break;
+      }
+
+      case BT_REACTIVE_SELECTOR: {
+        result = bt_tick_reactive(node, BT_FAILURE, bt_tick_internal);
+        break;
+      }
+
       default: {
         result = BT_ERROR;
-        node->status = BT_ERROR;
+        bt_set_status(node, BT_ERROR);
         break;
       }
     }
@@ -357,15 +579,341 @@ static bt_status_t bt_tick_internal(bt_node_t* node) {
   return result;
 }
 
-/* Public API: tick from the given root node. Returns node status after tick. */
-bt_status_t bt_tick(bt_node_t* root) {
+/* ===== Unchecked engine =====
+ * Used for trees that passed bt_validate(): every child pointer is set,
+ * leaves have a callback, INVERTERs have one child and PARALLEL policies are
+ * valid, so these functions skip the per-visit checks of the ones above.
+ * Statuses, hooks and traces are the same.
+ */
+
+static bt_status_t bt_tick_leaf_unchecked(bt_node_t* node) {
+  const bt_status_t result = (node->type == BT_ASYNC) ? bt_async_step(node) : node->tick(node);
+
+  bt_set_status(node, result);
+  return result;
+}
+
+static bt_status_t bt_tick_sequence_unchecked(bt_node_t* node) {
+  bt_status_t result = BT_SUCCESS;
+  uint16_t i = UINT16_ZERO;
+
+  if (node->status != BT_RUNNING) {
+    node->current_child = UINT16_ZERO;
+    bt_call_enter(node);
+  }
+
+  for (i = node->current_child; (i < node->children_count) && (result == BT_SUCCESS); i++) {
+    result = bt_tick_unchecked(node->children[i]);
+    node->current_child = (result == BT_SUCCESS) ? (uint16_t)(i + UINT16_ONE) : i;
+  }
+
+  bt_set_status(node, result);
+  if (bt_is_terminal(result)) {
+    bt_call_exit(node);
+  } else {
+    /* Still running */
+  }
+
+  return result;
+}
+
+static bt_status_t bt_tick_selector_unchecked(bt_node_t* node) {
+  bt_status_t result = BT_FAILURE;
+  uint16_t i = UINT16_ZERO;
+
+  if (node->status != BT_RUNNING) {
+    node->current_child = UINT16_ZERO;
+    bt_call_enter(node);
+  }
+
+  for (i = node->current_child; (i < node->children_count) && (result == BT_FAILURE); i++) {
+    result = bt_tick_unchecked(node->children[i]);
+    node->current_child = (result == BT_FAILURE) ? (uint16_t)(i + UINT16_ONE) : i;
+  }
+
+  bt_set_status(node, result);
+  if (bt_is_terminal(result)) {
+    bt_call_exit(node);
+  } else {
+    /* Still running */
+  }
+
+  return result;
+}
+
+static bt_status_t bt_tick_inverter_unchecked(bt_node_t* node) {
   bt_status_t result = BT_ERROR;
 
-  if (root != BT_NULL) {
-    result = bt_tick_internal(root);
+  if (node->status != BT_RUNNING) {
+    bt_call_enter(node);
+  }
+
+  result = bt_tick_unchecked(node->children[0]);
+  if (result == BT_SUCCESS) {
+    result = BT_FAILURE;
+  } else if (result == BT_FAILURE) {
+    result = BT_SUCCESS;
+  } else {
+    /* RUNNING and ERROR propagate */
+  }
+
+  bt_set_status(node, result);
+  if (bt_is_terminal(result)) {
+    bt_call_exit(node);
+  } else {
+    /* Still running */
+  }
+
+  return result;
+}
+
+static bt_status_t bt_tick_parallel_unchecked(bt_node_t* node) {
+  bt_status_t result = BT_RUNNING;
+  bt_parallel_t* const par = bt_parallel_of(node);
+  uint16_t i = UINT16_ZERO;
+
+  if (node->status != BT_RUNNING) {
+    par->done_mask = 0U;
+    par->success_mask = 0U;
+    bt_call_enter(node);
+  }
+
+  for (i = UINT16_ZERO; (i < node->children_count) && (result == BT_RUNNING); i++) {
+    const uint32_t bit = (uint32_t)1U << i;
+
+    if ((par->done_mask & bit) == 0U) {
+      const bt_status_t cs = bt_tick_unchecked(node->children[i]);
+
+      if (cs == BT_SUCCESS) {
+        par->done_mask |= bit;
+        par->success_mask |= bit;
+      } else if (cs == BT_FAILURE) {
+        par->done_mask |= bit;
+      } else {
+        /* RUNNING: tick again next time; ERROR is handled below */
+      }
+
+      result = (cs == BT_ERROR) ? BT_ERROR : bt_parallel_decide(node, par->done_mask, par->success_mask);
+    } else {
+      /* Finished earlier in this run */
+    }
+  }
+
+  bt_set_status(node, result);
+  if (bt_is_terminal(result)) {
+    bt_parallel_halt_rest(node, BT_NULL);
+    bt_call_exit(node);
+  } else {
+    /* Still running */
+  }
+
+  return result;
+}
+
+static bt_status_t bt_tick_dispatch_unchecked(bt_node_t* node) {
+  bt_status_t result = BT_ERROR;
+
+  switch (node->type) {
+    case BT_ACTION:
+    case BT_CONDITION:
+    case BT_ASYNC: {
+      result = bt_tick_leaf_unchecked(node);
+      break;
+    }
+
+    case BT_SEQUENCE: {
+      result = bt_tick_sequence_unchecked(node);
+      break;
+    }
+
+    case BT_SELECTOR: {
+      result = bt_tick_selector_unchecked(node);
+      break;
+    }
+
+    case BT_INVERTER: {
+      result = bt_tick_inverter_unchecked(node);
+      break;
+    }
+
+    case BT_PARALLEL: {
+      result = bt_tick_parallel_unchecked(node);
+      break;
+    }
+
+    case BT_REACTIVE_SEQUENCE: {
+      result = bt_tick_reactive(node, BT_SUCCESS, bt_tick_unchecked);
+      break;
+    }
+
+    case BT_REACTIVE_SELECTOR: {
+      result = bt_tick_reactive(node, BT_FAILURE, bt_tick_unchecked);
+      break;
+    }
+
+    default: {
+      result = BT_ERROR; /* Rejected by bt_validate() */
+      break;
+    }
+  }
+
+  return result;
+}
+
+/* Tick one node through dispatch, updating the calling thread's profile
+ * table when profiling is compiled in (see bt_profile.h).
+ * Notes:
+ *   - child_time accumulates the inclusive time of profiled descendants
+ *     ticked below the current node; it is saved and cleared on entry and
+ *     restored (plus this node's time) on exit, so exclusive time needs no
+ *     per-node stack.
+ */
+static inline bt_status_t bt_tick_timed(bt_node_t* node, bt_status_t (*dispatch)(bt_node_t* node)) {
+  bt_status_t result = BT_ERROR;
+#if BT_PROFILE
+  bt_profile_t* const prof = bt_profile_tls;
+
+  if ((prof != BT_NULL) && (node != BT_NULL) && (node->id < prof->count)) {
+    const uint64_t outer = prof->child_time;
+    uint64_t start = 0U;
+    uint64_t inclusive = 0U;
+
+    prof->child_time = 0U;
+    start = bt_trace_clock();
+    result = dispatch(node);
+    inclusive = bt_trace_clock() - start;
+    bt_profile_record(&prof->nodes[node->id], result, inclusive, prof->child_time);
+    prof->child_time = outer + inclusive;
+  } else {
+    result = dispatch(node);
+  }
+#else
+  result = dispatch(node);
+#endif
+
+  return result;
+}
+
+static bt_status_t bt_tick_internal(bt_node_t* node) { return bt_tick_timed(node, bt_tick_dispatch); }
+
+static bt_status_t bt_tick_unchecked(bt_node_t* node) { return bt_tick_timed(node, bt_tick_dispatch_unchecked); }
+
+/* Check a node and its subtree for bt_validate().
+ * Parameters:
+ *   - node: subtree root
+ *   - path: nodes from the tree root down to node's parent
+ *   - depth: number of entries in path
+ * Returns:
+ *   - true when the subtree is well formed
+ */
+static bool bt_validate_from(const bt_node_t* node, const bt_node_t* path[], uint16_t depth) {
+  bool ok = (node != BT_NULL) && (depth < BT_VALIDATE_MAX_DEPTH);
+  uint16_t i = UINT16_ZERO;
+
+  for (i = UINT16_ZERO; ok && (i < depth); i++) {
+    ok = (path[i] != node); /* Cycle */
+  }
+
+  if (!ok) {
+    /* No action */
+  } else if ((node->type == BT_ACTION) || (node->type == BT_CONDITION) || (node->type == BT_ASYNC)) {
+    ok = (node->tick != BT_NULL) && ((node->type != BT_ASYNC) || (node->ext != BT_NULL));
+  } else if ((node->type == BT_SEQUENCE) || (node->type == BT_SELECTOR) || (node->type == BT_INVERTER) ||
+             (node->type == BT_PARALLEL) || (node->type == BT_REACTIVE_SEQUENCE) ||
+             (node->type == BT_REACTIVE_SELECTOR)) {
+    ok = ((node->children != BT_NULL) || (node->children_count == UINT16_ZERO)) &&
+         ((node->type != BT_INVERTER) || (node->children_count == UINT16_ONE)) &&
+         ((node->type != BT_PARALLEL) || bt_parallel_ok(node));
+    path[depth] = node;
+    for (i = UINT16_ZERO; ok && (i < node->children_count); i++) {
+      ok = bt_validate_from(node->children[i], path, (uint16_t)(depth + UINT16_ONE));
+    }
+  } else {
+    ok = false; /* Unknown type */
+  }
+
+  return ok;
+}
+
+/* Set or clear the validated flag on a subtree already checked by
+ * bt_validate_from() (or on its root alone when it failed). */
+static void bt_mark_validated(bt_node_t* node, bool validated, bool recurse) {
+  uint16_t i = UINT16_ZERO;
+
+  node->validated = validated;
+  if (recurse && (node->type != BT_ACTION) && (node->type != BT_CONDITION) && (node->type != BT_ASYNC)) {
+    for (i = UINT16_ZERO; i < node->children_count; i++) {
+      bt_mark_validated(node->children[i], validated, recurse);
+    }
+  } else {
+    /* Leaf, or only the root is cleared */
+  }
+}
+
+/* Number a node and its subtree in pre-order.
+ * Parameters:
+ *   - node: subtree root (may be NULL)
+ *   - next: id for node
+ * Returns:
+ *   - the first id after the subtree
+ * Notes:
+ *   - Leaves never expand their children array, as in bt_compile().
+ */
+static uint16_t bt_assign_ids_from(bt_node_t* node, uint16_t next) {
+  uint16_t id = next;
+
+  if (node != BT_NULL) {
+    node->id = id;
+    id++;
+
+    if ((node->type != BT_ACTION) && (node->type != BT_CONDITION) && (node->type != BT_ASYNC) &&
+        (node->children != BT_NULL)) {
+      uint16_t i;
+
+      for (i = UINT16_ZERO; i < node->children_count; i++) {
+        id = bt_assign_ids_from(node->children[i], id);
+      }
+    } else {
+      /* Leaf or no children */
+    }
+  } else {
+    /* No action */
+  }
+
+  return id;
+}
+
+uint16_t bt_assign_ids(bt_node_t* root) { return bt_assign_ids_from(root, UINT16_ZERO); }
+
+bt_status_t bt_validate(bt_node_t* root) {
+  const bt_node_t* path[BT_VALIDATE_MAX_DEPTH];
+  bt_status_t result = BT_ERROR;
+
+  if (root == BT_NULL) {
+    result = BT_ERROR;
+  } else if (bt_validate_from(root, path, UINT16_ZERO)) {
+    bt_mark_validated(root, true, true);
+    result = BT_SUCCESS;
   } else {
+    bt_mark_validated(root, false, false);
     result = BT_ERROR;
   }
 
   return result;
 }
+
+/* Public API: tick from the given root node. Returns node status after tick.
+ * A root flagged by bt_validate() runs the unchecked engine. */
+bt_status_t bt_tick(bt_node_t* root) {
+  bt_status_t result = BT_ERROR;
+
+  if (root == BT_NULL) {
+    result = BT_ERROR;
+  } else if (root->validated) {
+    result = bt_tick_unchecked(root);
+  } else {
+    result = bt_tick_internal(root);
+  }
+
+  return result;
+}
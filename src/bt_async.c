@@ -0,0 +1,172 @@
+/*
+ * bt_async.c
+ *
+ * Completion queue for BT_ASYNC leaves: a bounded MPSC ring where each slot
+ * carries a sequence number. A slot at position p is free for producers when
+ * seq == p and holds a completion for the consumer when seq == p + 1; the
+ * consumer frees it for the next lap by setting seq = p + capacity.
+ */
+
+#include "bt_async.h"
+
+#include "bt_internal.h"
+
+/* ===== Internal helpers ===== */
+
+/* Hand a drained completion to its leaf.
+ * Returns:
+ *   - true when the leaf was still waiting for this operation
+ */
+static bool bt_async_deliver(const bt_async_slot_t* slot) {
+  bt_node_t* node = slot->token.node;
+  bool delivered = false;
+
+  if (bt_async_pending(node) && (((bt_async_op_t*)node->ext)->gen == slot->token.gen)) {
+    ((bt_async_op_t*)node->ext)->result = slot->status;
+    delivered = true;
+  } else {
+    /* Stale: the leaf finished or started another operation since */
+  }
+
+  return delivered;
+}
+
+/* ===== Public API ===== */
+
+bt_status_t bt_set_async(bt_node_t* node, bt_async_op_t* op) {
+  bt_status_t result = BT_ERROR;
+
+  if ((node != BT_NULL) && (op != BT_NULL) && (node->type == BT_ASYNC)) {
+    op->gen = 0U;
+    op->result = BT_FAILURE; /* No operation pending */
+    node->ext = op;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_async_init(bt_async_queue_t* queue, bt_async_slot_t slots[], uint32_t capacity) {
+  bt_status_t result = BT_ERROR;
+
+  if ((queue != BT_NULL) && (slots != BT_NULL) && (capacity > 0U) && ((capacity & (capacity - 1U)) == 0U)) {
+    uint32_t i;
+
+    for (i = 0U; i < capacity; i++) {
+      atomic_init(&slots[i].seq, i);
+      slots[i].token.node = BT_NULL;
+      slots[i].token.gen = 0U;
+      slots[i].status = BT_ERROR;
+    }
+    queue->slots = slots;
+    queue->mask = capacity - 1U;
+    queue->notify = BT_NULL;
+    queue->notify_ctx = BT_NULL;
+    atomic_init(&queue->tail, 0U);
+    queue->head = 0U;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+void bt_async_set_notify(bt_async_queue_t* queue, bt_async_notify_fn notify, void* ctx) {
+  if (queue != BT_NULL) {
+    queue->notify = notify;
+    queue->notify_ctx = ctx;
+  } else {
+    /* No action */
+  }
+}
+
+/* Post a completion; see bt_async.h.
+ * Behavior:
+ *   - A producer that loses the CAS on tail retries at the position it read
+ *     back; one that finds the slot still in use a lap behind reports full.
+ */
+bt_status_t bt_async_complete(bt_async_queue_t* queue, bt_async_token_t token, bt_status_t status) {
+  bt_status_t result = BT_ERROR;
+
+  if ((queue == BT_NULL) || (token.node == BT_NULL) || !bt_is_terminal(status)) {
+    result = BT_ERROR;
+  } else {
+    unsigned pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    bt_async_slot_t* slot = BT_NULL;
+    bool full = false;
+
+    while ((slot == BT_NULL) && !full) {
+      bt_async_slot_t* candidate = &queue->slots[pos & queue->mask];
+      const int32_t lag = (int32_t)(atomic_load_explicit(&candidate->seq, memory_order_acquire) - pos);
+
+      if (lag == 0) {
+        if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1U, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+          slot = candidate;
+        } else {
+          /* Lost the race: pos holds the current tail */
+        }
+      } else if (lag < 0) {
+        full = true; /* Consumer has not freed this slot yet */
+      } else {
+        pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+      }
+    }
+
+    if (slot != BT_NULL) {
+      slot->token = token;
+      slot->status = status;
+      atomic_store_explicit(&slot->seq, pos + 1U, memory_order_release);
+
+      if (queue->notify != BT_NULL) {
+        queue->notify(queue->notify_ctx);
+      } else {
+        /* No action */
+      }
+      result = BT_SUCCESS;
+    } else {
+      result = BT_FAILURE;
+    }
+  }
+
+  return result;
+}
+
+/* Drain completions; see bt_async.h.
+ * Behavior:
+ *   - Stops at the first slot not yet published, even if a later producer
+ *     already finished: completions are delivered in claim order.
+ */
+uint32_t bt_async_drain(bt_async_queue_t* queue) {
+  uint32_t delivered = 0U;
+
+  if (queue != BT_NULL) {
+    uint32_t budget = queue->mask + 1U;
+    bool more = true;
+
+    while (more && (budget > 0U)) {
+      bt_async_slot_t* slot = &queue->slots[queue->head & queue->mask];
+      const unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+      if (seq == (queue->head + 1U)) {
+        if (bt_async_deliver(slot)) {
+          delivered++;
+        } else {
+          /* Dropped */
+        }
+        atomic_store_explicit(&slot->seq, queue->head + queue->mask + 1U, memory_order_release);
+        queue->head++;
+        budget--;
+      } else {
+        more = false; /* Empty, or the next producer is still writing */
+      }
+    }
+  } else {
+    /* No action */
+  }
+
+  return delivered;
+}
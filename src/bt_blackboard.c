@@ -0,0 +1,205 @@
+/*
+ * bt_blackboard.c
+ *
+ * Key declaration and name interning for the typed blackboard; see
+ * bt_blackboard.h. The name index probes linearly like bt_registry.c and
+ * hashes with bt_registry_hash(). Subscriptions live in a flat table that
+ * bt_blackboard_flush() scans once per batch.
+ */
+
+#include "bt_blackboard.h"
+
+#include <string.h>
+
+#include "bt_internal.h"
+#include "bt_registry.h"
+
+/* ===== Internal constants ===== */
+
+/* Parts of a bt_bb_sub_id_t */
+#define BT_BB_SUB_INDEX(sub) ((uint16_t)((sub) & 0xFFFFU))
+#define BT_BB_SUB_GEN(sub) ((uint16_t)((sub) >> 16U))
+
+/* ===== Internal helpers ===== */
+
+/* Name index entry holding name, or the free entry where it would go. */
+static bt_bb_name_t* bt_blackboard_entry(const bt_blackboard_t* bb, const char* name, size_t len, uint32_t hash) {
+  uint32_t i = hash & bb->mask;
+
+  while ((bb->names[i].name != BT_NULL) &&
+         ((bb->names[i].hash != hash) || (bb->names[i].len != len) || (memcmp(bb->names[i].name, name, len) != 0))) {
+    i = (i + 1U) & bb->mask;
+  }
+
+  return &bb->names[i];
+}
+
+/* Take the next slot for a key of the given type. */
+static bt_bb_key_t bt_blackboard_add(bt_blackboard_t* bb, bt_bb_type_t type) {
+  const bt_bb_key_t key = bb->count;
+
+  bb->slots[key].value.bits = 0U;
+  bb->slots[key].version = 0U;
+  bb->slots[key].type = (uint8_t)type;
+  bb->count++;
+
+  return key;
+}
+
+/* ===== Public API ===== */
+
+bt_status_t bt_blackboard_init(bt_blackboard_t* bb, bt_bb_slot_t slots[], uint16_t slot_count, bt_bb_name_t names[],
+                               uint32_t name_capacity) {
+  bt_status_t result = BT_ERROR;
+  const bool index_ok = ((names == BT_NULL) && (name_capacity == 0U)) ||
+                        ((names != BT_NULL) && (name_capacity > slot_count) &&
+                         ((name_capacity & (name_capacity - 1U)) == 0U));
+
+  if ((bb != BT_NULL) && (slots != BT_NULL) && (slot_count > UINT16_ZERO) && (slot_count < BT_BB_NO_KEY) &&
+      index_ok) {
+    if (names != BT_NULL) {
+      (void)memset(names, 0, (size_t)name_capacity * sizeof(names[0]));
+    } else {
+      /* Keys are used by id only */
+    }
+    bb->slots = slots;
+    bb->capacity = slot_count;
+    bb->count = UINT16_ZERO;
+    bb->names = names;
+    bb->mask = (names != BT_NULL) ? (name_capacity - 1U) : 0U;
+    bb->changed = 0U;
+    bb->subs = BT_NULL;
+    bb->sub_capacity = UINT16_ZERO;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_bb_key_t bt_blackboard_declare(bt_blackboard_t* bb, const char* name, bt_bb_type_t type) {
+  bt_bb_key_t key = BT_BB_NO_KEY;
+  const size_t len = (name != BT_NULL) ? strlen(name) : 0U;
+
+  if ((bb == BT_NULL) || (bb->slots == BT_NULL) || (type < BT_BB_BOOL) || (type > BT_BB_PTR) ||
+      ((name != BT_NULL) && ((bb->names == BT_NULL) || (len == 0U) || (len > 0xFFFFU)))) {
+    key = BT_BB_NO_KEY;
+  } else if (name == BT_NULL) {
+    key = (bb->count < bb->capacity) ? bt_blackboard_add(bb, type) : BT_BB_NO_KEY;
+  } else {
+    const uint32_t hash = bt_registry_hash(name, len);
+    bt_bb_name_t* entry = bt_blackboard_entry(bb, name, len, hash);
+
+    if (entry->name != BT_NULL) {
+      key = (bb->slots[entry->key].type == (uint8_t)type) ? entry->key : BT_BB_NO_KEY; /* Interned */
+    } else if (bb->count < bb->capacity) {
+      key = bt_blackboard_add(bb, type);
+      entry->name = name;
+      entry->hash = hash;
+      entry->len = (uint16_t)len;
+      entry->key = key;
+    } else {
+      key = BT_BB_NO_KEY; /* Full */
+    }
+  }
+
+  return key;
+}
+
+bt_bb_key_t bt_blackboard_find(const bt_blackboard_t* bb, const char* name, size_t len) {
+  bt_bb_key_t key = BT_BB_NO_KEY;
+
+  if ((bb != BT_NULL) && (bb->names != BT_NULL) && (name != BT_NULL)) {
+    const bt_bb_name_t* entry = bt_blackboard_entry(bb, name, len, bt_registry_hash(name, len));
+
+    key = (entry->name != BT_NULL) ? entry->key : BT_BB_NO_KEY;
+  } else {
+    key = BT_BB_NO_KEY;
+  }
+
+  return key;
+}
+
+bt_status_t bt_blackboard_subscribers(bt_blackboard_t* bb, bt_bb_sub_t subs[], uint16_t count) {
+  bt_status_t result = BT_ERROR;
+
+  if ((bb != BT_NULL) && (subs != BT_NULL) && (count > UINT16_ZERO) && (count < 0xFFFFU)) {
+    (void)memset(subs, 0, (size_t)count * sizeof(subs[0]));
+    bb->subs = subs;
+    bb->sub_capacity = count;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_bb_sub_id_t bt_blackboard_subscribe(bt_blackboard_t* bb, bt_keys_t keys, bt_bb_notify_fn fn, void* ctx) {
+  bt_bb_sub_id_t sub = BT_BB_NO_SUB;
+  uint16_t i = UINT16_ZERO;
+
+  if ((bb != BT_NULL) && (bb->subs != BT_NULL) && (keys != 0U) && (fn != BT_NULL)) {
+    for (i = UINT16_ZERO; (i < bb->sub_capacity) && (sub == BT_BB_NO_SUB); i++) {
+      if (bb->subs[i].fn == BT_NULL) {
+        bb->subs[i].keys = keys;
+        bb->subs[i].fn = fn;
+        bb->subs[i].ctx = ctx;
+        sub = ((uint32_t)bb->subs[i].gen << 16U) | (uint32_t)i;
+      } else {
+        /* Taken */
+      }
+    }
+  } else {
+    sub = BT_BB_NO_SUB;
+  }
+
+  return sub;
+}
+
+bt_status_t bt_blackboard_unsubscribe(bt_blackboard_t* bb, bt_bb_sub_id_t sub) {
+  bt_status_t result = BT_ERROR;
+
+  const uint16_t i = BT_BB_SUB_INDEX(sub);
+
+  if ((bb != BT_NULL) && (bb->subs != BT_NULL) && (i < bb->sub_capacity) && (bb->subs[i].fn != BT_NULL) &&
+      (bb->subs[i].gen == BT_BB_SUB_GEN(sub))) {
+    bb->subs[i].fn = BT_NULL;
+    bb->subs[i].keys = 0U;
+    bb->subs[i].ctx = BT_NULL;
+    bb->subs[i].gen++; /* Handles to this subscription go stale */
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_keys_t bt_blackboard_flush(bt_blackboard_t* bb) {
+  const bt_keys_t changed = bt_blackboard_changes(bb);
+  uint16_t i = UINT16_ZERO;
+
+  if ((changed != 0U) && (bb->subs != BT_NULL)) {
+    for (i = UINT16_ZERO; i < bb->sub_capacity; i++) {
+      /* Re-read each entry: a callback may unsubscribe later entries */
+      const bt_keys_t keys = bb->subs[i].keys & changed;
+
+      if ((bb->subs[i].fn != BT_NULL) && (keys != 0U)) {
+        bb->subs[i].fn(bb->subs[i].ctx, keys);
+      } else {
+        /* Free entry or not interested */
+      }
+    }
+  } else {
+    /* Nothing changed or no subscribers */
+  }
+
+  return changed;
+}
+
+void bt_blackboard_wake(void* ctx, bt_keys_t keys) {
+  (void)keys;
+  bt_watch_wake((bt_watch_tree_t*)ctx);
+}
@@ -0,0 +1,453 @@
+/*
+ * bt_codegen.c
+ *
+ * C code generation for fixed trees; see bt_codegen.h. Node functions are
+ * written in post-order so every callee is defined before its caller, and
+ * numbered by their pre-order index (the slot of the node in the bound
+ * array), which is also the bt_assign_ids() order.
+ */
+
+#include "bt_codegen.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#include "bt_internal.h"
+
+/* ===== Internal constants ===== */
+
+#define BT_CODEGEN_MAX_NODES (0xFFFFU) /* Bound array indices are uint16_t */
+
+/* ===== Internal types ===== */
+
+typedef struct {
+  FILE* out;
+  const char* name;                   /* Prefix of generated identifiers */
+  const bt_codegen_symbol_t* symbols; /* Leaf callback names */
+  uint16_t symbol_count;
+  bool ok; /* false after the first write error */
+} bt_codegen_t;
+
+/* ===== Internal helpers ===== */
+
+/* printf to the output, remembering a write error. */
+static void bt_codegen_emit(bt_codegen_t* gen, const char* format, ...) {
+  va_list args;
+
+  if (gen->ok) {
+    va_start(args, format);
+    gen->ok = (vfprintf(gen->out, format, args) >= 0);
+    va_end(args);
+  } else {
+    /* Nothing more after an error */
+  }
+}
+
+/* True when text is a C identifier. */
+static bool bt_codegen_ident(const char* text) {
+  bool ok = (text != BT_NULL) && (text[0] != '\0') && ((text[0] < '0') || (text[0] > '9'));
+  const char* p = text;
+
+  while (ok && (*p != '\0')) {
+    ok = ((*p >= 'a') && (*p <= 'z')) || ((*p >= 'A') && (*p <= 'Z')) || ((*p >= '0') && (*p <= '9')) || (*p == '_');
+    p++;
+  }
+
+  return ok;
+}
+
+/* Symbol of a leaf, or NULL when no entry matches. */
+static const char* bt_codegen_symbol(const bt_codegen_t* gen, const bt_node_t* leaf) {
+  const char* symbol = BT_NULL;
+  uint16_t i;
+
+  for (i = UINT16_ZERO; (symbol == BT_NULL) && (i < gen->symbol_count); i++) {
+    const bt_codegen_symbol_t* entry = &gen->symbols[i];
+
+    if ((entry->tick == leaf->tick) && ((entry->user_data == BT_NULL) || (entry->user_data == leaf->user_data))) {
+      symbol = entry->symbol;
+    } else {
+      /* Keep looking */
+    }
+  }
+
+  return symbol;
+}
+
+/* Number of nodes in a validated subtree, saturating past the limit. */
+static uint32_t bt_codegen_size(const bt_node_t* node) {
+  uint32_t size = 1U;
+  uint16_t i;
+
+  for (i = UINT16_ZERO; (i < node->children_count) && (size <= BT_CODEGEN_MAX_NODES); i++) {
+    size += bt_codegen_size(node->children[i]);
+  }
+
+  return size;
+}
+
+/* True when every leaf of a validated subtree can be generated. */
+static bool bt_codegen_leaves_ok(const bt_codegen_t* gen, const bt_node_t* node) {
+  bool ok = true;
+  uint16_t i;
+
+  if ((node->type == BT_ACTION) || (node->type == BT_CONDITION)) {
+    ok = (bt_codegen_symbol(gen, node) != BT_NULL);
+  } else if (node->type == BT_ASYNC) {
+    ok = false; /* Completions arrive through bt_async_drain(), not a call */
+  } else if ((node->type == BT_REACTIVE_SEQUENCE) || (node->type == BT_REACTIVE_SELECTOR)) {
+    ok = false; /* Guard re-checks and halts are only in bt_tick() */
+  } else {
+    for (i = UINT16_ZERO; ok && (i < node->children_count); i++) {
+      ok = bt_codegen_leaves_ok(gen, node->children[i]);
+    }
+  }
+
+  return ok;
+}
+
+/* Enumerator name of a node type. */
+static const char* bt_codegen_type(bt_node_type_t type) {
+  const char* name = "BT_ACTION";
+
+  switch (type) {
+    case BT_SEQUENCE:
+      name = "BT_SEQUENCE";
+      break;
+    case BT_SELECTOR:
+      name = "BT_SELECTOR";
+      break;
+    case BT_INVERTER:
+      name = "BT_INVERTER";
+      break;
+    case BT_PARALLEL:
+      name = "BT_PARALLEL";
+      break;
+    case BT_CONDITION:
+      name = "BT_CONDITION";
+      break;
+    default:
+      name = "BT_ACTION";
+      break;
+  }
+
+  return name;
+}
+
+/* True when a validated subtree contains a PARALLEL node. */
+static bool bt_codegen_has_parallel(const bt_node_t* node) {
+  bool found = (node->type == BT_PARALLEL);
+  uint16_t i;
+
+  for (i = UINT16_ZERO; (!found) && (i < node->children_count); i++) {
+    found = bt_codegen_has_parallel(node->children[i]);
+  }
+
+  return found;
+}
+
+/* Header, symbol declarations and the PARALLEL helpers. */
+static void bt_codegen_prologue(bt_codegen_t* gen, const bt_node_t* root, uint32_t count) {
+  const char* name = gen->name;
+  uint16_t i;
+  uint16_t j;
+
+  bt_codegen_emit(gen, "/* Generated by bt_codegen_write(): tree \"%s\", %u nodes. Do not edit. */\n\n", name,
+                  (unsigned)count);
+  bt_codegen_emit(gen, "#include \"bt.h\"\n\n#define %s_NODES (%uU)\n\n", name, (unsigned)count);
+
+  for (i = UINT16_ZERO; i < gen->symbol_count; i++) {
+    bool first = true;
+
+    for (j = UINT16_ZERO; first && (j < i); j++) {
+      first = (strcmp(gen->symbols[j].symbol, gen->symbols[i].symbol) != 0);
+    }
+    if (first) {
+      bt_codegen_emit(gen, "bt_status_t %s(bt_node_t* node);\n", gen->symbols[i].symbol);
+    } else {
+      /* Declared already */
+    }
+  }
+
+  bt_codegen_emit(gen,
+                  "\nbt_status_t %s_bind(bt_node_t* root, bt_node_t* n[%s_NODES]);\n"
+                  "bt_status_t %s_tick(bt_node_t* const n[%s_NODES]);\n\n",
+                  name, name, name, name);
+
+  bt_codegen_emit(gen,
+                  "static inline bool %s_shape(const bt_node_t* node, bt_node_type_t type, uint16_t children, "
+                  "bool on_enter,\n"
+                  "%*sbool on_exit) {\n"
+                  "  return (node != BT_NULL) && (node->type == type) && (node->children_count == children) &&\n"
+                  "         ((children == 0U) || (node->children != BT_NULL)) && "
+                  "((node->on_enter != BT_NULL) == on_enter) &&\n"
+                  "         ((node->on_exit != BT_NULL) == on_exit);\n"
+                  "}\n\n",
+                  name, (int)(strlen(name) + sizeof("static inline bool _shape(") - 1U), "");
+
+  if (bt_codegen_has_parallel(root)) {
+    bt_codegen_emit(gen,
+                    "static inline uint16_t %s_popcount(uint32_t mask) {\n"
+                    "  uint32_t rest = mask;\n"
+                    "  uint16_t count = 0U;\n\n"
+                    "  while (rest != 0U) {\n"
+                    "    rest &= rest - 1U;\n"
+                    "    count++;\n"
+                    "  }\n\n"
+                    "  return count;\n"
+                    "}\n\n",
+                    name);
+    bt_codegen_emit(gen,
+                    "static inline bt_status_t %s_decide(uint16_t children, uint16_t success_threshold, "
+                    "uint16_t failure_threshold,\n"
+                    "%*suint32_t done, uint32_t success) {\n"
+                    "  const uint16_t succeeded = %s_popcount(success);\n"
+                    "  const uint16_t failed = %s_popcount(done & ~success);\n"
+                    "  bt_status_t s = BT_RUNNING;\n\n"
+                    "  if (succeeded >= success_threshold) {\n"
+                    "    s = BT_SUCCESS;\n"
+                    "  } else if ((failed >= failure_threshold) || ((uint16_t)(children - failed) < "
+                    "success_threshold)) {\n"
+                    "    s = BT_FAILURE;\n"
+                    "  } else {\n"
+                    "    s = BT_RUNNING;\n"
+                    "  }\n\n"
+                    "  return s;\n"
+                    "}\n\n",
+                    name, (int)(strlen(name) + sizeof("static inline bt_status_t _decide(") - 1U), "", name, name);
+  } else {
+    /* No PARALLEL: no bitset helpers */
+  }
+}
+
+/* Entry block of a composite: reset its state and call on_enter. */
+static void bt_codegen_enter(bt_codegen_t* gen, const bt_node_t* node) {
+  const bool parallel = (node->type == BT_PARALLEL);
+  const bool reset = (node->type == BT_SEQUENCE) || (node->type == BT_SELECTOR);
+
+  if (parallel || reset || (node->on_enter != BT_NULL)) {
+    bt_codegen_emit(gen, "  if (node->status != BT_RUNNING) {\n");
+    if (parallel) {
+      bt_codegen_emit(gen, "    par->done_mask = 0U;\n    par->success_mask = 0U;\n");
+    } else if (reset) {
+      bt_codegen_emit(gen, "    node->current_child = 0U;\n");
+    } else {
+      /* INVERTER keeps no state */
+    }
+    if (node->on_enter != BT_NULL) {
+      bt_codegen_emit(gen, "    node->on_enter(node);\n");
+    } else {
+      /* No hook */
+    }
+    bt_codegen_emit(gen, "  }\n");
+  } else {
+    /* Nothing to do on entry */
+  }
+}
+
+/* Exit block of a composite: store the status and call on_exit. */
+static void bt_codegen_exit(bt_codegen_t* gen, const bt_node_t* node) {
+  bt_codegen_emit(gen, "  node->status = s;\n");
+  if (node->on_exit != BT_NULL) {
+    bt_codegen_emit(gen, "  if (s != BT_RUNNING) {\n    node->on_exit(node);\n  }\n");
+  } else {
+    /* No hook */
+  }
+  bt_codegen_emit(gen, "  return s;\n}\n\n");
+}
+
+/* Function body of a SEQUENCE or SELECTOR.
+ * Child k runs while the composite still holds its "keep going" status and
+ * the resume point is at or before k, so resuming skips straight to
+ * current_child and stopping skips every later child.
+ */
+static void bt_codegen_chain(bt_codegen_t* gen, const bt_node_t* node, uint32_t index) {
+  const char* keep = (node->type == BT_SEQUENCE) ? "BT_SUCCESS" : "BT_FAILURE";
+  uint32_t child = index + 1U;
+  uint16_t k;
+
+  bt_codegen_emit(gen, "  bt_status_t s = %s;\n", keep);
+  if (node->children_count > UINT16_ZERO) {
+    bt_codegen_emit(gen, "  uint16_t i;\n\n");
+    bt_codegen_enter(gen, node);
+    bt_codegen_emit(gen, "  i = node->current_child;\n");
+    for (k = UINT16_ZERO; k < node->children_count; k++) {
+      bt_codegen_emit(gen, "  if ((s == %s) && (i %s %uU)) {\n    s = %s_node_%u(n);\n    i = %uU;\n  }\n", keep,
+                      (k == UINT16_ZERO) ? "==" : "<=", (unsigned)k, gen->name, (unsigned)child, (unsigned)k);
+      child += bt_codegen_size(node->children[k]);
+    }
+    bt_codegen_emit(gen, "  node->current_child = (s == %s) ? %uU : i;\n", keep, (unsigned)node->children_count);
+  } else {
+    bt_codegen_emit(gen, "\n");
+    bt_codegen_enter(gen, node);
+  }
+  bt_codegen_exit(gen, node);
+}
+
+/* Function body of a PARALLEL: every unfinished child in order, deciding
+ * after each one as bt_tick() does, then halting the unfinished ones once it
+ * settles. */
+static void bt_codegen_parallel(bt_codegen_t* gen, const bt_node_t* node, uint32_t index) {
+  uint32_t child = index + 1U;
+  uint16_t k;
+
+  bt_codegen_emit(gen, "  bt_parallel_t* const par = (bt_parallel_t*)node->ext;\n  bt_status_t s = BT_RUNNING;\n\n");
+  bt_codegen_enter(gen, node);
+  for (k = UINT16_ZERO; k < node->children_count; k++) {
+    const unsigned long bit = 1UL << k;
+
+    bt_codegen_emit(gen,
+                    "  if ((s == BT_RUNNING) && ((par->done_mask & 0x%lXU) == 0U)) {\n"
+                    "    const bt_status_t cs = %s_node_%u(n);\n\n"
+                    "    if (cs == BT_SUCCESS) {\n"
+                    "      par->done_mask |= 0x%lXU;\n"
+                    "      par->success_mask |= 0x%lXU;\n"
+                    "    } else if (cs == BT_FAILURE) {\n"
+                    "      par->done_mask |= 0x%lXU;\n"
+                    "    } else {\n"
+                    "      /* RUNNING: tick again next time; ERROR is handled below */\n"
+                    "    }\n"
+                    "    s = (cs == BT_ERROR) ? BT_ERROR\n"
+                    "                         : %s_decide(%uU, %uU, %uU, par->done_mask, par->success_mask);\n"
+                    "  }\n",
+                    bit, gen->name, (unsigned)child, bit, bit, bit, gen->name, (unsigned)node->children_count,
+                    (unsigned)bt_parallel_of(node)->success_threshold,
+                    (unsigned)bt_parallel_of(node)->failure_threshold);
+    child += bt_codegen_size(node->children[k]);
+  }
+
+  /* Unfinished children are halted when the parallel settles, as in bt_tick() */
+  bt_codegen_emit(gen, "  if (s != BT_RUNNING) {\n");
+  child = index + 1U;
+  for (k = UINT16_ZERO; k < node->children_count; k++) {
+    bt_codegen_emit(gen, "    if ((par->done_mask & 0x%lXU) == 0U) {\n      (void)bt_halt(n[%u]);\n    }\n", 1UL << k,
+                    (unsigned)child);
+    child += bt_codegen_size(node->children[k]);
+  }
+  bt_codegen_emit(gen, "  }\n");
+  bt_codegen_exit(gen, node);
+}
+
+/* Function bodies of a subtree, children first.
+ * Returns:
+ *   - the pre-order index following the subtree
+ */
+static uint32_t bt_codegen_node(bt_codegen_t* gen, const bt_node_t* node, uint32_t index) {
+  uint32_t next = index + 1U;
+  uint16_t k;
+
+  for (k = UINT16_ZERO; k < node->children_count; k++) {
+    next = bt_codegen_node(gen, node->children[k], next);
+  }
+
+  bt_codegen_emit(gen, "/* %u: %s */\nstatic inline bt_status_t %s_node_%u(bt_node_t* const n[]) {\n", (unsigned)index,
+                  bt_codegen_type(node->type), gen->name, (unsigned)index);
+  bt_codegen_emit(gen, "  bt_node_t* const node = n[%u];\n", (unsigned)index);
+
+  if ((node->type == BT_SEQUENCE) || (node->type == BT_SELECTOR)) {
+    bt_codegen_chain(gen, node, index);
+  } else if (node->type == BT_PARALLEL) {
+    bt_codegen_parallel(gen, node, index);
+  } else if (node->type == BT_INVERTER) {
+    bt_codegen_emit(gen, "  bt_status_t s = BT_ERROR;\n\n");
+    bt_codegen_enter(gen, node);
+    bt_codegen_emit(gen,
+                    "  s = %s_node_%u(n);\n"
+                    "  s = (s == BT_SUCCESS) ? BT_FAILURE : ((s == BT_FAILURE) ? BT_SUCCESS : s);\n",
+                    gen->name, (unsigned)(index + 1U));
+    bt_codegen_exit(gen, node);
+  } else {
+    /* Leaf: a direct call, no hooks (as in bt_tick()) */
+    bt_codegen_emit(gen, "  const bt_status_t s = %s(node);\n\n  node->status = s;\n  return s;\n}\n\n",
+                    bt_codegen_symbol(gen, node));
+  }
+
+  return next;
+}
+
+/* Check statement for the node bound at n[index]. */
+static void bt_codegen_check(bt_codegen_t* gen, const bt_node_t* node, uint32_t index) {
+  bt_codegen_emit(gen, "    ok = %s_shape(n[%u], %s, %uU, %s, %s)", gen->name, (unsigned)index,
+                  bt_codegen_type(node->type), (unsigned)node->children_count,
+                  (node->on_enter != BT_NULL) ? "true" : "false", (node->on_exit != BT_NULL) ? "true" : "false");
+  if (node->type == BT_PARALLEL) {
+    bt_codegen_emit(gen,
+                    " && (n[%u]->ext != BT_NULL) &&\n"
+                    "         (((const bt_parallel_t*)n[%u]->ext)->success_threshold == %uU) &&\n"
+                    "         (((const bt_parallel_t*)n[%u]->ext)->failure_threshold == %uU)",
+                    (unsigned)index, (unsigned)index, (unsigned)bt_parallel_of(node)->success_threshold,
+                    (unsigned)index, (unsigned)bt_parallel_of(node)->failure_threshold);
+  } else if ((node->type == BT_ACTION) || (node->type == BT_CONDITION)) {
+    bt_codegen_emit(gen, " && (n[%u]->tick == %s)", (unsigned)index, bt_codegen_symbol(gen, node));
+  } else {
+    /* Shape only */
+  }
+  bt_codegen_emit(gen, ";\n  }\n");
+}
+
+/* Binding statements for the children of a subtree, in pre-order.
+ * Returns:
+ *   - the pre-order index following the subtree
+ */
+static uint32_t bt_codegen_bind(bt_codegen_t* gen, const bt_node_t* node, uint32_t index) {
+  uint32_t next = index + 1U;
+  uint16_t k;
+
+  for (k = UINT16_ZERO; k < node->children_count; k++) {
+    bt_codegen_emit(gen, "  if (ok) {\n    n[%u] = n[%u]->children[%u];\n", (unsigned)next, (unsigned)index,
+                    (unsigned)k);
+    bt_codegen_check(gen, node->children[k], next);
+    next = bt_codegen_bind(gen, node->children[k], next);
+  }
+
+  return next;
+}
+
+/* ===== Public API ===== */
+
+bt_status_t bt_codegen_write(FILE* out, const char* name, bt_node_t* root, const bt_codegen_symbol_t symbols[],
+                             uint16_t symbol_count) {
+  bt_status_t result = BT_ERROR;
+  bt_codegen_t gen;
+  uint32_t count = 0U;
+  uint16_t i;
+  bool ok = (out != BT_NULL) && bt_codegen_ident(name) && ((symbols != BT_NULL) || (symbol_count == UINT16_ZERO)) &&
+            (bt_validate(root) == BT_SUCCESS);
+
+  for (i = UINT16_ZERO; ok && (i < symbol_count); i++) {
+    ok = (symbols[i].tick != BT_NULL) && bt_codegen_ident(symbols[i].symbol);
+  }
+
+  if (ok) {
+    gen.out = out;
+    gen.name = name;
+    gen.symbols = symbols;
+    gen.symbol_count = symbol_count;
+    gen.ok = true;
+    count = bt_codegen_size(root);
+    ok = (count <= BT_CODEGEN_MAX_NODES) && bt_codegen_leaves_ok(&gen, root);
+  }
+
+  if (ok) {
+    bt_codegen_prologue(&gen, root, count);
+    (void)bt_codegen_node(&gen, root, 0U);
+
+    bt_codegen_emit(&gen,
+                    "bt_status_t %s_bind(bt_node_t* root, bt_node_t* n[%s_NODES]) {\n"
+                    "  bool ok = (n != BT_NULL);\n\n"
+                    "  if (ok) {\n"
+                    "    n[0] = root;\n",
+                    name, name);
+    bt_codegen_check(&gen, root, 0U);
+    (void)bt_codegen_bind(&gen, root, 0U);
+    bt_codegen_emit(&gen, "\n  return ok ? BT_SUCCESS : BT_ERROR;\n}\n\n");
+
+    bt_codegen_emit(&gen, "bt_status_t %s_tick(bt_node_t* const n[%s_NODES]) { return %s_node_0(n); }\n", name, name,
+                    name);
+    ok = gen.ok && (fflush(out) == 0);
+  }
+
+  result = ok ? BT_SUCCESS : BT_ERROR;
+
+  return result;
+}
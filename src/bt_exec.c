@@ -0,0 +1,606 @@
+/*
+ * bt_exec.c
+ *
+ * Iterative tick engine. The recursive dispatcher in bt.c is unrolled into a
+ * loop with two phases:
+ *   - descend: the node on top of the frame stack is entered and either
+ *     settles immediately (leaves, empty composites, errors) or pushes the
+ *     child it resumes at;
+ *   - deliver: a settled child's status is handed to the node below it, which
+ *     either pushes its next child or settles in turn.
+ * Hook timing and status bookkeeping follow bt_tick_sequence(),
+ * bt_tick_selector(), bt_tick_inverter(), bt_tick_parallel() and
+ * bt_tick_reactive() exactly.
+ */
+
+#include "bt_exec.h"
+
+#include "bt_internal.h"
+
+/* ===== Internal helpers ===== */
+
+/* Defensive child fetch (returns NULL if out-of-range or array is NULL) */
+static bt_node_t* bt_exec_child_at(const bt_node_t* node, uint16_t index) {
+  bt_node_t* child = BT_NULL;
+
+  if ((node->children != BT_NULL) && (index < node->children_count)) {
+    child = node->children[index];
+  } else {
+    /* Keep child as NULL */
+  }
+
+  return child;
+}
+
+/* Store a node's status and fire on_exit on terminal states. */
+static void bt_exec_settle(bt_node_t* node, bt_status_t result) {
+  bt_set_status(node, result);
+
+  if (bt_is_terminal(result)) {
+    bt_call_exit(node);
+  } else {
+    /* Still running */
+  }
+}
+
+/* Push a child frame.
+ * Returns:
+ *   - true when the child was pushed, false when the frame stack is full
+ */
+static bool bt_exec_push(bt_exec_t* exec, bt_node_t* child) {
+  bool pushed = false;
+
+  if (exec->depth < exec->capacity) {
+    exec->frames[exec->depth] = child;
+    exec->depth++;
+    exec->path_len = UINT16_ZERO; /* Frames above depth are being reused */
+    pushed = true;
+  } else {
+    /* Too deep: caller reports BT_ERROR */
+  }
+
+  return pushed;
+}
+
+/* Push current_child of a SEQUENCE/SELECTOR (or reactive) node, or settle it
+ * with keep_going when no child is left.
+ * Returns:
+ *   - same convention as bt_exec_descend()
+ */
+static bt_status_t bt_exec_push_current(bt_exec_t* exec, bt_node_t* node, bt_status_t keep_going,
+                                        bt_status_t* result) {
+  bt_status_t step = BT_SUCCESS;
+
+  if (node->current_child >= node->children_count) {
+    *result = keep_going;
+    bt_exec_settle(node, keep_going);
+  } else {
+    bt_node_t* child = bt_exec_child_at(node, node->current_child);
+
+    if (child == BT_NULL) {
+      *result = BT_ERROR;
+      bt_exec_settle(node, BT_ERROR);
+    } else if (bt_exec_push(exec, child)) {
+      step = BT_RUNNING;
+    } else {
+      *result = BT_ERROR;
+      step = BT_FAILURE;
+    }
+  }
+
+  return step;
+}
+
+/* Push the first unfinished child of a PARALLEL node at or after index from.
+ * Returns:
+ *   - same convention as bt_exec_descend(); when no child is left the node
+ *     settles RUNNING
+ */
+static bt_status_t bt_exec_parallel_next(bt_exec_t* exec, bt_node_t* node, uint16_t from, bt_status_t* result) {
+  bt_status_t step = BT_SUCCESS;
+  const uint32_t done = bt_parallel_of(node)->done_mask;
+  uint16_t i = from;
+
+  while ((i < node->children_count) && ((done & ((uint32_t)1U << i)) != 0U)) {
+    i++;
+  }
+
+  if (i >= node->children_count) {
+    *result = BT_RUNNING;
+    bt_set_status(node, BT_RUNNING);
+  } else {
+    bt_node_t* child = bt_exec_child_at(node, i);
+
+    node->current_child = i;
+    if (child == BT_NULL) {
+      *result = BT_ERROR;
+      bt_exec_settle(node, BT_ERROR);
+    } else if (bt_exec_push(exec, child)) {
+      step = BT_RUNNING;
+    } else {
+      *result = BT_ERROR;
+      step = BT_FAILURE;
+    }
+  }
+
+  return step;
+}
+
+/* Park a node in the bound wheel if its anchor is in the future.
+ * Returns:
+ *   - true when the node sleeps and must not be ticked now
+ */
+static bool bt_exec_sleep(const bt_exec_t* exec, bt_node_t* node) {
+  return (exec->timers != BT_NULL) && (node->time_anchor_ms != 0U) && bt_timer_park(exec->timers, node);
+}
+
+/* Re-tick a guard (CONDITION child) of a resumed reactive composite in place.
+ * Returns:
+ *   - the guard's status; like any leaf, a guard parked on its time anchor
+ *     reports RUNNING without being ticked
+ */
+static bt_status_t bt_exec_guard(bt_exec_t* exec, bt_node_t* guard) {
+  bt_status_t result = BT_ERROR;
+
+  if (bt_exec_sleep(exec, guard)) {
+    result = BT_RUNNING;
+  } else if (guard->tick == BT_NULL) {
+    result = BT_ERROR;
+  } else {
+    result = guard->tick(guard);
+    exec->polling = exec->polling || (result == BT_RUNNING);
+  }
+  bt_set_status(guard, result);
+
+  return result;
+}
+
+/* Enter or resume a reactive SEQUENCE/SELECTOR, as bt_tick_reactive() does.
+ * Behavior:
+ *   - Entered: starts at child 0 like SEQUENCE/SELECTOR.
+ *   - Resumed: re-ticks the guards (CONDITION children) before current_child
+ *     in place, without a frame of their own. The first one that does not
+ *     give keep_going halts the running child, becomes current_child and
+ *     decides the tick; when all hold, the running child is pushed again.
+ * Returns:
+ *   - same convention as bt_exec_dispatch()
+ */
+static bt_status_t bt_exec_reactive(bt_exec_t* exec, bt_node_t* node, bt_status_t* result) {
+  const bt_status_t keep_going = (node->type == BT_REACTIVE_SEQUENCE) ? BT_SUCCESS : BT_FAILURE;
+  bt_status_t guard = keep_going;
+  bt_status_t step = BT_SUCCESS;
+  uint16_t i = UINT16_ZERO;
+
+  if (node->status != BT_RUNNING) {
+    node->current_child = UINT16_ZERO;
+    bt_call_enter(node);
+  } else {
+    for (i = UINT16_ZERO; (i < node->current_child) && (guard == keep_going); i++) {
+      bt_node_t* child = bt_exec_child_at(node, i);
+
+      if ((child != BT_NULL) && (child->type == BT_CONDITION)) {
+        guard = bt_exec_guard(exec, child);
+        if (guard != keep_going) {
+          (void)bt_halt_in(bt_exec_child_at(node, node->current_child), exec->timers);
+          node->current_child = i;
+        } else {
+          /* Guard still holds */
+        }
+      } else {
+        /* Not a guard: finished for this run */
+      }
+    }
+  }
+
+  if (guard != keep_going) {
+    *result = guard;
+    bt_exec_settle(node, guard);
+  } else {
+    step = bt_exec_push_current(exec, node, keep_going, result);
+  }
+
+  return step;
+}
+
+/* Dispatch the node on top of the stack by type.
+ * Parameters:
+ *   - exec: engine context
+ *   - node: node on top of the frame stack
+ *   - result: receives the node's status when it settles during entry
+ * Returns:
+ *   - BT_RUNNING when a child was pushed (keep descending)
+ *   - BT_SUCCESS when the node settled with *result
+ *   - BT_FAILURE when a child could not be pushed; *result is the child's BT_ERROR
+ */
+static bt_status_t bt_exec_dispatch(bt_exec_t* exec, bt_node_t* node, bt_status_t* result) {
+  bt_status_t step = BT_SUCCESS;
+
+  switch (node->type) {
+    case BT_ACTION:
+    case BT_CONDITION:
+    case BT_ASYNC: {
+      if (node->tick == BT_NULL) {
+        *result = BT_ERROR;
+        bt_set_status(node, BT_ERROR);
+      } else {
+        *result = (node->type == BT_ASYNC) ? bt_async_step(node) : node->tick(node);
+        bt_set_status(node, *result);
+
+        if (*result == BT_RUNNING) {
+          exec->path_len = exec->depth; /* Remember the path down to this leaf */
+
+          if (!bt_async_pending(node) && !bt_exec_sleep(exec, node)) {
+            exec->polling = true; /* Must be ticked again to make progress */
+          }
+        }
+      }
+      break;
+    }
+
+    case BT_SEQUENCE:
+    case BT_SELECTOR: {
+      if (node->status != BT_RUNNING) {
+        node->current_child = UINT16_ZERO;
+        bt_call_enter(node);
+      }
+      step = bt_exec_push_current(exec, node, (node->type == BT_SEQUENCE) ? BT_SUCCESS : BT_FAILURE, result);
+      break;
+    }
+
+    case BT_REACTIVE_SEQUENCE:
+    case BT_REACTIVE_SELECTOR: {
+      step = bt_exec_reactive(exec, node, result);
+      break;
+    }
+
+    case BT_INVERTER: {
+      if (node->children_count != UINT16_ONE) {
+        *result = BT_ERROR; /* Status left untouched, as in bt_tick_inverter() */
+      } else {
+        bt_node_t* child = bt_exec_child_at(node, UINT16_ZERO);
+
+        if (node->status != BT_RUNNING) {
+          bt_call_enter(node);
+        }
+
+        if (child == BT_NULL) {
+          *result = BT_ERROR;
+        } else if (bt_exec_push(exec, child)) {
+          step = BT_RUNNING;
+        } else {
+          *result = BT_ERROR;
+          step = BT_FAILURE;
+        }
+      }
+      break;
+    }
+
+    case BT_PARALLEL: {
+      if (!bt_parallel_ok(node)) {
+        *result = BT_ERROR;
+        bt_set_status(node, BT_ERROR);
+      } else {
+        if (node->status != BT_RUNNING) {
+          bt_parallel_t* const par = bt_parallel_of(node);
+
+          par->done_mask = 0U;
+          par->success_mask = 0U;
+          bt_call_enter(node);
+        }
+        step = bt_exec_parallel_next(exec, node, UINT16_ZERO, result);
+      }
+      break;
+    }
+
+    default: {
+      *result = BT_ERROR;
+      bt_set_status(node, BT_ERROR);
+      break;
+    }
+  }
+
+  return step;
+}
+
+/* Enter the node on top of the stack, unless its time anchor parks it.
+ * Returns:
+ *   - same convention as bt_exec_dispatch(); a parked node settles RUNNING
+ */
+static bt_status_t bt_exec_descend(bt_exec_t* exec, bt_node_t* node, bt_status_t* result) {
+  bt_status_t step = BT_SUCCESS;
+
+  if (bt_exec_sleep(exec, node)) {
+    *result = BT_RUNNING;
+
+    if ((node->type == BT_ACTION) || (node->type == BT_CONDITION)) {
+      bt_set_status(node, BT_RUNNING);
+      exec->path_len = exec->depth; /* Resume (or skip) right here next time */
+    } else {
+      /* A parked composite (or ASYNC leaf, whose RUNNING status means its
+       * operation started) is entered once its anchor expires */
+    }
+  } else {
+    step = bt_exec_dispatch(exec, node, result);
+  }
+
+  return step;
+}
+
+/* Hand a settled child's status to a SEQUENCE or SELECTOR parent.
+ * Parameters:
+ *   - exec: engine context
+ *   - node: composite parent (top of the frame stack)
+ *   - result: in: child status, out: parent status when the parent settles
+ *   - keep_going: status that advances to the next child
+ * Returns:
+ *   - same convention as bt_exec_descend()
+ */
+static bt_status_t bt_exec_deliver_composite(bt_exec_t* exec, bt_node_t* node, bt_status_t* result,
+                                             bt_status_t keep_going) {
+  bt_status_t step = BT_SUCCESS;
+  const bt_status_t cs = *result;
+
+  if (cs == BT_RUNNING) {
+    bt_set_status(node, BT_RUNNING); /* Stay on this child */
+  } else if ((cs == BT_ERROR) || ((cs != keep_going) && ((cs == BT_SUCCESS) || (cs == BT_FAILURE)))) {
+    bt_exec_settle(node, cs);
+  } else {
+    node->current_child = (uint16_t)(node->current_child + UINT16_ONE);
+    step = bt_exec_push_current(exec, node, keep_going, result);
+  }
+
+  return step;
+}
+
+/* Hand a settled child's status to a PARALLEL parent.
+ * Returns:
+ *   - same convention as bt_exec_descend()
+ */
+static bt_status_t bt_exec_deliver_parallel(bt_exec_t* exec, bt_node_t* node, bt_status_t* result) {
+  bt_status_t step = BT_SUCCESS;
+  bt_parallel_t* const par = bt_parallel_of(node);
+  const uint32_t bit = (uint32_t)1U << node->current_child;
+  const bt_status_t cs = *result;
+  bt_status_t decided = BT_ERROR;
+
+  if (cs == BT_SUCCESS) {
+    par->done_mask |= bit;
+    par->success_mask |= bit;
+  } else if (cs == BT_FAILURE) {
+    par->done_mask |= bit;
+  } else {
+    /* RUNNING: tick again next time; ERROR is handled below */
+  }
+
+  /* Siblings are ticked too, so a leaf below a PARALLEL is never resumed directly */
+  exec->path_len = UINT16_ZERO;
+
+  decided = (cs == BT_ERROR) ? BT_ERROR : bt_parallel_decide(node, par->done_mask, par->success_mask);
+  if (decided != BT_RUNNING) {
+    *result = decided;
+    bt_set_status(node, decided);
+    bt_parallel_halt_rest(node, exec->timers); /* Unfinished children, before on_exit */
+    bt_call_exit(node);
+  } else {
+    step = bt_exec_parallel_next(exec, node, (uint16_t)(node->current_child + UINT16_ONE), result);
+  }
+
+  return step;
+}
+
+/* Hand a settled child's status to the node on top of the stack. */
+static bt_status_t bt_exec_deliver(bt_exec_t* exec, bt_node_t* node, bt_status_t* result) {
+  bt_status_t step = BT_SUCCESS;
+
+  switch (node->type) {
+    case BT_SEQUENCE: {
+      step = bt_exec_deliver_composite(exec, node, result, BT_SUCCESS);
+      break;
+    }
+
+    case BT_SELECTOR: {
+      step = bt_exec_deliver_composite(exec, node, result, BT_FAILURE);
+      break;
+    }
+
+    case BT_PARALLEL: {
+      step = bt_exec_deliver_parallel(exec, node, result);
+      break;
+    }
+
+    case BT_REACTIVE_SEQUENCE:
+    case BT_REACTIVE_SELECTOR: {
+      /* Guards are re-checked on every tick, so a leaf below is never resumed directly */
+      exec->path_len = UINT16_ZERO;
+      step = bt_exec_deliver_composite(exec, node, result,
+                                       (node->type == BT_REACTIVE_SEQUENCE) ? BT_SUCCESS : BT_FAILURE);
+      break;
+    }
+
+    default: {
+      /* BT_INVERTER: RUNNING and ERROR propagate unchanged */
+      if (*result == BT_SUCCESS) {
+        *result = BT_FAILURE;
+      } else if (*result == BT_FAILURE) {
+        *result = BT_SUCCESS;
+      } else {
+        /* Propagate */
+      }
+      bt_exec_settle(node, *result);
+      break;
+    }
+  }
+
+  return step;
+}
+
+/* ===== Public API ===== */
+
+bt_status_t bt_exec_init(bt_exec_t* exec, bt_node_t* frames[], uint16_t capacity) {
+  bt_status_t result = BT_ERROR;
+
+  if ((exec != BT_NULL) && (frames != BT_NULL) && (capacity > UINT16_ZERO)) {
+    exec->frames = frames;
+    exec->capacity = capacity;
+    exec->depth = UINT16_ZERO;
+    exec->path_len = UINT16_ZERO;
+    exec->timers = BT_NULL;
+    exec->async = BT_NULL;
+    exec->polling = false;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Check whether the cached path can be resumed for this root.
+ * Every ancestor of a RUNNING leaf on the path is RUNNING with current_child
+ * pointing down the path, so re-descending from the root would reach the same
+ * leaf without firing any hook; only the two ends are checked.
+ */
+static bool bt_exec_can_resume(const bt_exec_t* exec, const bt_node_t* root) {
+  bool ok = false;
+
+  if ((exec->path_len > UINT16_ZERO) && (exec->frames[0] == root) && (root->status == BT_RUNNING)) {
+    ok = (exec->frames[exec->path_len - UINT16_ONE]->status == BT_RUNNING);
+  } else {
+    /* No usable path */
+  }
+
+  return ok;
+}
+
+/* Tick from the given root using the engine's frame stack.
+ * Behavior:
+ *   - Equivalent to bt_tick(root), including on_enter/on_exit timing.
+ *   - Uses at most one frame per tree level; see bt_exec_t for overflow handling.
+ *   - Resumes directly at the cached RUNNING leaf when there is one. While
+ *     it stays RUNNING the tick ends there: its ancestors are already
+ *     RUNNING with current_child on the path, so a steady-state tick costs
+ *     O(1) instead of O(depth). They are walked only once its status changes.
+ *   - Returns RUNNING at once while that leaf is parked in the timer wheel
+ *     or waits for its async completion.
+ */
+bt_status_t bt_tick_exec(bt_exec_t* exec, bt_node_t* root) {
+  bt_status_t result = BT_ERROR;
+
+  if ((exec == BT_NULL) || (exec->frames == BT_NULL) || (root == BT_NULL)) {
+    result = BT_ERROR;
+  } else {
+    bool descending = true;
+    bool resumed = false;
+
+    exec->polling = false;
+    if (exec->async != BT_NULL) {
+      (void)bt_async_drain(exec->async);
+    } else {
+      /* Completions are delivered by the host, if any */
+    }
+
+    if (bt_exec_can_resume(exec, root)) {
+      const bt_node_t* leaf = exec->frames[exec->path_len - UINT16_ONE];
+
+      exec->depth = exec->path_len;
+
+      if (((exec->timers != BT_NULL) && bt_timer_is_parked(leaf)) || bt_async_pending(leaf)) {
+        exec->depth = UINT16_ZERO; /* Sleeping: nothing on the path can change */
+        result = BT_RUNNING;
+      } else {
+        resumed = true;
+      }
+    } else {
+      exec->depth = UINT16_ZERO;
+      (void)bt_exec_push(exec, root);
+    }
+
+    while (exec->depth > UINT16_ZERO) {
+      bt_node_t* node = exec->frames[exec->depth - UINT16_ONE];
+      const bt_status_t step =
+          descending ? bt_exec_descend(exec, node, &result) : bt_exec_deliver(exec, node, &result);
+
+      if (step == BT_RUNNING) {
+        descending = true; /* A child was pushed */
+      } else if (step == BT_FAILURE) {
+        descending = false; /* Child did not fit: deliver its BT_ERROR to node */
+      } else if (resumed && (result == BT_RUNNING)) {
+        exec->depth = UINT16_ZERO; /* Cached leaf still RUNNING: nothing above it changes */
+      } else {
+        exec->depth--; /* node settled: deliver to its parent */
+        descending = false;
+      }
+      resumed = false;
+    }
+
+    if (result != BT_RUNNING) {
+      exec->path_len = UINT16_ZERO;
+    }
+  }
+
+  return result;
+}
+
+/* Tick, then classify what the tree waits for.
+ * Behavior:
+ *   - RUNNING with a polling leaf, or a terminal root status: BT_WAKE_POLL.
+ *   - RUNNING with every running leaf parked: BT_WAKE_TIMER at the wheel's
+ *     earliest anchor, or BT_WAKE_IDLE when the wheel is empty.
+ */
+bt_status_t bt_tick_exec_next(bt_exec_t* exec, bt_node_t* root, bt_wake_t* wake) {
+  const bt_status_t result = bt_tick_exec(exec, root);
+
+  if (wake != BT_NULL) {
+    wake->kind = BT_WAKE_POLL;
+    wake->deadline_ms = ((exec != BT_NULL) && (exec->timers != BT_NULL)) ? exec->timers->now : 0U;
+
+    if ((result == BT_RUNNING) && !exec->polling) {
+      wake->kind = bt_timer_next_deadline(exec->timers, &wake->deadline_ms) ? BT_WAKE_TIMER : BT_WAKE_IDLE;
+    } else {
+      /* Tick again on the host's period */
+    }
+  } else {
+    /* Status only */
+  }
+
+  return result;
+}
+
+void bt_exec_set_timers(bt_exec_t* exec, bt_timer_wheel_t* wheel) {
+  if (exec != BT_NULL) {
+    exec->timers = wheel;
+  } else {
+    /* No action */
+  }
+}
+
+void bt_exec_set_async(bt_exec_t* exec, bt_async_queue_t* queue) {
+  if (exec != BT_NULL) {
+    exec->async = queue;
+  } else {
+    /* No action */
+  }
+}
+
+uint16_t bt_exec_halt(bt_exec_t* exec, bt_node_t* node) {
+  uint16_t halted = UINT16_ZERO;
+
+  if (exec != BT_NULL) {
+    halted = bt_halt_in(node, exec->timers);
+    exec->depth = UINT16_ZERO;
+    exec->path_len = UINT16_ZERO; /* The cached leaf may have been halted */
+  } else {
+    /* No action */
+  }
+
+  return halted;
+}
+
+void bt_exec_reset(bt_exec_t* exec) {
+  if (exec != BT_NULL) {
+    exec->depth = UINT16_ZERO;
+    exec->path_len = UINT16_ZERO;
+  } else {
+    /* No action */
+  }
+}
@@ -0,0 +1,304 @@
+/*
+ * bt_executor.c
+ *
+ * Work-stealing executor. Each round:
+ *   1. bt_executor_tick_all() hands every worker a contiguous range of chunk
+ *      indices and wakes the pool;
+ *   2. workers pop chunks from the bottom of their own deque and tick them
+ *      with bt_tick_batch();
+ *   3. a worker whose deque is empty steals from the top of the others until
+ *      every deque is empty, then reports completion.
+ * The deques follow the Chase-Lev protocol without the push side, since no
+ * chunk is added while a round is in progress.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bt_executor.h"
+
+#include <time.h>
+
+#include "bt_internal.h"
+
+/* ===== Internal helpers ===== */
+
+/* Monotonic time in nanoseconds */
+static uint64_t bt_executor_now_ns(void) {
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* Owner side: take the chunk at the bottom of the worker's own deque.
+ * Returns:
+ *   - chunk index, or -1 when the deque is empty
+ */
+static int bt_deque_pop(bt_worker_t* w) {
+  int chunk = -1;
+  const int b = atomic_load_explicit(&w->bottom, memory_order_relaxed) - 1;
+  int t;
+
+  atomic_store_explicit(&w->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  t = atomic_load_explicit(&w->top, memory_order_relaxed);
+
+  if (t < b) {
+    chunk = b; /* More than one left: no race with thieves */
+  } else if (t == b) {
+    /* Last chunk: race thieves for it */
+    if (atomic_compare_exchange_strong_explicit(&w->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+      chunk = b;
+    }
+    atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+  } else {
+    atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+  }
+
+  return chunk;
+}
+
+/* Thief side: take the chunk at the top of another worker's deque.
+ * Parameters:
+ *   - w: victim
+ *   - empty: set to true when the victim has nothing left
+ * Returns:
+ *   - chunk index, or -1 when nothing was taken
+ */
+static int bt_deque_steal(bt_worker_t* w, bool* empty) {
+  int chunk = -1;
+  int t = atomic_load_explicit(&w->top, memory_order_acquire);
+  int b;
+
+  atomic_thread_fence(memory_order_seq_cst);
+  b = atomic_load_explicit(&w->bottom, memory_order_acquire);
+
+  if (t < b) {
+    *empty = false;
+    if (atomic_compare_exchange_strong_explicit(&w->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+      chunk = t;
+    }
+  } else {
+    *empty = true;
+  }
+
+  return chunk;
+}
+
+/* Tick every agent of one chunk. */
+static void bt_executor_run_chunk(bt_executor_t* ex, bt_worker_t* w, int chunk) {
+  const uint32_t begin = (uint32_t)chunk * ex->chunk_size;
+  uint32_t n = ex->agent_count - begin;
+
+  if (n > ex->chunk_size) {
+    n = ex->chunk_size;
+  }
+
+  (void)bt_tick_batch(ex->def, &ex->states[begin], (ex->blackboards != BT_NULL) ? &ex->blackboards[begin] : BT_NULL,
+                      &ex->results[begin], n);
+  w->stats.chunks++;
+  w->stats.agents += n;
+}
+
+/* One round for one worker: drain the own deque, then steal until all are empty. */
+static void bt_executor_round(bt_executor_t* ex, bt_worker_t* w) {
+  const uint64_t t0 = bt_executor_now_ns();
+  bool all_empty = false;
+  int chunk = bt_deque_pop(w);
+
+  while (chunk >= 0) {
+    bt_executor_run_chunk(ex, w, chunk);
+    chunk = bt_deque_pop(w);
+  }
+
+  while (!all_empty) {
+    uint16_t k;
+
+    all_empty = true;
+    for (k = UINT16_ONE; k < ex->worker_count; k++) {
+      bt_worker_t* victim = &ex->workers[(w->index + k) % ex->worker_count];
+      bool empty = true;
+
+      chunk = bt_deque_steal(victim, &empty);
+      if (chunk >= 0) {
+        bt_executor_run_chunk(ex, w, chunk);
+        w->stats.steals++;
+      }
+      if (!empty) {
+        all_empty = false; /* Lost a race or took one: look again */
+      }
+    }
+  }
+
+  w->stats.busy_ns += bt_executor_now_ns() - t0;
+  w->stats.rounds++;
+}
+
+/* Worker thread: wait for a round, run it, report completion. */
+static void* bt_executor_worker(void* arg) {
+  bt_worker_t* w = (bt_worker_t*)arg;
+  bt_executor_t* ex = w->owner;
+  uint32_t seen = 0U;
+  bool running = true;
+
+  while (running) {
+    (void)pthread_mutex_lock(&ex->lock);
+    while ((ex->generation == seen) && (!ex->stopping)) {
+      (void)pthread_cond_wait(&ex->start_cv, &ex->lock);
+    }
+    seen = ex->generation;
+    running = !ex->stopping;
+    (void)pthread_mutex_unlock(&ex->lock);
+
+    if (running) {
+      bt_executor_round(ex, w);
+
+      if (atomic_fetch_sub_explicit(&ex->pending, 1U, memory_order_acq_rel) == 1U) {
+        (void)pthread_mutex_lock(&ex->lock);
+        (void)pthread_cond_signal(&ex->done_cv);
+        (void)pthread_mutex_unlock(&ex->lock);
+      }
+    }
+  }
+
+  return BT_NULL;
+}
+
+/* ===== Public API ===== */
+
+bt_status_t bt_executor_start(bt_executor_t* ex, uint16_t worker_count, const bt_flat_tree_t* def,
+                              bt_instance_t states[], void* const blackboards[], bt_status_t results[],
+                              uint32_t agent_count, uint32_t chunk_size) {
+  bt_status_t result = BT_ERROR;
+
+  if ((ex != BT_NULL) && (worker_count > UINT16_ZERO) && (worker_count <= BT_EXECUTOR_MAX_WORKERS) &&
+      (def != BT_NULL) && (states != BT_NULL) && (results != BT_NULL)) {
+    uint16_t i;
+
+    ex->worker_count = UINT16_ZERO;
+    ex->def = def;
+    ex->states = states;
+    ex->blackboards = blackboards;
+    ex->results = results;
+    ex->agent_count = agent_count;
+    ex->chunk_size = (chunk_size > 0U) ? chunk_size : BT_EXECUTOR_CHUNK;
+    ex->chunk_count = (agent_count + ex->chunk_size - 1U) / ex->chunk_size;
+    ex->generation = 0U;
+    ex->stopping = false;
+    atomic_init(&ex->pending, 0U);
+    (void)pthread_mutex_init(&ex->lock, BT_NULL);
+    (void)pthread_cond_init(&ex->start_cv, BT_NULL);
+    (void)pthread_cond_init(&ex->done_cv, BT_NULL);
+
+    result = (ex->chunk_count <= (uint32_t)INT32_MAX) ? BT_SUCCESS : BT_ERROR;
+
+    for (i = UINT16_ZERO; (i < worker_count) && (result == BT_SUCCESS); i++) {
+      bt_worker_t* w = &ex->workers[i];
+
+      atomic_init(&w->top, 0);
+      atomic_init(&w->bottom, 0);
+      w->owner = ex;
+      w->index = i;
+      w->stats = (bt_worker_stats_t){0U, 0U, 0U, 0U, 0U, 0U};
+
+      if (pthread_create(&w->thread, BT_NULL, bt_executor_worker, w) == 0) {
+        ex->worker_count++;
+      } else {
+        result = BT_ERROR;
+      }
+    }
+
+    if (result != BT_SUCCESS) {
+      bt_executor_stop(ex);
+    }
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_executor_tick_all(bt_executor_t* ex) {
+  bt_status_t result = BT_ERROR;
+
+  if ((ex != BT_NULL) && (ex->worker_count > UINT16_ZERO) && (!ex->stopping)) {
+    const uint64_t t0 = bt_executor_now_ns();
+    uint64_t wall = 0U;
+    uint16_t i;
+
+    /* Contiguous chunk ranges keep each worker on neighbouring agents */
+    for (i = UINT16_ZERO; i < ex->worker_count; i++) {
+      const uint64_t begin = ((uint64_t)ex->chunk_count * i) / ex->worker_count;
+      const uint64_t end = ((uint64_t)ex->chunk_count * (i + UINT16_ONE)) / ex->worker_count;
+
+      atomic_store_explicit(&ex->workers[i].top, (int)begin, memory_order_relaxed);
+      atomic_store_explicit(&ex->workers[i].bottom, (int)end, memory_order_relaxed);
+    }
+    atomic_store_explicit(&ex->pending, ex->worker_count, memory_order_release);
+
+    (void)pthread_mutex_lock(&ex->lock);
+    ex->generation++;
+    (void)pthread_cond_broadcast(&ex->start_cv);
+    while (atomic_load_explicit(&ex->pending, memory_order_acquire) > 0U) {
+      (void)pthread_cond_wait(&ex->done_cv, &ex->lock);
+    }
+    (void)pthread_mutex_unlock(&ex->lock);
+
+    wall = bt_executor_now_ns() - t0;
+    for (i = UINT16_ZERO; i < ex->worker_count; i++) {
+      ex->workers[i].stats.wall_ns += wall;
+    }
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_executor_stats(const bt_executor_t* ex, uint16_t worker, bt_worker_stats_t* out) {
+  bt_status_t result = BT_ERROR;
+
+  if ((ex != BT_NULL) && (out != BT_NULL) && (worker < ex->worker_count)) {
+    *out = ex->workers[worker].stats;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+void bt_executor_reset_stats(bt_executor_t* ex) {
+  if (ex != BT_NULL) {
+    uint16_t i;
+
+    for (i = UINT16_ZERO; i < ex->worker_count; i++) {
+      ex->workers[i].stats = (bt_worker_stats_t){0U, 0U, 0U, 0U, 0U, 0U};
+    }
+  } else {
+    /* No action */
+  }
+}
+
+void bt_executor_stop(bt_executor_t* ex) {
+  if (ex != BT_NULL) {
+    uint16_t i;
+
+    (void)pthread_mutex_lock(&ex->lock);
+    ex->stopping = true;
+    (void)pthread_cond_broadcast(&ex->start_cv);
+    (void)pthread_mutex_unlock(&ex->lock);
+
+    for (i = UINT16_ZERO; i < ex->worker_count; i++) {
+      (void)pthread_join(ex->workers[i].thread, BT_NULL);
+    }
+    ex->worker_count = UINT16_ZERO;
+
+    (void)pthread_cond_destroy(&ex->done_cv);
+    (void)pthread_cond_destroy(&ex->start_cv);
+    (void)pthread_mutex_destroy(&ex->lock);
+  } else {
+    /* No action */
+  }
+}
@@ -0,0 +1,880 @@
+/*
+ * bt_flat.c
+ *
+ * Compiler and tick engine for the flattened Behavior Tree representation.
+ * bt_compile() performs an iterative pre-order walk of a wired bt_node_t
+ * graph; bt_tick_instance() walks the resulting array using parent/next
+ * indices, so a tick never recurses and touches child nodes in memory order.
+ * All mutable state is read from and written to the bt_instance_t.
+ */
+
+#include "bt_flat.h"
+
+#include "bt_internal.h"
+
+/* ===== Internal constants ===== */
+
+/* Cursor slots used by a PARALLEL node: cursor, done_mask (2), success_mask (2) */
+#define BT_FLAT_PARALLEL_SLOTS ((uint16_t)5U)
+
+/* ===== Internal types ===== */
+
+/* One level of the compile-time walk */
+typedef struct {
+  bt_node_t* node;     /* Source node being expanded */
+  uint16_t index;      /* Its index in the flat array */
+  uint16_t next_child; /* Next child ordinal to emit */
+} bt_flat_frame_t;
+
+/* ===== Internal helpers (compile) ===== */
+
+/* True for ACTION/CONDITION, which never expand their children array. */
+static bool bt_flat_is_leaf(bt_node_type_t type) { return (type == BT_ACTION) || (type == BT_CONDITION); }
+
+/* Check that a source node can be compiled.
+ * Returns:
+ *   - true when the node has a supported type and a consistent shape
+ */
+static bool bt_flat_node_ok(const bt_node_t* node) {
+  bool ok = false;
+
+  switch (node->type) {
+    case BT_ACTION:
+    case BT_CONDITION: {
+      /* Leaf state behind ext (coroutines) would be shared by every instance */
+      ok = (node->tick != BT_NULL) && (node->ext == BT_NULL);
+      break;
+    }
+
+    case BT_SEQUENCE:
+    case BT_SELECTOR: {
+      ok = (node->children_count == UINT16_ZERO) || (node->children != BT_NULL);
+      break;
+    }
+
+    case BT_INVERTER: {
+      ok = (node->children_count == UINT16_ONE) && (node->children != BT_NULL);
+      break;
+    }
+
+    case BT_PARALLEL: {
+      ok = (node->children != BT_NULL) && bt_parallel_ok(node);
+      break;
+    }
+
+    default: {
+      ok = false;
+      break;
+    }
+  }
+
+  return ok;
+}
+
+/* Iterative pre-order walk shared by bt_count_nodes() and bt_compile().
+ * Parameters:
+ *   - root: tree root
+ *   - nodes: output array, or NULL to count only
+ *   - capacity: number of entries available in nodes (ignored when counting)
+ *   - count_out: receives the number of nodes visited
+ *   - slots_out: receives the number of cursor slots (composites)
+ * Returns:
+ *   - BT_SUCCESS, or BT_ERROR if the tree is invalid or does not fit
+ */
+static bt_status_t bt_flat_walk(bt_node_t* root, bt_flat_node_t nodes[], uint16_t capacity, uint16_t* count_out,
+                                uint16_t* slots_out) {
+  bt_flat_frame_t stack[BT_FLAT_MAX_DEPTH];
+  uint16_t depth = UINT16_ZERO;
+  uint16_t count = UINT16_ZERO;
+  uint16_t slots = UINT16_ZERO;
+  const uint16_t limit = (nodes != BT_NULL) ? capacity : BT_FLAT_MAX_NODES;
+  bt_node_t* pending = root;
+  uint16_t pending_parent = BT_FLAT_NONE;
+  uint16_t pending_ordinal = UINT16_ZERO;
+  bt_status_t result = BT_SUCCESS;
+
+  while ((result == BT_SUCCESS) && ((pending != BT_NULL) || (depth > UINT16_ZERO))) {
+    if (pending != BT_NULL) {
+      /* Emit the pending node and descend into it */
+      if ((!bt_flat_node_ok(pending)) || (count >= limit) || (depth >= BT_FLAT_MAX_DEPTH) ||
+          (slots > (BT_FLAT_MAX_NODES - BT_FLAT_PARALLEL_SLOTS))) {
+        result = BT_ERROR;
+      } else {
+        const bool leaf = bt_flat_is_leaf(pending->type);
+
+        if (nodes != BT_NULL) {
+          nodes[count].src = pending;
+          nodes[count].parent = pending_parent;
+          nodes[count].next = BT_FLAT_NONE; /* Patched when the subtree closes */
+          nodes[count].slot = leaf ? BT_FLAT_NONE : slots;
+          nodes[count].type = (uint8_t)pending->type;
+          nodes[count].ordinal = (pending_ordinal < 0xFFU) ? (uint8_t)pending_ordinal : 0xFFU;
+        }
+
+        if (!leaf) {
+          slots += (pending->type == BT_PARALLEL) ? BT_FLAT_PARALLEL_SLOTS : UINT16_ONE;
+        }
+
+        stack[depth].node = pending;
+        stack[depth].index = count;
+        stack[depth].next_child = UINT16_ZERO;
+        depth++;
+        count++;
+        pending = BT_NULL;
+      }
+    } else {
+      bt_flat_frame_t* frame = &stack[depth - UINT16_ONE];
+      const uint16_t child_count = bt_flat_is_leaf(frame->node->type) ? UINT16_ZERO : frame->node->children_count;
+
+      if (frame->next_child < child_count) {
+        pending = frame->node->children[frame->next_child];
+        pending_parent = frame->index;
+        pending_ordinal = frame->next_child;
+        frame->next_child++;
+
+        if (pending == BT_NULL) {
+          result = BT_ERROR;
+        }
+      } else {
+        /* Subtree closed: everything emitted since frame->index belongs to it */
+        if (nodes != BT_NULL) {
+          nodes[frame->index].next = count;
+        }
+        depth--;
+      }
+    }
+  }
+
+  *count_out = count;
+  *slots_out = slots;
+  return result;
+}
+
+/* ===== Internal helpers (tick) ===== */
+
+/* Per-tick context shared by the helpers below */
+typedef struct {
+  const uint8_t* links;        /* Structure of node i at links + i * stride */
+  size_t stride;               /* sizeof(bt_flat_node_t) or sizeof(bt_image_node_t) */
+  const bt_flat_tree_t* def;   /* Source pointers or image bindings */
+  bt_instance_t* inst;
+  void* blackboard;
+  bt_node_t view; /* Per-call copy of the source node handed to callbacks */
+} bt_flat_run_t;
+
+/* Bind a tick context to a definition (compiled nodes or image). */
+static void bt_flat_bind(bt_flat_run_t* run, const bt_flat_tree_t* def) {
+  run->def = def;
+  if (def->nodes != BT_NULL) {
+    run->links = (const uint8_t*)&def->nodes[0].link;
+    run->stride = sizeof(bt_flat_node_t);
+  } else {
+    run->links = (const uint8_t*)&def->image[0].link;
+    run->stride = sizeof(bt_image_node_t);
+  }
+}
+
+/* True when def has nodes to tick. */
+static bool bt_flat_def_ok(const bt_flat_tree_t* def) {
+  return (def != BT_NULL) && ((def->nodes != BT_NULL) || (def->image != BT_NULL)) && (def->count > UINT16_ZERO);
+}
+
+/* Structure of node i (the link is the first member of both node layouts). */
+static inline const bt_flat_link_t* bt_flat_at(const bt_flat_run_t* run, uint16_t i) {
+  return (const bt_flat_link_t*)(const void*)(run->links + ((size_t)i * run->stride));
+}
+
+/* Source node of i: its wired node, or its image binding (NULL for none). */
+static const bt_node_t* bt_flat_src(const bt_flat_run_t* run, uint16_t i) {
+  const bt_node_t* src = BT_NULL;
+
+  if (run->def->nodes != BT_NULL) {
+    src = run->def->nodes[i].src;
+  } else {
+    const uint16_t ref = run->def->image[i].ref;
+
+    src = (ref < run->def->binding_count) ? &run->def->bindings[ref] : BT_NULL;
+  }
+
+  return src;
+}
+
+/* Store the status of node i, tracing the transition (see bt_trace.h). */
+static void bt_flat_store(bt_instance_t* inst, uint16_t i, bt_status_t status) {
+  bt_trace_emit(i, (bt_status_t)inst->status[i], status);
+  inst->status[i] = (uint8_t)status;
+}
+
+/* Prepare the view of node i (whose source is src) for a callback. */
+static bt_node_t* bt_flat_view(bt_flat_run_t* run, uint16_t i, const bt_node_t* src) {
+  run->view = *src;
+  run->view.status = (bt_status_t)run->inst->status[i];
+  if (run->blackboard != BT_NULL) {
+    run->view.blackboard = run->blackboard;
+  }
+  if (run->def->image != BT_NULL) {
+    run->view.id = i; /* Bindings are shared between nodes */
+  }
+
+  return &run->view;
+}
+
+/* Tick a compiled leaf through its source callback. */
+static bt_status_t bt_flat_tick_leaf(bt_flat_run_t* run, uint16_t i) {
+  bt_node_t* view = bt_flat_view(run, i, bt_flat_src(run, i));
+  const bt_status_t result = view->tick(view);
+
+  bt_flat_store(run->inst, i, result);
+  return result;
+}
+
+/* Read a PARALLEL bitset stored as two cursor slots (low half first). */
+static uint32_t bt_flat_mask(const bt_instance_t* inst, uint16_t slot) {
+  return (uint32_t)inst->cursor[slot] | ((uint32_t)inst->cursor[slot + UINT16_ONE] << 16U);
+}
+
+/* Write a PARALLEL bitset stored as two cursor slots. */
+static void bt_flat_set_mask(bt_instance_t* inst, uint16_t slot, uint32_t mask) {
+  inst->cursor[slot] = (uint16_t)(mask & 0xFFFFU);
+  inst->cursor[slot + UINT16_ONE] = (uint16_t)(mask >> 16U);
+}
+
+/* Enter composite i: reset its cursor (and PARALLEL bitsets) and fire
+ * on_enter unless it was RUNNING.
+ */
+static void bt_flat_enter(bt_flat_run_t* run, uint16_t i) {
+  const bt_flat_link_t* node = bt_flat_at(run, i);
+
+  if (run->inst->status[i] != (uint8_t)BT_RUNNING) {
+    run->inst->cursor[node->slot] = (uint16_t)(i + UINT16_ONE);
+
+    if (node->type == (uint8_t)BT_PARALLEL) {
+      bt_flat_set_mask(run->inst, (uint16_t)(node->slot + 1U), 0U);
+      bt_flat_set_mask(run->inst, (uint16_t)(node->slot + 3U), 0U);
+    }
+
+    const bt_node_t* src = bt_flat_src(run, i);
+
+    if ((src != BT_NULL) && (src->on_enter != BT_NULL)) {
+      bt_node_t* view = bt_flat_view(run, i, src);
+      view->on_enter(view);
+    }
+  } else {
+    /* Resuming */
+  }
+}
+
+/* Store a composite's new status and fire on_exit on terminal states. */
+static void bt_flat_settle(bt_flat_run_t* run, uint16_t i, bt_status_t result) {
+  bt_flat_store(run->inst, i, result);
+
+  if (bt_is_terminal(result)) {
+    const bt_node_t* src = bt_flat_src(run, i);
+
+    if ((src != BT_NULL) && (src->on_exit != BT_NULL)) {
+      bt_node_t* view = bt_flat_view(run, i, src);
+      view->on_exit(view);
+    } else {
+      /* No hook */
+    }
+  } else {
+    /* Still running */
+  }
+}
+
+/* Feed a settled child's status back into its SEQUENCE/SELECTOR parent.
+ * Parameters:
+ *   - run: tick context
+ *   - p: index of the composite parent
+ *   - child: index of the child that settled
+ *   - result: in: child status, out: parent status when the parent settles
+ *   - keep_going: status that moves to the next sibling (SUCCESS for SEQUENCE, FAILURE for SELECTOR)
+ * Returns:
+ *   - index of the next child to tick, or BT_FLAT_NONE when the parent settled
+ */
+static uint16_t bt_flat_resume_composite(bt_flat_run_t* run, uint16_t p, uint16_t child, bt_status_t* result,
+                                         bt_status_t keep_going) {
+  const bt_flat_link_t* parent = bt_flat_at(run, p);
+  uint16_t* cursor = &run->inst->cursor[parent->slot];
+  const uint16_t sibling = bt_flat_at(run, child)->next;
+  uint16_t next = BT_FLAT_NONE;
+  const bt_status_t cs = *result;
+
+  if (cs == BT_RUNNING) {
+    *cursor = child;
+    bt_flat_store(run->inst, p, BT_RUNNING);
+  } else if ((cs == BT_ERROR) || ((cs != keep_going) && ((cs == BT_SUCCESS) || (cs == BT_FAILURE)))) {
+    /* ERROR, or the status that ends this composite early */
+    *cursor = child;
+    bt_flat_settle(run, p, cs);
+  } else if (sibling < parent->next) {
+    /* Child produced keep_going (or an unknown value, treated like bt_tick does) */
+    *cursor = sibling;
+    next = sibling;
+  } else {
+    *cursor = sibling;
+    *result = keep_going;
+    bt_flat_settle(run, p, keep_going);
+  }
+
+  return next;
+}
+
+/* Find the first child of PARALLEL p at or after child index c that has not
+ * finished in the current run.
+ * Returns:
+ *   - child index, or BT_FLAT_NONE when every remaining child has finished
+ */
+static uint16_t bt_flat_parallel_next(const bt_flat_run_t* run, uint16_t p, uint16_t c) {
+  const bt_flat_link_t* parent = bt_flat_at(run, p);
+  const uint32_t done = bt_flat_mask(run->inst, (uint16_t)(parent->slot + 1U));
+  uint16_t child = c;
+
+  while ((child < parent->next) && ((done & ((uint32_t)1U << bt_flat_at(run, child)->ordinal)) != 0U)) {
+    child = bt_flat_at(run, child)->next;
+  }
+
+  return (child < parent->next) ? child : BT_FLAT_NONE;
+}
+
+/* Decide PARALLEL p from its bitsets, with thresholds from its source node or
+ * its image entry.
+ */
+static bt_status_t bt_flat_decide(const bt_flat_run_t* run, uint16_t p, uint32_t done, uint32_t success) {
+  bt_status_t result = BT_ERROR;
+
+  if (run->def->nodes != BT_NULL) {
+    result = bt_parallel_decide(run->def->nodes[p].src, done, success);
+  } else {
+    const bt_image_node_t* node = &run->def->image[p];
+
+    result = bt_parallel_decide_with(node->children, node->success_threshold, node->failure_threshold, done, success);
+  }
+
+  return result;
+}
+
+/* Halt the children of settling PARALLEL p that are not in done, like
+ * bt_parallel_halt_rest(): RUNNING nodes in their subtrees become FAILURE,
+ * scanned in reverse pre-order so composites fire on_exit deepest first.
+ */
+static void bt_flat_halt_rest(bt_flat_run_t* run, uint16_t p, uint32_t done) {
+  const bt_flat_link_t* parent = bt_flat_at(run, p);
+  uint16_t child = (uint16_t)(p + UINT16_ONE);
+
+  while (child < parent->next) {
+    const uint16_t end = bt_flat_at(run, child)->next;
+
+    if ((done & ((uint32_t)1U << bt_flat_at(run, child)->ordinal)) == 0U) {
+      uint16_t i = end;
+
+      while (i > child) {
+        i--;
+        if (run->inst->status[i] != (uint8_t)BT_RUNNING) {
+          /* Not on the RUNNING path */
+        } else if (bt_flat_at(run, i)->slot == BT_FLAT_NONE) {
+          bt_flat_store(run->inst, i, BT_FAILURE); /* Leaves have no hooks */
+        } else {
+          bt_flat_settle(run, i, BT_FAILURE);
+        }
+      }
+    } else {
+      /* Finished in this run */
+    }
+    child = end;
+  }
+}
+
+/* Feed a settled child's status back into its PARALLEL parent.
+ * Parameters:
+ *   - run: tick context
+ *   - p: index of the PARALLEL parent
+ *   - child: index of the child that settled
+ *   - result: in: child status, out: parent status when the parent settles
+ * Returns:
+ *   - index of the next unfinished child to tick, or BT_FLAT_NONE when the
+ *     parent settled (RUNNING once every unfinished child was ticked)
+ */
+static uint16_t bt_flat_resume_parallel(bt_flat_run_t* run, uint16_t p, uint16_t child, bt_status_t* result) {
+  const bt_flat_link_t* parent = bt_flat_at(run, p);
+  const uint16_t done_slot = (uint16_t)(parent->slot + 1U);
+  const uint16_t success_slot = (uint16_t)(parent->slot + 3U);
+  const uint32_t bit = (uint32_t)1U << bt_flat_at(run, child)->ordinal;
+  uint32_t done = bt_flat_mask(run->inst, done_slot);
+  uint32_t success = bt_flat_mask(run->inst, success_slot);
+  uint16_t next = BT_FLAT_NONE;
+  bt_status_t decided = BT_ERROR;
+
+  if (*result == BT_SUCCESS) {
+    done |= bit;
+    success |= bit;
+  } else if (*result == BT_FAILURE) {
+    done |= bit;
+  } else {
+    /* RUNNING: tick again next time; ERROR is handled below */
+  }
+  bt_flat_set_mask(run->inst, done_slot, done);
+  bt_flat_set_mask(run->inst, success_slot, success);
+
+  decided = (*result == BT_ERROR) ? BT_ERROR : bt_flat_decide(run, p, done, success);
+  if (decided != BT_RUNNING) {
+    *result = decided;
+    bt_flat_store(run->inst, p, decided);
+    bt_flat_halt_rest(run, p, done);
+    bt_flat_settle(run, p, decided);
+  } else {
+    next = bt_flat_parallel_next(run, p, bt_flat_at(run, child)->next);
+    if (next == BT_FLAT_NONE) {
+      *result = BT_RUNNING;
+      bt_flat_store(run->inst, p, BT_RUNNING);
+    }
+  }
+
+  run->inst->cursor[parent->slot] = (next != BT_FLAT_NONE) ? next : child;
+  return next;
+}
+
+/* Run one tick of run->inst over the bound definition (arguments already validated).
+ * Behavior:
+ *   - Descends from the root following each composite's cursor, exactly like
+ *     bt_tick() resumes at current_child.
+ *   - When a node settles, its status is handed to the parent, which either
+ *     selects the next sibling to descend into or settles in turn.
+ *   - While the root is RUNNING on behalf of a single leaf, the tick starts at
+ *     that leaf (state->active): its ancestors are RUNNING with cursors on the
+ *     path, so descending from the root would reach it without side effects.
+ *     If the leaf is still RUNNING the tick ends there, since handing that
+ *     status up would store the same values again; the ancestors are walked
+ *     only once the leaf settles.
+ * Notes:
+ *   - on_enter/on_exit fire at the same points as in the recursive engine.
+ */
+static bt_status_t bt_flat_run(bt_flat_run_t* run) {
+  bt_instance_t* const state = run->inst;
+  bt_status_t result = BT_ERROR;
+  uint16_t i = UINT16_ZERO;
+  bool descending = true;
+  bool done = false;
+  bool resumed = false;
+
+  if ((state->active != BT_FLAT_NONE) && (state->status[0] == (uint8_t)BT_RUNNING)) {
+    i = state->active;
+    resumed = true;
+  }
+  state->active = BT_FLAT_NONE;
+
+  while (!done) {
+    const bt_flat_link_t* node = bt_flat_at(run, i);
+
+    if (descending) {
+      switch ((bt_node_type_t)node->type) {
+        case BT_ACTION:
+        case BT_CONDITION: {
+          result = bt_flat_tick_leaf(run, i);
+          state->active = (result == BT_RUNNING) ? i : BT_FLAT_NONE;
+          descending = false;
+          done = resumed && (result == BT_RUNNING); /* Cached leaf still RUNNING */
+          resumed = false;
+          break;
+        }
+
+        case BT_SEQUENCE:
+        case BT_SELECTOR:
+        case BT_INVERTER: {
+          bt_flat_enter(run, i);
+
+          if (state->cursor[node->slot] < node->next) {
+            i = state->cursor[node->slot];
+          } else {
+            /* Empty composite (INVERTER always has one child) */
+            result = (node->type == (uint8_t)BT_SEQUENCE) ? BT_SUCCESS : BT_FAILURE;
+            bt_flat_settle(run, i, result);
+            descending = false;
+          }
+          break;
+        }
+
+        case BT_PARALLEL: {
+          /* Every tick starts over at the first unfinished child */
+          uint16_t first = BT_FLAT_NONE;
+
+          bt_flat_enter(run, i);
+          first = bt_flat_parallel_next(run, i, (uint16_t)(i + UINT16_ONE));
+          if (first != BT_FLAT_NONE) {
+            state->cursor[node->slot] = first;
+            i = first;
+          } else {
+            /* Not reachable for a compiled node: a RUNNING parallel has an unfinished child */
+            result = BT_RUNNING;
+            bt_flat_store(state, i, BT_RUNNING);
+            descending = false;
+          }
+          break;
+        }
+
+        default: {
+          result = BT_ERROR;
+          bt_flat_store(state, i, BT_ERROR);
+          descending = false;
+          break;
+        }
+      }
+    } else if (node->parent == BT_FLAT_NONE) {
+      if (result != BT_RUNNING) {
+        state->active = BT_FLAT_NONE;
+      }
+      done = true;
+    } else {
+      const uint16_t p = node->parent;
+      uint16_t next = BT_FLAT_NONE;
+
+      switch ((bt_node_type_t)bt_flat_at(run, p)->type) {
+        case BT_SEQUENCE: {
+          next = bt_flat_resume_composite(run, p, i, &result, BT_SUCCESS);
+          break;
+        }
+
+        case BT_SELECTOR: {
+          next = bt_flat_resume_composite(run, p, i, &result, BT_FAILURE);
+          break;
+        }
+
+        case BT_PARALLEL: {
+          next = bt_flat_resume_parallel(run, p, i, &result);
+          state->active = BT_FLAT_NONE; /* Siblings are ticked too: never resume below a PARALLEL */
+          break;
+        }
+
+        default: {
+          /* BT_INVERTER: RUNNING and ERROR propagate unchanged */
+          if (result == BT_SUCCESS) {
+            result = BT_FAILURE;
+          } else if (result == BT_FAILURE) {
+            result = BT_SUCCESS;
+          } else {
+            /* Propagate */
+          }
+          bt_flat_settle(run, p, result);
+          break;
+        }
+      }
+
+      if (next != BT_FLAT_NONE) {
+        i = next;
+        descending = true;
+        state->active = BT_FLAT_NONE; /* Another subtree runs after the cached leaf */
+      } else {
+        i = p;
+      }
+    }
+  }
+
+  return result;
+}
+
+#if BT_FLAT_THREADED
+
+/* Handler index for a node type byte: the type itself, or BT_ASYNC (no flat
+ * handler) for anything a compiled tree or a verified image cannot hold. */
+static inline uint8_t bt_flat_kind(uint8_t type) { return (type < (uint8_t)BT_ASYNC) ? type : (uint8_t)BT_ASYNC; }
+
+/* Labels as values and goto * are GNU C; everything else stays ISO C */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+/* Jump to the descending handler of node i */
+#define BT_FLAT_DOWN()                    \
+  do {                                    \
+    node = bt_flat_at(run, i);            \
+    goto* down[bt_flat_kind(node->type)]; \
+  } while (0)
+
+/* Hand the settled node i to its parent's ascending handler (or finish) */
+#define BT_FLAT_UP()                                  \
+  do {                                                \
+    p = node->parent;                                 \
+    if (p == BT_FLAT_NONE) {                          \
+      goto finish;                                    \
+    }                                                 \
+    goto* up[bt_flat_kind(bt_flat_at(run, p)->type)]; \
+  } while (0)
+
+/* Continue after a parent handler: descend into next, or settle upwards */
+#define BT_FLAT_RESUME()            \
+  do {                              \
+    if (next != BT_FLAT_NONE) {     \
+      i = next;                     \
+      state->active = BT_FLAT_NONE; \
+      BT_FLAT_DOWN();               \
+    }                               \
+    i = p;                          \
+    node = bt_flat_at(run, i);      \
+    BT_FLAT_UP();                   \
+  } while (0)
+
+/* bt_flat_run() with direct-threaded dispatch.
+ * Behavior:
+ *   - Same walk, helpers and results as bt_flat_run(); only the dispatch
+ *     differs. Every handler ends in its own indirect jump through a table
+ *     indexed by node type (down: the node being entered, up: the parent
+ *     receiving a settled child), so each transition gets its own branch
+ *     history instead of sharing the two switch jumps of the loop.
+ */
+static bt_status_t bt_flat_run_threaded(bt_flat_run_t* run) {
+  static const void* const down[] = {&&down_leaf,     &&down_leaf,     &&down_chain,   &&down_chain,
+                                     &&down_chain,    &&down_parallel, &&down_invalid};
+  /* Like the switch in bt_flat_run(), any other parent type settles as an INVERTER */
+  static const void* const up[] = {&&up_inverter, &&up_inverter, &&up_sequence, &&up_selector,
+                                   &&up_inverter, &&up_parallel, &&up_inverter};
+  bt_instance_t* const state = run->inst;
+  const bt_flat_link_t* node = BT_NULL;
+  bt_status_t result = BT_ERROR;
+  uint16_t i = UINT16_ZERO;
+  uint16_t p = BT_FLAT_NONE;
+  uint16_t next = BT_FLAT_NONE;
+  bool resumed = false;
+
+  _Static_assert((BT_ACTION == 0) && (BT_CONDITION == 1) && (BT_SEQUENCE == 2) && (BT_SELECTOR == 3) &&
+                     (BT_INVERTER == 4) && (BT_PARALLEL == 5) && (BT_ASYNC == 6),
+                 "dispatch tables follow bt_node_type_t");
+
+  if ((state->active != BT_FLAT_NONE) && (state->status[0] == (uint8_t)BT_RUNNING)) {
+    i = state->active;
+    resumed = true;
+  }
+  state->active = BT_FLAT_NONE;
+  BT_FLAT_DOWN();
+
+down_leaf:
+  result = bt_flat_tick_leaf(run, i);
+  state->active = (result == BT_RUNNING) ? i : BT_FLAT_NONE;
+  if (resumed && (result == BT_RUNNING)) {
+    goto finish; /* Cached leaf still RUNNING */
+  }
+  resumed = false;
+  BT_FLAT_UP();
+
+down_chain:
+  bt_flat_enter(run, i);
+  if (state->cursor[node->slot] < node->next) {
+    i = state->cursor[node->slot];
+    BT_FLAT_DOWN();
+  }
+  /* Empty composite (INVERTER always has one child) */
+  result = (node->type == (uint8_t)BT_SEQUENCE) ? BT_SUCCESS : BT_FAILURE;
+  bt_flat_settle(run, i, result);
+  BT_FLAT_UP();
+
+down_parallel:
+  /* Every tick starts over at the first unfinished child */
+  bt_flat_enter(run, i);
+  next = bt_flat_parallel_next(run, i, (uint16_t)(i + UINT16_ONE));
+  if (next != BT_FLAT_NONE) {
+    state->cursor[node->slot] = next;
+    i = next;
+    BT_FLAT_DOWN();
+  }
+  /* Not reachable for a compiled node: a RUNNING parallel has an unfinished child */
+  result = BT_RUNNING;
+  bt_flat_store(state, i, BT_RUNNING);
+  BT_FLAT_UP();
+
+down_invalid:
+  result = BT_ERROR;
+  bt_flat_store(state, i, BT_ERROR);
+  BT_FLAT_UP();
+
+up_sequence:
+  next = bt_flat_resume_composite(run, p, i, &result, BT_SUCCESS);
+  BT_FLAT_RESUME();
+
+up_selector:
+  next = bt_flat_resume_composite(run, p, i, &result, BT_FAILURE);
+  BT_FLAT_RESUME();
+
+up_parallel:
+  next = bt_flat_resume_parallel(run, p, i, &result);
+  state->active = BT_FLAT_NONE; /* Siblings are ticked too: never resume below a PARALLEL */
+  BT_FLAT_RESUME();
+
+up_inverter:
+  /* RUNNING and ERROR propagate unchanged */
+  if (result == BT_SUCCESS) {
+    result = BT_FAILURE;
+  } else if (result == BT_FAILURE) {
+    result = BT_SUCCESS;
+  } else {
+    /* Propagate */
+  }
+  bt_flat_settle(run, p, result);
+  next = BT_FLAT_NONE;
+  BT_FLAT_RESUME();
+
+finish:
+  if (result != BT_RUNNING) {
+    state->active = BT_FLAT_NONE;
+  }
+
+  return result;
+}
+
+#undef BT_FLAT_RESUME
+#undef BT_FLAT_UP
+#undef BT_FLAT_DOWN
+
+#pragma GCC diagnostic pop
+
+#else /* !BT_FLAT_THREADED */
+
+/* Portable build: the threaded entry points share the switch interpreter. */
+static bt_status_t bt_flat_run_threaded(bt_flat_run_t* run) { return bt_flat_run(run); }
+
+#endif /* BT_FLAT_THREADED */
+
+/* ===== Public API ===== */
+
+uint16_t bt_count_nodes(const bt_node_t* root) {
+  uint16_t count = UINT16_ZERO;
+  uint16_t slots = UINT16_ZERO;
+
+  if (root != BT_NULL) {
+    if (bt_flat_walk((bt_node_t*)root, BT_NULL, UINT16_ZERO, &count, &slots) != BT_SUCCESS) {
+      count = UINT16_ZERO;
+    }
+  } else {
+    /* Nothing to count */
+  }
+
+  return count;
+}
+
+bt_status_t bt_compile(bt_node_t* root, bt_flat_node_t nodes[], uint16_t capacity, bt_flat_tree_t* tree) {
+  bt_status_t result = BT_ERROR;
+  uint16_t count = UINT16_ZERO;
+  uint16_t slots = UINT16_ZERO;
+
+  if ((root != BT_NULL) && (nodes != BT_NULL) && (tree != BT_NULL)) {
+    result = bt_flat_walk(root, nodes, capacity, &count, &slots);
+    tree->nodes = (result == BT_SUCCESS) ? nodes : BT_NULL;
+    tree->count = (result == BT_SUCCESS) ? count : UINT16_ZERO;
+    tree->slots = (result == BT_SUCCESS) ? slots : UINT16_ZERO;
+    tree->image = BT_NULL;
+    tree->bindings = BT_NULL;
+    tree->binding_count = UINT16_ZERO;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_instance_init(const bt_flat_tree_t* def, bt_instance_t* inst, uint8_t status[], uint16_t cursor[]) {
+  bt_status_t result = BT_ERROR;
+
+  if ((def != BT_NULL) && (inst != BT_NULL) && (status != BT_NULL) &&
+      ((cursor != BT_NULL) || (def->slots == UINT16_ZERO))) {
+    uint16_t i;
+
+    for (i = UINT16_ZERO; i < def->count; i++) {
+      status[i] = (uint8_t)BT_FAILURE; /* Default until first tick */
+    }
+    for (i = UINT16_ZERO; i < def->slots; i++) {
+      cursor[i] = UINT16_ZERO;
+    }
+
+    inst->status = status;
+    inst->cursor = cursor;
+    inst->active = BT_FLAT_NONE;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Tick one instance of a compiled tree; see bt_flat_run(). */
+bt_status_t bt_tick_instance(const bt_flat_tree_t* def, bt_instance_t* state, void* blackboard) {
+  bt_status_t result = BT_ERROR;
+
+  if (bt_flat_def_ok(def) && (state != BT_NULL) && (state->status != BT_NULL)) {
+    bt_flat_run_t run;
+
+    bt_flat_bind(&run, def);
+    run.inst = state;
+    run.blackboard = blackboard;
+    result = bt_flat_run(&run);
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Tick many instances of one definition back to back.
+ * Behavior:
+ *   - The definition is validated once and the tick context is reused, so the
+ *     per-agent cost is the tick itself; the shared nodes stay hot in cache.
+ *   - Agents are ticked in array order; results[i] receives agent i's root
+ *     status, or BT_ERROR when its state is not initialized.
+ */
+bt_status_t bt_tick_batch(const bt_flat_tree_t* def, bt_instance_t states[], void* const blackboards[],
+                          bt_status_t results[], uint32_t count) {
+  bt_status_t result = BT_ERROR;
+
+  if (bt_flat_def_ok(def) && (states != BT_NULL) && (results != BT_NULL)) {
+    bt_flat_run_t run;
+    uint32_t i;
+
+    bt_flat_bind(&run, def);
+    for (i = 0U; i < count; i++) {
+      run.inst = &states[i];
+      run.blackboard = (blackboards != BT_NULL) ? blackboards[i] : BT_NULL;
+      results[i] = (run.inst->status != BT_NULL) ? bt_flat_run(&run) : BT_ERROR;
+    }
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_tick_instance_threaded(const bt_flat_tree_t* def, bt_instance_t* state, void* blackboard) {
+  bt_status_t result = BT_ERROR;
+
+  if (bt_flat_def_ok(def) && (state != BT_NULL) && (state->status != BT_NULL)) {
+    bt_flat_run_t run;
+
+    bt_flat_bind(&run, def);
+    run.inst = state;
+    run.blackboard = blackboard;
+    result = bt_flat_run_threaded(&run);
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_tick_batch_threaded(const bt_flat_tree_t* def, bt_instance_t states[], void* const blackboards[],
+                                   bt_status_t results[], uint32_t count) {
+  bt_status_t result = BT_ERROR;
+
+  if (bt_flat_def_ok(def) && (states != BT_NULL) && (results != BT_NULL)) {
+    bt_flat_run_t run;
+    uint32_t i;
+
+    bt_flat_bind(&run, def);
+    for (i = 0U; i < count; i++) {
+      run.inst = &states[i];
+      run.blackboard = (blackboards != BT_NULL) ? blackboards[i] : BT_NULL;
+      results[i] = (run.inst->status != BT_NULL) ? bt_flat_run_threaded(&run) : BT_ERROR;
+    }
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
@@ -0,0 +1,316 @@
+/*
+ * bt_image.c
+ *
+ * Writing, loading and verifying tree images. The node array in a file is
+ * exactly what the flat engine reads, so loading is a header check; the
+ * linear structural check lives in bt_image_verify() for callers that do not
+ * trust the file.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bt_image.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bt_internal.h"
+
+/* ===== Internal constants ===== */
+
+#define BT_IMAGE_ALIGN (16U)                  /* Alignment of the node array */
+#define BT_IMAGE_FNV_OFFSET (2166136261U)     /* FNV-1a 32-bit offset basis */
+#define BT_IMAGE_FNV_PRIME (16777619U)        /* FNV-1a 32-bit prime */
+#define BT_IMAGE_PARALLEL_SLOTS ((uint16_t)5U) /* As in bt_flat.c */
+
+_Static_assert(sizeof(bt_image_header_t) == 32U, "bt_image_header_t must be 32 bytes");
+_Static_assert(sizeof(bt_image_node_t) == 16U, "bt_image_node_t must be 16 bytes");
+_Static_assert((sizeof(bt_image_header_t) % BT_IMAGE_ALIGN) == 0U, "nodes must stay aligned");
+
+/* ===== Internal helpers ===== */
+
+/* Images are stored little-endian and used in place. */
+static bool bt_image_host_ok(void) {
+  const uint16_t probe = 1U;
+  uint8_t first = 0U;
+
+  (void)memcpy(&first, &probe, 1U);
+  return first == 1U;
+}
+
+/* Continue an FNV-1a hash over n bytes. */
+static uint32_t bt_image_fnv(uint32_t hash, const void* data, size_t n) {
+  const uint8_t* p = (const uint8_t*)data;
+  uint32_t h = hash;
+  size_t i;
+
+  for (i = 0U; i < n; i++) {
+    h ^= p[i];
+    h *= BT_IMAGE_FNV_PRIME;
+  }
+
+  return h;
+}
+
+/* Binding id for a source node.
+ * Returns:
+ *   - BT_FLAT_NONE when the node needs no binding (composite without hooks)
+ *   - the first matching binding, or binding_count when none matches
+ */
+static uint16_t bt_image_ref(const bt_node_t* src, const bt_node_t bindings[], uint16_t binding_count) {
+  uint16_t ref = BT_FLAT_NONE;
+
+  if ((src->tick != BT_NULL) || (src->on_enter != BT_NULL) || (src->on_exit != BT_NULL)) {
+    ref = UINT16_ZERO;
+    while ((ref < binding_count) &&
+           ((bindings[ref].tick != src->tick) || (bindings[ref].on_enter != src->on_enter) ||
+            (bindings[ref].on_exit != src->on_exit) || (bindings[ref].user_data != src->user_data))) {
+      ref++;
+    }
+  } else {
+    /* Nothing to bind */
+  }
+
+  return ref;
+}
+
+/* Image entry for compiled node i.
+ * Returns:
+ *   - true when the node needs no binding or has a matching one
+ */
+static bool bt_image_entry(const bt_flat_tree_t* def, uint16_t i, const bt_node_t bindings[], uint16_t binding_count,
+                           bt_image_node_t* node) {
+  const bt_node_t* src = def->nodes[i].src;
+
+  (void)memset(node, 0, sizeof(*node));
+  node->link = def->nodes[i].link;
+  node->ref = bt_image_ref(src, bindings, binding_count);
+  if (node->link.type == (uint8_t)BT_PARALLEL) {
+    node->success_threshold = (uint8_t)bt_parallel_of(src)->success_threshold; /* Checked by bt_compile() */
+    node->failure_threshold = (uint8_t)bt_parallel_of(src)->failure_threshold;
+    node->children = (uint8_t)src->children_count;
+  } else {
+    /* Thresholds only apply to PARALLEL */
+  }
+
+  return (node->ref == BT_FLAT_NONE) || (node->ref < binding_count);
+}
+
+/* Check node i of a loaded image against its parent and siblings.
+ * Parameters:
+ *   - def: loaded image
+ *   - i: node index
+ *   - slots: in: the cursor slot bt_compile() would give node i, out: the next one
+ * Returns:
+ *   - true when node i is consistent
+ */
+static bool bt_image_node_ok(const bt_flat_tree_t* def, uint16_t i, uint16_t* slots) {
+  const bt_image_node_t* node = &def->image[i];
+  const bt_flat_link_t* link = &node->link;
+  const bool leaf = (link->type == (uint8_t)BT_ACTION) || (link->type == (uint8_t)BT_CONDITION);
+  uint16_t children = UINT16_ZERO;
+  uint16_t c = (uint16_t)(i + UINT16_ONE);
+  bool ok = (link->next > i) && (link->next <= def->count) && (node->reserved[0] == 0U) &&
+            (node->reserved[1] == 0U) && (node->reserved[2] == 0U) &&
+            ((node->ref == BT_FLAT_NONE) || (node->ref < def->binding_count));
+
+  /* Placement under the parent */
+  if (i == UINT16_ZERO) {
+    ok = ok && (link->parent == BT_FLAT_NONE) && (link->next == def->count);
+  } else {
+    ok = ok && (link->parent < i) && (link->next <= def->image[link->parent].link.next);
+  }
+
+  /* Children: i + 1, then each one's next, up to next */
+  while (ok && (c < link->next)) {
+    ok = (def->image[c].link.parent == i) && (def->image[c].link.next > c) &&
+         (def->image[c].link.ordinal == ((children < 0xFFU) ? (uint8_t)children : 0xFFU));
+    c = def->image[c].link.next;
+    children++;
+  }
+  ok = ok && (c == link->next);
+
+  if (ok && leaf) {
+    ok = (children == UINT16_ZERO) && (link->slot == BT_FLAT_NONE) && (node->ref != BT_FLAT_NONE) &&
+         (def->bindings[node->ref].tick != BT_NULL) && (def->bindings[node->ref].ext == BT_NULL);
+  } else if (ok) {
+    const uint16_t width = (link->type == (uint8_t)BT_PARALLEL) ? BT_IMAGE_PARALLEL_SLOTS : UINT16_ONE;
+
+    switch ((bt_node_type_t)link->type) {
+      case BT_SEQUENCE:
+      case BT_SELECTOR:
+        ok = true;
+        break;
+      case BT_INVERTER:
+        ok = (children == UINT16_ONE);
+        break;
+      case BT_PARALLEL:
+        ok = (children <= BT_PARALLEL_MAX_CHILDREN) && (node->children == children) &&
+             (node->success_threshold >= 1U) && (node->success_threshold <= children) &&
+             (node->failure_threshold >= 1U) && (node->failure_threshold <= children);
+        break;
+      default:
+        ok = false;
+        break;
+    }
+    ok = ok && (link->slot == *slots) && ((uint32_t)*slots + width <= def->slots);
+    *slots = (uint16_t)(*slots + width);
+  } else {
+    /* Already rejected */
+  }
+
+  return ok;
+}
+
+/* ===== Public API ===== */
+
+bt_status_t bt_image_write(FILE* out, const bt_flat_tree_t* def, const bt_node_t bindings[], uint16_t binding_count) {
+  bt_status_t result = BT_ERROR;
+
+  if ((out != BT_NULL) && (def != BT_NULL) && (def->nodes != BT_NULL) && (def->count > UINT16_ZERO) &&
+      ((bindings != BT_NULL) || (binding_count == UINT16_ZERO)) && bt_image_host_ok()) {
+    bt_image_header_t header;
+    uint32_t hash = BT_IMAGE_FNV_OFFSET;
+    uint16_t used = UINT16_ZERO;
+    uint16_t i;
+    bool ok = true;
+
+    /* First pass: bindings and checksum, so the header can go first */
+    for (i = UINT16_ZERO; ok && (i < def->count); i++) {
+      bt_image_node_t node;
+
+      ok = bt_image_entry(def, i, bindings, binding_count, &node);
+      used = (ok && (node.ref != BT_FLAT_NONE) && (node.ref >= used)) ? (uint16_t)(node.ref + UINT16_ONE) : used;
+      hash = bt_image_fnv(hash, &node, sizeof(node));
+    }
+
+    if (ok) {
+      (void)memset(&header, 0, sizeof(header));
+      (void)memcpy(header.magic, BT_IMAGE_MAGIC, sizeof(BT_IMAGE_MAGIC));
+      header.version = BT_IMAGE_VERSION;
+      header.header_size = (uint16_t)sizeof(bt_image_header_t);
+      header.node_size = (uint16_t)sizeof(bt_image_node_t);
+      header.count = def->count;
+      header.slots = def->slots;
+      header.bindings = used;
+      header.checksum = hash;
+      ok = (fwrite(&header, sizeof(header), 1U, out) == 1U);
+    }
+
+    /* Second pass: the nodes */
+    for (i = UINT16_ZERO; ok && (i < def->count); i++) {
+      bt_image_node_t node;
+
+      (void)bt_image_entry(def, i, bindings, binding_count, &node);
+      ok = (fwrite(&node, sizeof(node), 1U, out) == 1U);
+    }
+
+    result = ok ? BT_SUCCESS : BT_ERROR;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_image_load(const void* data, size_t size, const bt_node_t bindings[], uint16_t binding_count,
+                          bt_flat_tree_t* def) {
+  bt_status_t result = BT_ERROR;
+  const bt_image_header_t* header = (const bt_image_header_t*)data;
+
+  if ((data != BT_NULL) && (def != BT_NULL) && bt_image_host_ok() && (((uintptr_t)data % BT_IMAGE_ALIGN) == 0U) &&
+      (size >= sizeof(bt_image_header_t)) && (memcmp(header->magic, BT_IMAGE_MAGIC, sizeof(BT_IMAGE_MAGIC)) == 0) &&
+      (header->version == BT_IMAGE_VERSION) && (header->header_size == sizeof(bt_image_header_t)) &&
+      (header->node_size == sizeof(bt_image_node_t)) && (header->count > UINT16_ZERO) &&
+      (header->count <= BT_FLAT_MAX_NODES) &&
+      (size >= (sizeof(bt_image_header_t) + ((size_t)header->count * sizeof(bt_image_node_t)))) &&
+      (header->bindings <= binding_count) && ((bindings != BT_NULL) || (binding_count == UINT16_ZERO))) {
+    def->nodes = BT_NULL;
+    def->count = header->count;
+    def->slots = header->slots;
+    def->image = (const bt_image_node_t*)(const void*)((const uint8_t*)data + sizeof(bt_image_header_t));
+    def->bindings = bindings;
+    def->binding_count = binding_count;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_image_verify(const bt_flat_tree_t* def) {
+  bt_status_t result = BT_ERROR;
+
+  if ((def != BT_NULL) && (def->image != BT_NULL) && (def->count > UINT16_ZERO)) {
+    const bt_image_header_t* header =
+        (const bt_image_header_t*)(const void*)((const uint8_t*)def->image - sizeof(bt_image_header_t));
+    uint16_t slots = UINT16_ZERO;
+    uint16_t i;
+    bool ok = (bt_image_fnv(BT_IMAGE_FNV_OFFSET, def->image, (size_t)def->count * sizeof(bt_image_node_t)) ==
+               header->checksum);
+
+    for (i = UINT16_ZERO; ok && (i < def->count); i++) {
+      ok = bt_image_node_ok(def, i, &slots);
+    }
+
+    result = (ok && (slots == def->slots)) ? BT_SUCCESS : BT_ERROR;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_image_open(const char* path, bt_image_map_t* map, const bt_node_t bindings[], uint16_t binding_count,
+                          bt_flat_tree_t* def) {
+  bt_status_t result = BT_ERROR;
+  int fd = -1;
+
+  if ((path != BT_NULL) && (map != BT_NULL)) {
+    struct stat st;
+
+    map->base = BT_NULL;
+    map->size = 0U;
+    fd = open(path, O_RDONLY);
+
+    if ((fd >= 0) && (fstat(fd, &st) == 0) && (st.st_size > 0)) {
+      void* base = mmap(BT_NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (base != MAP_FAILED) {
+        result = bt_image_load(base, (size_t)st.st_size, bindings, binding_count, def);
+        if (result == BT_SUCCESS) {
+          map->base = base;
+          map->size = (size_t)st.st_size;
+        } else {
+          (void)munmap(base, (size_t)st.st_size);
+        }
+      } else {
+        result = BT_ERROR;
+      }
+    } else {
+      result = BT_ERROR;
+    }
+
+    if (fd >= 0) {
+      (void)close(fd); /* The mapping stays valid */
+    }
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+void bt_image_close(bt_image_map_t* map) {
+  if ((map != BT_NULL) && (map->base != BT_NULL)) {
+    (void)munmap(map->base, map->size);
+    map->base = BT_NULL;
+    map->size = 0U;
+  } else {
+    /* Nothing mapped */
+  }
+}
@@ -0,0 +1,172 @@
+/*
+ * bt_internal.h
+ *
+ * Private helpers shared by the tick engines (recursive core, compiled
+ * flat tree, ...). Not part of the public API; do not install.
+ */
+
+#ifndef C_BEHAVIOR_TREE_INTERNAL_H
+#define C_BEHAVIOR_TREE_INTERNAL_H
+
+#include "bt.h"
+#include "bt_timer.h"
+#include "bt_trace.h"
+
+/* ===== Internal constants ===== */
+#define UINT16_ZERO ((uint16_t)0)
+#define UINT16_ONE ((uint16_t)1)
+
+/* Call the node's on_enter hook if it exists.
+ * Parameters:
+ *   - node: pointer to the node (may be NULL). If NULL or no hook set, nothing happens.
+ */
+static inline void bt_call_enter(bt_node_t* node) {
+  if ((node != BT_NULL) && (node->on_enter != BT_NULL)) {
+    node->on_enter(node);
+  } else {
+    /* No action */
+  }
+}
+
+/* Call the node's on_exit hook if it exists.
+ * Parameters:
+ *   - node: pointer to the node (may be NULL). If NULL or no hook set, nothing happens.
+ */
+static inline void bt_call_exit(bt_node_t* node) {
+  if ((node != BT_NULL) && (node->on_exit != BT_NULL)) {
+    node->on_exit(node);
+  } else {
+    /* No action */
+  }
+}
+
+/* Store a node's status, tracing the transition (see bt_trace.h). */
+static inline void bt_set_status(bt_node_t* node, bt_status_t status) {
+  bt_trace_emit(node->id, node->status, status);
+  node->status = status;
+}
+
+/* True for SUCCESS/FAILURE/ERROR, i.e. states that fire on_exit. */
+static inline bool bt_is_terminal(bt_status_t status) {
+  return (status == BT_SUCCESS) || (status == BT_FAILURE) || (status == BT_ERROR);
+}
+
+/* Number of set bits in a PARALLEL bitset. */
+static inline uint16_t bt_popcount32(uint32_t mask) {
+  uint32_t rest = mask;
+  uint16_t count = UINT16_ZERO;
+
+  while (rest != 0U) {
+    rest &= rest - 1U; /* Clear the lowest set bit */
+    count++;
+  }
+
+  return count;
+}
+
+/* State of a PARALLEL node (see bt_set_parallel()); NULL when none is attached. */
+static inline bt_parallel_t* bt_parallel_of(const bt_node_t* node) { return (bt_parallel_t*)node->ext; }
+
+/* Check PARALLEL thresholds against a child count. */
+static inline bool bt_parallel_policy_ok(uint16_t children, uint16_t success_threshold, uint16_t failure_threshold) {
+  return (children <= BT_PARALLEL_MAX_CHILDREN) && (success_threshold >= UINT16_ONE) &&
+         (success_threshold <= children) && (failure_threshold >= UINT16_ONE) && (failure_threshold <= children);
+}
+
+/* Check a PARALLEL node's shape, state and thresholds. */
+static inline bool bt_parallel_ok(const bt_node_t* node) {
+  const bt_parallel_t* par = bt_parallel_of(node);
+
+  return (par != BT_NULL) &&
+         bt_parallel_policy_ok(node->children_count, par->success_threshold, par->failure_threshold);
+}
+
+/* Decide a PARALLEL node's status from its bitsets.
+ * Parameters:
+ *   - children: number of children
+ *   - success_threshold / failure_threshold: the node's thresholds
+ *   - done / success: bitsets of finished / succeeded children
+ * Returns:
+ *   - BT_SUCCESS once success_threshold children succeeded
+ *   - BT_FAILURE once failure_threshold children failed, or when too few
+ *     children are left to reach success_threshold
+ *   - BT_RUNNING otherwise
+ */
+static inline bt_status_t bt_parallel_decide_with(uint16_t children, uint16_t success_threshold,
+                                                  uint16_t failure_threshold, uint32_t done, uint32_t success) {
+  const uint16_t succeeded = bt_popcount32(success);
+  const uint16_t failed = bt_popcount32(done & ~success);
+  bt_status_t result = BT_RUNNING;
+
+  if (succeeded >= success_threshold) {
+    result = BT_SUCCESS;
+  } else if ((failed >= failure_threshold) || ((uint16_t)(children - failed) < success_threshold)) {
+    result = BT_FAILURE;
+  } else {
+    result = BT_RUNNING;
+  }
+
+  return result;
+}
+
+/* Decide a wired PARALLEL node's status (state attached); see bt_parallel_decide_with(). */
+static inline bt_status_t bt_parallel_decide(const bt_node_t* node, uint32_t done, uint32_t success) {
+  const bt_parallel_t* par = bt_parallel_of(node);
+
+  return bt_parallel_decide_with(node->children_count, par->success_threshold, par->failure_threshold, done, success);
+}
+
+/* bt_halt() that also cancels the parked anchors met on the walk in timers
+ * (NULL: leave anchors alone), see bt_exec_halt().
+ */
+uint16_t bt_halt_in(bt_node_t* node, bt_timer_wheel_t* timers);
+
+/* Halt the children of a settling PARALLEL that did not finish in its run
+ * (see bt_halt_in()), so that none of them is resumed mid-run when the
+ * parallel is entered again.
+ */
+static inline void bt_parallel_halt_rest(bt_node_t* node, bt_timer_wheel_t* timers) {
+  const uint32_t done = bt_parallel_of(node)->done_mask;
+  uint16_t i = UINT16_ZERO;
+
+  for (i = UINT16_ZERO; (i < node->children_count) && (i < BT_PARALLEL_MAX_CHILDREN); i++) {
+    if (((done & ((uint32_t)1U << i)) == 0U) && (node->children != BT_NULL)) {
+      (void)bt_halt_in(node->children[i], timers);
+    } else {
+      /* Finished in this run */
+    }
+  }
+}
+
+/* Tick a BT_ASYNC leaf whose tick callback is set.
+ * Returns:
+ *   - BT_ERROR when no operation state is attached (see bt_set_async())
+ *   - when the leaf is entered: the callback's status; BT_RUNNING leaves a new
+ *     operation pending under the next generation
+ *   - while it runs: BT_RUNNING until a completion was drained, then the
+ *     posted status
+ */
+static inline bt_status_t bt_async_step(bt_node_t* node) {
+  bt_async_op_t* const op = (bt_async_op_t*)node->ext;
+  bt_status_t result = BT_ERROR;
+
+  if (op == BT_NULL) {
+    result = BT_ERROR;
+  } else if (node->status != BT_RUNNING) {
+    op->gen++; /* Completions of earlier operations become stale */
+    op->result = BT_RUNNING;
+    result = node->tick(node);
+
+    if (result != BT_RUNNING) {
+      op->result = result; /* Finished synchronously: nothing pending */
+    } else {
+      /* Pending until bt_async_drain() delivers its completion */
+    }
+  } else {
+    result = op->result;
+  }
+
+  return result;
+}
+
+#endif /* C_BEHAVIOR_TREE_INTERNAL_H */
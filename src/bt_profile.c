@@ -0,0 +1,79 @@
+/*
+ * bt_profile.c
+ *
+ * Profile tables. The counting itself happens in the recursive dispatcher
+ * (bt.c) through bt_profile_record(); this file holds setup, snapshots and
+ * clock calibration.
+ */
+
+#include "bt_profile.h"
+
+#include <string.h>
+
+#include "bt_internal.h"
+
+/* ===== Internal constants ===== */
+
+#define BT_PROFILE_MIN_CALIBRATION (1000000ULL) /* 1 ms */
+
+/* ===== Thread state ===== */
+
+_Thread_local bt_profile_t* bt_profile_tls = BT_NULL;
+
+/* ===== Public API ===== */
+
+bt_status_t bt_profile_init(bt_profile_t* prof, bt_profile_node_t nodes[], uint16_t count) {
+  bt_status_t result = BT_ERROR;
+
+  if ((prof != BT_NULL) && (nodes != BT_NULL) && (count > UINT16_ZERO)) {
+    prof->nodes = nodes;
+    prof->count = count;
+    bt_profile_reset(prof);
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+void bt_profile_attach(bt_profile_t* prof) { bt_profile_tls = prof; }
+
+uint16_t bt_profile_snapshot(const bt_profile_t* prof, bt_profile_node_t out[], uint16_t max) {
+  uint16_t count = UINT16_ZERO;
+
+  if ((prof != BT_NULL) && (out != BT_NULL)) {
+    count = (max < prof->count) ? max : prof->count;
+    (void)memcpy(out, prof->nodes, (size_t)count * sizeof(out[0]));
+  } else {
+    count = UINT16_ZERO;
+  }
+
+  return count;
+}
+
+void bt_profile_reset(bt_profile_t* prof) {
+  if ((prof != BT_NULL) && (prof->nodes != BT_NULL)) {
+    (void)memset(prof->nodes, 0, (size_t)prof->count * sizeof(prof->nodes[0]));
+    prof->child_time = 0U;
+    prof->ns0 = bt_trace_clock_ns();
+    prof->clock0 = bt_trace_clock();
+  } else {
+    /* No action */
+  }
+}
+
+uint64_t bt_profile_hz(const bt_profile_t* prof) {
+  uint64_t hz = 0U;
+
+  if (prof != BT_NULL) {
+    const uint64_t ticks = bt_trace_clock() - prof->clock0;
+    const uint64_t ns = bt_trace_clock_ns() - prof->ns0;
+
+    hz = (ns >= BT_PROFILE_MIN_CALIBRATION) ? (uint64_t)(((double)ticks * 1e9) / (double)ns) : 0U;
+  } else {
+    hz = 0U;
+  }
+
+  return hz;
+}
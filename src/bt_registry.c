@@ -0,0 +1,104 @@
+/*
+ * bt_registry.c
+ *
+ * Open-addressing (linear probing) name registry; see bt_registry.h.
+ */
+
+#include "bt_registry.h"
+
+#include <string.h>
+
+#include "bt_internal.h"
+
+/* ===== Internal constants ===== */
+
+#define BT_REGISTRY_FNV_OFFSET (2166136261U) /* FNV-1a 32-bit offset basis */
+#define BT_REGISTRY_FNV_PRIME (16777619U)    /* FNV-1a 32-bit prime */
+
+/* ===== Internal helpers ===== */
+
+/* Slot holding name, or the free slot where it would go. */
+static uint32_t bt_registry_slot(const bt_registry_t* reg, const char* name, size_t len, uint32_t hash) {
+  uint32_t i = hash & reg->mask;
+
+  while ((reg->entries[i].name != BT_NULL) &&
+         ((reg->entries[i].hash != hash) || (reg->entries[i].len != len) ||
+          (memcmp(reg->entries[i].name, name, len) != 0))) {
+    i = (i + 1U) & reg->mask;
+  }
+
+  return i;
+}
+
+/* ===== Public API ===== */
+
+uint32_t bt_registry_hash(const char* name, size_t len) {
+  uint32_t hash = BT_REGISTRY_FNV_OFFSET;
+  size_t i;
+
+  for (i = 0U; i < len; i++) {
+    hash ^= (uint8_t)name[i];
+    hash *= BT_REGISTRY_FNV_PRIME;
+  }
+
+  return hash;
+}
+
+bt_status_t bt_registry_init(bt_registry_t* reg, bt_registry_entry_t entries[], uint32_t capacity) {
+  bt_status_t result = BT_ERROR;
+
+  if ((reg != BT_NULL) && (entries != BT_NULL) && (capacity >= 2U) && ((capacity & (capacity - 1U)) == 0U)) {
+    (void)memset(entries, 0, (size_t)capacity * sizeof(entries[0]));
+    reg->entries = entries;
+    reg->mask = capacity - 1U;
+    reg->count = 0U;
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_registry_add(bt_registry_t* reg, const char* name, bt_node_type_t type, bt_tick_fn tick,
+                            void* user_data) {
+  bt_status_t result = BT_ERROR;
+  const size_t len = (name != BT_NULL) ? strlen(name) : 0U;
+
+  if ((reg != BT_NULL) && (reg->entries != BT_NULL) && (len > 0U) && (len <= 0xFFFFU) && (tick != BT_NULL) &&
+      ((type == BT_ACTION) || (type == BT_CONDITION) || (type == BT_ASYNC)) && (reg->count < reg->mask)) {
+    const uint32_t hash = bt_registry_hash(name, len);
+    bt_registry_entry_t* entry = &reg->entries[bt_registry_slot(reg, name, len, hash)];
+
+    if (entry->name == BT_NULL) {
+      entry->name = name;
+      entry->hash = hash;
+      entry->len = (uint16_t)len;
+      entry->type = (uint8_t)type;
+      entry->tick = tick;
+      entry->user_data = user_data;
+      reg->count++;
+      result = BT_SUCCESS;
+    } else {
+      result = BT_ERROR; /* Already registered */
+    }
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+const bt_registry_entry_t* bt_registry_find(const bt_registry_t* reg, const char* name, size_t len) {
+  const bt_registry_entry_t* entry = BT_NULL;
+
+  if ((reg != BT_NULL) && (reg->entries != BT_NULL) && (name != BT_NULL)) {
+    const bt_registry_entry_t* slot = &reg->entries[bt_registry_slot(reg, name, len, bt_registry_hash(name, len))];
+
+    entry = (slot->name != BT_NULL) ? slot : BT_NULL;
+  } else {
+    entry = BT_NULL;
+  }
+
+  return entry;
+}
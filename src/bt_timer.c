@@ -0,0 +1,358 @@
+/*
+ * bt_timer.c
+ *
+ * Hierarchical timer wheel. A node parked with delay d (ms) goes to the
+ * lowest level whose span covers d, in the slot selected by the matching bits
+ * of its expiry time. Every time the clock crosses a multiple of a level's
+ * slot width, the slot of the level above that starts there is cascaded:
+ * its nodes are re-placed relative to the new time and end up in a lower
+ * level. Level 0 slots are expired as the clock reaches them.
+ * Slot lists are doubly linked through the wheel's entry pool by index, so a
+ * node only stores the number of its entry.
+ */
+
+#include "bt_timer.h"
+
+#include "bt_internal.h"
+
+/* ===== Internal constants ===== */
+
+#define BT_TIMER_MASK (BT_TIMER_SLOTS - 1U)
+/* Longest delay the wheel resolves in one placement */
+#define BT_TIMER_SPAN (1UL << (BT_TIMER_BITS * BT_TIMER_LEVELS))
+
+/* ===== Internal helpers ===== */
+
+/* Entry of a parked node (its timer_entry is the index plus one). */
+static inline bt_timer_entry_t* bt_timer_entry(const bt_timer_wheel_t* wheel, const bt_node_t* node) {
+  return &wheel->entries[node->timer_entry - 1U];
+}
+
+/* Head of slot list `slot` (level * BT_TIMER_SLOTS + index). */
+static inline uint16_t* bt_timer_head(bt_timer_wheel_t* wheel, uint16_t slot) {
+  return &wheel->slots[slot / BT_TIMER_SLOTS][slot % BT_TIMER_SLOTS];
+}
+
+/* Push entry e at the head of a slot list. */
+static void bt_timer_link(bt_timer_wheel_t* wheel, uint16_t slot, uint16_t e) {
+  uint16_t* head = bt_timer_head(wheel, slot);
+
+  wheel->entries[e].next = *head;
+  wheel->entries[e].prev = BT_TIMER_NONE;
+  wheel->entries[e].slot = slot;
+  if (*head != BT_TIMER_NONE) {
+    wheel->entries[*head].prev = e;
+  }
+  *head = e;
+}
+
+/* Remove entry e from its slot list. */
+static void bt_timer_unlink(bt_timer_wheel_t* wheel, uint16_t e) {
+  const bt_timer_entry_t* entry = &wheel->entries[e];
+
+  if (entry->prev != BT_TIMER_NONE) {
+    wheel->entries[entry->prev].next = entry->next;
+  } else {
+    *bt_timer_head(wheel, entry->slot) = entry->next;
+  }
+  if (entry->next != BT_TIMER_NONE) {
+    wheel->entries[entry->next].prev = entry->prev;
+  }
+}
+
+/* Return entry e, already unlinked, to the free list and unpark its node. */
+static void bt_timer_release(bt_timer_wheel_t* wheel, uint16_t e) {
+  wheel->entries[e].node->timer_entry = UINT16_ZERO;
+  wheel->entries[e].node = BT_NULL;
+  wheel->entries[e].next = wheel->free;
+  wheel->free = e;
+  wheel->parked--;
+}
+
+/* Put entry e, whose node's anchor is not in the past, into its slot.
+ * Anchors further away than BT_TIMER_SPAN are placed at the end of the top
+ * level and re-placed when that slot is cascaded.
+ */
+static void bt_timer_place(bt_timer_wheel_t* wheel, uint16_t e) {
+  const bt_node_t* node = wheel->entries[e].node;
+  uint32_t delta = node->time_anchor_ms - wheel->now;
+  uint32_t expires = node->time_anchor_ms;
+  uint32_t level = 0U;
+
+  if (delta >= BT_TIMER_SPAN) {
+    delta = (uint32_t)(BT_TIMER_SPAN - 1UL);
+    expires = wheel->now + delta;
+  }
+
+  while ((level < (BT_TIMER_LEVELS - 1U)) && (delta >= (1UL << (BT_TIMER_BITS * (level + 1U))))) {
+    level++;
+  }
+
+  bt_timer_link(wheel, (uint16_t)((level * BT_TIMER_SLOTS) + ((expires >> (BT_TIMER_BITS * level)) & BT_TIMER_MASK)),
+                e);
+}
+
+/* Detach a whole slot list and return its first entry. */
+static uint16_t bt_timer_take(uint16_t* head) {
+  const uint16_t first = *head;
+
+  *head = BT_TIMER_NONE;
+  return first;
+}
+
+/* Re-place every entry of an upper-level slot relative to the current time. */
+static void bt_timer_cascade(bt_timer_wheel_t* wheel, uint32_t level, uint32_t index) {
+  uint16_t e = bt_timer_take(&wheel->slots[level][index]);
+
+  while (e != BT_TIMER_NONE) {
+    const uint16_t next = wheel->entries[e].next;
+
+    bt_timer_place(wheel, e);
+    e = next;
+  }
+}
+
+/* True when no node is parked in the given level. */
+static bool bt_timer_level_empty(const bt_timer_wheel_t* wheel, uint32_t level) {
+  uint32_t slot = 0U;
+
+  while ((slot < BT_TIMER_SLOTS) && (wheel->slots[level][slot] == BT_TIMER_NONE)) {
+    slot++;
+  }
+
+  return slot == BT_TIMER_SLOTS;
+}
+
+/* Latest time the clock can jump to without skipping an expiry or a cascade.
+ * Returns:
+ *   - the millisecond before the next occupied level 0 slot in the current
+ *     block, else the millisecond before the next boundary of the lowest
+ *     occupied level (wheel->now when the very next step has work)
+ */
+static uint32_t bt_timer_horizon(const bt_timer_wheel_t* wheel) {
+  const uint32_t cur = wheel->now & BT_TIMER_MASK;
+  uint32_t slot = cur + 1U;
+  uint32_t horizon = wheel->now;
+
+  while ((slot < BT_TIMER_SLOTS) && (wheel->slots[0][slot] == BT_TIMER_NONE)) {
+    slot++;
+  }
+
+  if (slot < BT_TIMER_SLOTS) {
+    horizon = wheel->now + (slot - cur) - 1U;
+  } else {
+    uint32_t level = 0U;
+
+    while ((level < (BT_TIMER_LEVELS - 1U)) && bt_timer_level_empty(wheel, level)) {
+      level++;
+    }
+    /* Level 0 nodes left belong to the next block: stop at this block's end */
+    horizon = wheel->now | ((uint32_t)(1UL << (BT_TIMER_BITS * (level > 0U ? level : 1U))) - 1U);
+  }
+
+  return horizon;
+}
+
+/* Earliest anchor in one slot list.
+ * Parameters:
+ *   - wheel: wheel owning the list
+ *   - e: first entry of the list (may be BT_TIMER_NONE)
+ *   - best: in/out: earliest delay from the wheel's time found so far
+ */
+static void bt_timer_min_delay(const bt_timer_wheel_t* wheel, uint16_t e, uint32_t* best) {
+  uint16_t it = e;
+
+  while (it != BT_TIMER_NONE) {
+    const uint32_t delay = wheel->entries[it].node->time_anchor_ms - wheel->now;
+
+    if (delay < *best) {
+      *best = delay;
+    }
+    it = wheel->entries[it].next;
+  }
+}
+
+/* Advance the clock by one millisecond.
+ * Returns:
+ *   - number of nodes that expired at the new time
+ */
+static uint32_t bt_timer_step(bt_timer_wheel_t* wheel) {
+  uint32_t expired = 0U;
+  uint32_t level = 1U;
+  bool carry = false;
+  uint16_t e = BT_TIMER_NONE;
+
+  wheel->now++;
+
+  /* Crossing a slot boundary of level n - 1 opens the next slot of level n */
+  carry = ((wheel->now & BT_TIMER_MASK) == 0U);
+  while (carry && (level < BT_TIMER_LEVELS)) {
+    const uint32_t index = (wheel->now >> (BT_TIMER_BITS * level)) & BT_TIMER_MASK;
+
+    bt_timer_cascade(wheel, level, index);
+    carry = (index == 0U);
+    level++;
+  }
+
+  e = bt_timer_take(&wheel->slots[0][wheel->now & BT_TIMER_MASK]);
+  while (e != BT_TIMER_NONE) {
+    const uint16_t next = wheel->entries[e].next;
+
+    wheel->entries[e].node->time_anchor_ms = 0U; /* Anchor reached: tick the node again */
+    bt_timer_release(wheel, e);
+    expired++;
+    e = next;
+  }
+
+  return expired;
+}
+
+/* ===== Public API ===== */
+
+bt_status_t bt_timer_init(bt_timer_wheel_t* wheel, bt_timer_entry_t entries[], uint16_t capacity, uint32_t now_ms) {
+  bt_status_t result = BT_ERROR;
+
+  if ((wheel != BT_NULL) && (entries != BT_NULL) && (capacity > UINT16_ZERO) && (capacity < BT_TIMER_NONE)) {
+    uint32_t level;
+    uint32_t slot;
+    uint16_t e;
+
+    for (level = 0U; level < BT_TIMER_LEVELS; level++) {
+      for (slot = 0U; slot < BT_TIMER_SLOTS; slot++) {
+        wheel->slots[level][slot] = BT_TIMER_NONE;
+      }
+    }
+    for (e = UINT16_ZERO; e < capacity; e++) {
+      entries[e].node = BT_NULL;
+      entries[e].next = (uint16_t)(e + UINT16_ONE);
+    }
+    entries[capacity - 1U].next = BT_TIMER_NONE;
+    wheel->entries = entries;
+    wheel->capacity = capacity;
+    wheel->free = UINT16_ZERO;
+    wheel->now = now_ms;
+    wheel->parked = 0U;
+    result = BT_SUCCESS;
+  } else {
+    /* No action */
+  }
+
+  return result;
+}
+
+/* Advance to now_ms; see bt_timer.h.
+ * Notes:
+ *   - Jumps over stretches where no slot expires or cascades, so the cost
+ *     depends on the number of occupied slots passed, not on elapsed time.
+ *   - A now_ms behind the wheel's clock is ignored.
+ */
+uint32_t bt_timer_advance(bt_timer_wheel_t* wheel, uint32_t now_ms) {
+  uint32_t expired = 0U;
+
+  if (wheel != BT_NULL) {
+    while ((wheel->parked > 0U) && ((int32_t)(now_ms - wheel->now) > 0)) {
+      const uint32_t horizon = bt_timer_horizon(wheel);
+
+      if ((int32_t)(now_ms - horizon) <= 0) {
+        wheel->now = now_ms; /* Nothing happens before now_ms */
+      } else {
+        wheel->now = horizon;
+        expired += bt_timer_step(wheel);
+      }
+    }
+
+    if ((int32_t)(now_ms - wheel->now) > 0) {
+      wheel->now = now_ms; /* Nothing left to expire on the way */
+    }
+  } else {
+    /* No action */
+  }
+
+  return expired;
+}
+
+/* Earliest parked anchor; see bt_timer.h.
+ * Behavior:
+ *   - In each level, slots are visited in expiry order starting after the
+ *     current one; the first occupied slot holds that level's earliest nodes.
+ *     Only that slot's list is scanned, so the cost is bounded by the number
+ *     of slots plus the nodes sharing those few slots.
+ */
+bool bt_timer_next_deadline(const bt_timer_wheel_t* wheel, uint32_t* deadline_ms) {
+  bool found = false;
+
+  if ((wheel != BT_NULL) && (deadline_ms != BT_NULL) && (wheel->parked > 0U)) {
+    uint32_t best = UINT32_MAX;
+    uint32_t level;
+
+    for (level = 0U; level < BT_TIMER_LEVELS; level++) {
+      const uint32_t cur = (wheel->now >> (BT_TIMER_BITS * level)) & BT_TIMER_MASK;
+      uint32_t k = 1U;
+
+      /* k == BT_TIMER_SLOTS wraps to the current slot, which holds the next revolution */
+      while ((k <= BT_TIMER_SLOTS) && (wheel->slots[level][(cur + k) & BT_TIMER_MASK] == BT_TIMER_NONE)) {
+        k++;
+      }
+      if (k <= BT_TIMER_SLOTS) {
+        bt_timer_min_delay(wheel, wheel->slots[level][(cur + k) & BT_TIMER_MASK], &best);
+      }
+    }
+
+    *deadline_ms = wheel->now + best;
+    found = true;
+  } else {
+    found = false;
+  }
+
+  return found;
+}
+
+/* Park a node; see bt_timer.h.
+ * Notes:
+ *   - The node takes the first free entry of the pool; with none left it is
+ *     not parked and keeps its anchor.
+ */
+bool bt_timer_park(bt_timer_wheel_t* wheel, bt_node_t* node) {
+  bool parked = false;
+
+  if ((wheel == BT_NULL) || (node == BT_NULL)) {
+    parked = false;
+  } else if (node->timer_entry != UINT16_ZERO) {
+    parked = true; /* Still sleeping */
+  } else if (node->time_anchor_ms == 0U) {
+    parked = false;
+  } else if ((int32_t)(node->time_anchor_ms - wheel->now) <= 0) {
+    node->time_anchor_ms = 0U; /* Due already: run now */
+    parked = false;
+  } else if (wheel->free == BT_TIMER_NONE) {
+    parked = false; /* Pool exhausted */
+  } else {
+    const uint16_t e = wheel->free;
+
+    wheel->free = wheel->entries[e].next;
+    wheel->entries[e].node = node;
+    node->timer_entry = (uint16_t)(e + UINT16_ONE);
+    bt_timer_place(wheel, e);
+    wheel->parked++;
+    parked = true;
+  }
+
+  return parked;
+}
+
+/* Cancel a parked node; see bt_timer.h.
+ * Notes:
+ *   - A node parked in another wheel (its entry does not point back at it)
+ *     is left alone.
+ */
+void bt_timer_cancel(bt_timer_wheel_t* wheel, bt_node_t* node) {
+  if ((wheel != BT_NULL) && (node != BT_NULL) && (node->timer_entry != UINT16_ZERO) &&
+      (node->timer_entry <= wheel->capacity) && (bt_timer_entry(wheel, node)->node == node)) {
+    const uint16_t e = (uint16_t)(node->timer_entry - 1U);
+
+    bt_timer_unlink(wheel, e);
+    bt_timer_release(wheel, e);
+  } else {
+    /* Not parked here */
+  }
+}
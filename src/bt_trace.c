@@ -0,0 +1,225 @@
+/*
+ * bt_trace.c
+ *
+ * Trace rings and the trace file format. The write side (bt_trace_emit) is
+ * inline in bt_trace.h; this file holds what runs outside the tick: ring
+ * setup, consistent snapshots, clock calibration and file I/O.
+ *
+ * Snapshot protocol: the owner fills the slot of position head, then
+ * publishes head + 1 (release); before touching the next slot it issues a
+ * release fence. A reader loads head (acquire), copies slots, issues an
+ * acquire fence and loads head again: if the owner overwrote a copied slot,
+ * the second load sees at least the position it was rewriting, so every
+ * position below head2 - capacity + 1 may be torn and is dropped.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bt_trace.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "bt_internal.h"
+
+/* ===== Internal constants ===== */
+
+#define BT_TRACE_MAGIC "BTTRACE"               /* Written with its terminating NUL */
+#define BT_TRACE_HEADER_BYTES (32U)            /* magic[8] version tag hz count */
+#define BT_TRACE_REC_BYTES (16U)               /* time seq node from to */
+#define BT_TRACE_MIN_CALIBRATION (1000000ULL)  /* 1 ms */
+
+/* ===== Thread state ===== */
+
+_Thread_local bt_trace_ring_t* bt_trace_tls = BT_NULL;
+
+/* ===== Internal helpers ===== */
+
+/* Store v as n little-endian bytes at p. */
+static void bt_trace_put(uint8_t* p, uint64_t v, uint32_t n) {
+  uint32_t i;
+
+  for (i = 0U; i < n; i++) {
+    p[i] = (uint8_t)(v >> (8U * i));
+  }
+}
+
+/* Load n little-endian bytes at p. */
+static uint64_t bt_trace_get(const uint8_t* p, uint32_t n) {
+  uint64_t v = 0U;
+  uint32_t i;
+
+  for (i = 0U; i < n; i++) {
+    v |= (uint64_t)p[i] << (8U * i);
+  }
+
+  return v;
+}
+
+/* ===== Public API ===== */
+
+uint64_t bt_trace_clock_ns(void) {
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+bt_status_t bt_trace_init(bt_trace_ring_t* ring, bt_trace_slot_t slots[], uint32_t capacity, uint32_t tag) {
+  bt_status_t result = BT_ERROR;
+
+  if ((ring != BT_NULL) && (slots != BT_NULL) && (capacity > 0U) && ((capacity & (capacity - 1U)) == 0U)) {
+    uint32_t i;
+
+    for (i = 0U; i < capacity; i++) {
+      atomic_init(&slots[i].time, 0U);
+      atomic_init(&slots[i].info, 0U);
+    }
+    ring->slots = slots;
+    ring->mask = capacity - 1U;
+    ring->tag = tag;
+    ring->ns0 = bt_trace_clock_ns();
+    ring->clock0 = bt_trace_clock();
+    atomic_init(&ring->head, 0U);
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+void bt_trace_attach(bt_trace_ring_t* ring) { bt_trace_tls = ring; }
+
+/* Snapshot the newest records; see bt_trace.h and the protocol above. */
+uint32_t bt_trace_snapshot(const bt_trace_ring_t* ring, bt_trace_rec_t out[], uint32_t max) {
+  uint32_t count = 0U;
+
+  if ((ring != BT_NULL) && (out != BT_NULL) && (max > 0U)) {
+    const uint64_t capacity = (uint64_t)ring->mask + 1U;
+    const uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t n = (head < capacity) ? head : capacity;
+    uint64_t first = 0U;
+    uint64_t safe = 0U;
+    uint64_t k;
+
+    n = (n < (uint64_t)max) ? n : (uint64_t)max;
+    first = head - n;
+
+    for (k = 0U; k < n; k++) {
+      const bt_trace_slot_t* slot = &ring->slots[(first + k) & ring->mask];
+      const uint64_t info = atomic_load_explicit(&slot->info, memory_order_relaxed);
+
+      out[k].time = atomic_load_explicit(&slot->time, memory_order_relaxed);
+      out[k].seq = (uint32_t)(info >> 32U);
+      out[k].node = (uint16_t)info;
+      out[k].from = (uint8_t)(info >> 16U);
+      out[k].to = (uint8_t)(info >> 24U);
+    }
+
+    atomic_thread_fence(memory_order_acquire);
+    safe = atomic_load_explicit(&ring->head, memory_order_relaxed) + 1U;
+    safe = (safe > capacity) ? (safe - capacity) : 0U; /* Oldest position that cannot be torn */
+
+    if (safe > first) {
+      const uint64_t torn = ((safe - first) < n) ? (safe - first) : n;
+
+      (void)memmove(out, &out[torn], (size_t)(n - torn) * sizeof(out[0]));
+      n -= torn;
+    } else {
+      /* Nothing overwritten while copying */
+    }
+    count = (uint32_t)n;
+  } else {
+    count = 0U;
+  }
+
+  return count;
+}
+
+uint64_t bt_trace_hz(const bt_trace_ring_t* ring) {
+  uint64_t hz = 0U;
+
+  if (ring != BT_NULL) {
+    const uint64_t ticks = bt_trace_clock() - ring->clock0;
+    const uint64_t ns = bt_trace_clock_ns() - ring->ns0;
+
+    hz = (ns >= BT_TRACE_MIN_CALIBRATION) ? (uint64_t)(((double)ticks * 1e9) / (double)ns) : 0U;
+  } else {
+    hz = 0U;
+  }
+
+  return hz;
+}
+
+bt_status_t bt_trace_write(FILE* out, uint32_t tag, uint64_t hz, const bt_trace_rec_t recs[], uint32_t count) {
+  bt_status_t result = BT_ERROR;
+
+  if ((out != BT_NULL) && ((recs != BT_NULL) || (count == 0U))) {
+    uint8_t header[BT_TRACE_HEADER_BYTES];
+    uint32_t i = 0U;
+    bool ok = true;
+
+    (void)memcpy(header, BT_TRACE_MAGIC, sizeof(BT_TRACE_MAGIC));
+    bt_trace_put(&header[8], BT_TRACE_VERSION, 4U);
+    bt_trace_put(&header[12], tag, 4U);
+    bt_trace_put(&header[16], hz, 8U);
+    bt_trace_put(&header[24], count, 8U);
+    ok = (fwrite(header, sizeof(header), 1U, out) == 1U);
+
+    while (ok && (i < count)) {
+      uint8_t rec[BT_TRACE_REC_BYTES];
+
+      bt_trace_put(&rec[0], recs[i].time, 8U);
+      bt_trace_put(&rec[8], recs[i].seq, 4U);
+      bt_trace_put(&rec[12], recs[i].node, 2U);
+      rec[14] = recs[i].from;
+      rec[15] = recs[i].to;
+      ok = (fwrite(rec, sizeof(rec), 1U, out) == 1U);
+      i++;
+    }
+
+    result = ok ? BT_SUCCESS : BT_ERROR;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_trace_read_header(FILE* in, uint32_t* tag, uint64_t* hz, uint64_t* count) {
+  bt_status_t result = BT_ERROR;
+  uint8_t header[BT_TRACE_HEADER_BYTES];
+
+  if ((in != BT_NULL) && (tag != BT_NULL) && (hz != BT_NULL) && (count != BT_NULL) &&
+      (fread(header, sizeof(header), 1U, in) == 1U) &&
+      (memcmp(header, BT_TRACE_MAGIC, sizeof(BT_TRACE_MAGIC)) == 0) &&
+      (bt_trace_get(&header[8], 4U) == BT_TRACE_VERSION)) {
+    *tag = (uint32_t)bt_trace_get(&header[12], 4U);
+    *hz = bt_trace_get(&header[16], 8U);
+    *count = bt_trace_get(&header[24], 8U);
+    result = BT_SUCCESS;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+bt_status_t bt_trace_read_rec(FILE* in, bt_trace_rec_t* rec) {
+  bt_status_t result = BT_FAILURE;
+  uint8_t raw[BT_TRACE_REC_BYTES];
+
+  if ((in != BT_NULL) && (rec != BT_NULL) && (fread(raw, sizeof(raw), 1U, in) == 1U)) {
+    rec->time = bt_trace_get(&raw[0], 8U);
+    rec->seq = (uint32_t)bt_trace_get(&raw[8], 4U);
+    rec->node = (uint16_t)bt_trace_get(&raw[12], 2U);
+    rec->from = raw[14];
+    rec->to = raw[15];
+    result = BT_SUCCESS;
+  } else {
+    result = BT_FAILURE;
+  }
+
+  return result;
+}
@@ -0,0 +1,648 @@
+/*
+ * bt_xml.c
+ *
+ * Single-pass XML tree loader; see bt_xml.h.
+ * The arena is used from both ends: nodes, finished child arrays and PARALLEL
+ * and BT_ASYNC state are allocated upwards from the start, while the children of the elements still
+ * open are pushed as pointers downwards from the end. When a composite
+ * closes, its children are the top of that stack and are copied into a child
+ * array of exactly the right size, so no node is ever moved or resized.
+ */
+
+#include "bt_xml.h"
+
+#include <string.h>
+
+#include "bt_async.h"
+#include "bt_internal.h"
+
+/* ===== Internal constants ===== */
+
+#define BT_XML_ALIGN (sizeof(void*)) /* Alignment of every arena allocation */
+#define BT_XML_MAX_NODES (0xFFFFU)   /* Ids are uint16_t */
+#define BT_XML_ALL (-1)              /* success_count/failure_count: every child */
+/* Arena bytes of one bt_parallel_t, rounded up to keep allocations aligned */
+#define BT_XML_PARALLEL_BYTES (((sizeof(bt_parallel_t) + BT_XML_ALIGN - 1U) / BT_XML_ALIGN) * BT_XML_ALIGN)
+/* Arena bytes of one bt_async_op_t, likewise */
+#define BT_XML_ASYNC_BYTES (((sizeof(bt_async_op_t) + BT_XML_ALIGN - 1U) / BT_XML_ALIGN) * BT_XML_ALIGN)
+
+_Static_assert(_Alignof(bt_node_t) <= sizeof(void*), "arena allocations are pointer-aligned");
+_Static_assert((sizeof(bt_node_t) % sizeof(void*)) == 0U, "nodes keep the arena pointer-aligned");
+
+/* ===== Internal types ===== */
+
+/* A run of bytes inside the text */
+typedef struct {
+  const char* s;
+  size_t n;
+} bt_xml_span_t;
+
+/* What an open element is */
+typedef enum {
+  BT_XML_ROOT = 0U, /* <root> wrapper */
+  BT_XML_TREE,      /* The selected <BehaviorTree> */
+  BT_XML_SKIP,      /* Ignored element or anything inside one */
+  BT_XML_NODE       /* Tree node */
+} bt_xml_kind_t;
+
+/* Attributes the loader understands */
+typedef struct {
+  bt_xml_span_t id;      /* ID */
+  bt_xml_span_t main;    /* main_tree_to_execute */
+  bt_xml_span_t success; /* success_count */
+  bt_xml_span_t failure; /* failure_count */
+} bt_xml_attrs_t;
+
+/* An open element */
+typedef struct {
+  bt_xml_span_t tag;
+  bt_xml_kind_t kind;
+  bt_node_type_t type;               /* NODE: node type */
+  const bt_registry_entry_t* entry;  /* NODE: leaf binding (NULL for composites) */
+  size_t node;                       /* NODE: arena offset of the node */
+  size_t base;                       /* Child stack depth when the element opened */
+  int32_t success_count;             /* PARALLEL policy as written */
+  int32_t failure_count;
+} bt_xml_frame_t;
+
+typedef struct {
+  const char* text;
+  size_t len;
+  size_t pos;
+  const bt_registry_t* reg;
+  void* blackboard;
+  uint8_t* arena; /* NULL when measuring */
+  size_t cap;     /* Arena size in pointers */
+  size_t front;   /* Bytes allocated from the start */
+  size_t back;    /* Pointers pushed at the end */
+  size_t peak;    /* Largest front + back seen, in bytes */
+  bt_xml_frame_t frames[BT_XML_MAX_DEPTH];
+  uint32_t depth;
+  bt_xml_span_t main; /* Tree to load (s == NULL: the first) */
+  bool top_closed;    /* The top-level element has ended */
+  bool loaded;        /* The selected tree has been read */
+  size_t root;        /* Arena offset of the root node once loaded */
+  uint32_t nodes;
+  const char* error;
+} bt_xml_parser_t;
+
+/* ===== Internal helpers ===== */
+
+/* Record the first error; always returns false. */
+static bool bt_xml_fail(bt_xml_parser_t* p, const char* msg) {
+  if (p->error == BT_NULL) {
+    p->error = msg;
+  } else {
+    /* No action */
+  }
+
+  return false;
+}
+
+static bool bt_xml_is_space(char c) {
+  return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+static bool bt_xml_eq(bt_xml_span_t span, const char* lit) {
+  const size_t n = strlen(lit);
+
+  return (span.n == n) && (memcmp(span.s, lit, n) == 0);
+}
+
+static bool bt_xml_at(const bt_xml_parser_t* p, const char* lit) {
+  const size_t n = strlen(lit);
+
+  return ((p->len - p->pos) >= n) && (memcmp(&p->text[p->pos], lit, n) == 0);
+}
+
+static void bt_xml_skip_space(bt_xml_parser_t* p) {
+  while ((p->pos < p->len) && bt_xml_is_space(p->text[p->pos])) {
+    p->pos++;
+  }
+}
+
+/* Move past the next occurrence of end (comments, declarations). */
+static bool bt_xml_skip_past(bt_xml_parser_t* p, const char* end) {
+  const size_t n = strlen(end);
+  bool found = false;
+
+  while ((!found) && (p->pos < p->len)) {
+    if (bt_xml_at(p, end)) {
+      p->pos += n;
+      found = true;
+    } else {
+      p->pos++;
+    }
+  }
+
+  return found ? true : bt_xml_fail(p, "unterminated comment or declaration");
+}
+
+/* Element or attribute name: everything up to a space, '=', '/' or '>'. */
+static bool bt_xml_name(bt_xml_parser_t* p, bt_xml_span_t* name) {
+  name->s = &p->text[p->pos];
+  while ((p->pos < p->len) && (!bt_xml_is_space(p->text[p->pos])) && (p->text[p->pos] != '=') &&
+         (p->text[p->pos] != '/') && (p->text[p->pos] != '>') && (p->text[p->pos] != '<')) {
+    p->pos++;
+  }
+  name->n = (size_t)(&p->text[p->pos] - name->s);
+
+  return (name->n > 0U) ? true : bt_xml_fail(p, "expected a name");
+}
+
+/* Attributes up to and including '>' or "/>". */
+static bool bt_xml_attrs(bt_xml_parser_t* p, bt_xml_attrs_t* attrs, bool* self_closing) {
+  bool ok = true;
+  bool end = false;
+
+  (void)memset(attrs, 0, sizeof(*attrs));
+  *self_closing = false;
+  while (ok && (!end)) {
+    bt_xml_skip_space(p);
+    if (p->pos >= p->len) {
+      ok = bt_xml_fail(p, "unterminated tag");
+    } else if (p->text[p->pos] == '>') {
+      p->pos++;
+      end = true;
+    } else if (bt_xml_at(p, "/>")) {
+      p->pos += 2U;
+      *self_closing = true;
+      end = true;
+    } else {
+      bt_xml_span_t name;
+      bt_xml_span_t value = {BT_NULL, 0U};
+
+      ok = bt_xml_name(p, &name);
+      bt_xml_skip_space(p);
+      if (ok && ((p->pos >= p->len) || (p->text[p->pos] != '='))) {
+        ok = bt_xml_fail(p, "expected '=' after attribute name");
+      } else {
+        /* No action */
+      }
+      if (ok) {
+        p->pos++;
+        bt_xml_skip_space(p);
+        if ((p->pos < p->len) && ((p->text[p->pos] == '"') || (p->text[p->pos] == '\''))) {
+          const char quote = p->text[p->pos];
+
+          p->pos++;
+          value.s = &p->text[p->pos];
+          while ((p->pos < p->len) && (p->text[p->pos] != quote)) {
+            p->pos++;
+          }
+          if (p->pos < p->len) {
+            value.n = (size_t)(&p->text[p->pos] - value.s);
+            p->pos++;
+          } else {
+            ok = bt_xml_fail(p, "unterminated attribute value");
+          }
+        } else {
+          ok = bt_xml_fail(p, "expected a quoted attribute value");
+        }
+      } else {
+        /* No action */
+      }
+      if (ok) {
+        if (bt_xml_eq(name, "ID")) {
+          attrs->id = value;
+        } else if (bt_xml_eq(name, "main_tree_to_execute")) {
+          attrs->main = value;
+        } else if (bt_xml_eq(name, "success_count")) {
+          attrs->success = value;
+        } else if (bt_xml_eq(name, "failure_count")) {
+          attrs->failure = value;
+        } else {
+          /* Other attributes (name, ports) are ignored */
+        }
+      } else {
+        /* No action */
+      }
+    }
+  }
+
+  return ok;
+}
+
+/* Integer attribute: -1 or 0..65535; an absent attribute keeps *out. */
+static bool bt_xml_int(bt_xml_parser_t* p, bt_xml_span_t span, int32_t* out) {
+  bool ok = true;
+
+  if (span.s != BT_NULL) {
+    const bool negative = (span.n > 0U) && (span.s[0] == '-');
+    size_t i = negative ? 1U : 0U;
+    int32_t value = 0;
+
+    ok = (i < span.n);
+    while (ok && (i < span.n)) {
+      ok = (span.s[i] >= '0') && (span.s[i] <= '9') && (value <= (int32_t)BT_XML_MAX_NODES);
+      value = (value * 10) + (int32_t)(span.s[i] - '0');
+      i++;
+    }
+    ok = ok && (value <= (int32_t)BT_XML_MAX_NODES) && ((!negative) || (value == 1));
+    if (ok) {
+      *out = negative ? BT_XML_ALL : value;
+    } else {
+      ok = bt_xml_fail(p, "invalid Parallel count");
+    }
+  } else {
+    /* No action */
+  }
+
+  return ok;
+}
+
+/* Account for bytes more at the front and ptrs more at the back. */
+static bool bt_xml_reserve(bt_xml_parser_t* p, size_t bytes, size_t ptrs) {
+  const size_t need = p->front + bytes + ((p->back + ptrs) * sizeof(bt_node_t*));
+  bool ok = true;
+
+  if (need > p->peak) {
+    p->peak = need;
+  } else {
+    /* No action */
+  }
+  if ((p->arena != BT_NULL) && (need > (p->cap * sizeof(bt_node_t*)))) {
+    ok = bt_xml_fail(p, "arena too small");
+  } else {
+    /* No action */
+  }
+
+  return ok;
+}
+
+static bt_node_t* bt_xml_node_at(const bt_xml_parser_t* p, size_t offset) {
+  return (bt_node_t*)(void*)&p->arena[offset];
+}
+
+/* Child stack slot i (0 = first pushed), at the end of the arena. */
+static bt_node_t** bt_xml_slot(const bt_xml_parser_t* p, size_t i) {
+  return &((bt_node_t**)(void*)p->arena)[p->cap - i - 1U];
+}
+
+/* Node type and leaf binding for a node element. */
+static bool bt_xml_classify(bt_xml_parser_t* p, bt_xml_frame_t* frame, const bt_xml_attrs_t* attrs) {
+  bool ok = true;
+  bt_xml_span_t leaf = {BT_NULL, 0U};
+
+  frame->entry = BT_NULL;
+  frame->success_count = BT_XML_ALL;
+  frame->failure_count = 1;
+  if (bt_xml_eq(frame->tag, "Sequence")) {
+    frame->type = BT_SEQUENCE;
+  } else if (bt_xml_eq(frame->tag, "Fallback") || bt_xml_eq(frame->tag, "Selector")) {
+    frame->type = BT_SELECTOR;
+  } else if (bt_xml_eq(frame->tag, "ReactiveSequence")) {
+    frame->type = BT_REACTIVE_SEQUENCE;
+  } else if (bt_xml_eq(frame->tag, "ReactiveFallback")) {
+    frame->type = BT_REACTIVE_SELECTOR;
+  } else if (bt_xml_eq(frame->tag, "Inverter")) {
+    frame->type = BT_INVERTER;
+  } else if (bt_xml_eq(frame->tag, "Parallel")) {
+    frame->type = BT_PARALLEL;
+    ok = bt_xml_int(p, attrs->success, &frame->success_count) && bt_xml_int(p, attrs->failure, &frame->failure_count);
+  } else if (bt_xml_eq(frame->tag, "SubTree")) {
+    ok = bt_xml_fail(p, "SubTree is not supported");
+  } else if (bt_xml_eq(frame->tag, "Action") || bt_xml_eq(frame->tag, "Condition")) {
+    leaf = attrs->id;
+    ok = (leaf.s != BT_NULL) ? true : bt_xml_fail(p, "leaf without ID");
+  } else {
+    leaf = frame->tag;
+  }
+
+  if (ok && (leaf.s != BT_NULL)) {
+    frame->entry = bt_registry_find(p->reg, leaf.s, leaf.n);
+    if (frame->entry != BT_NULL) {
+      frame->type = (bt_node_type_t)frame->entry->type;
+    } else {
+      ok = bt_xml_fail(p, "unknown node");
+    }
+  } else {
+    /* No action */
+  }
+
+  return ok;
+}
+
+/* Allocate a node element and push it as a child of the enclosing node. */
+static bool bt_xml_open_node(bt_xml_parser_t* p, bt_xml_frame_t* frame, const bt_xml_frame_t* parent) {
+  bool ok = true;
+
+  if (parent->kind == BT_XML_TREE) {
+    ok = (p->nodes == 0U) ? true : bt_xml_fail(p, "BehaviorTree must have exactly one root node");
+  } else if ((parent->type == BT_ACTION) || (parent->type == BT_CONDITION) || (parent->type == BT_ASYNC)) {
+    ok = bt_xml_fail(p, "leaf nodes cannot have children");
+  } else if ((parent->type == BT_INVERTER) && (p->back > parent->base)) {
+    ok = bt_xml_fail(p, "Inverter must have exactly one child");
+  } else {
+    /* No action */
+  }
+
+  if (ok && (p->nodes >= BT_XML_MAX_NODES)) {
+    ok = bt_xml_fail(p, "too many nodes");
+  } else {
+    /* No action */
+  }
+
+  if (ok) {
+    const size_t ptrs = (parent->kind == BT_XML_NODE) ? 1U : 0U;
+
+    ok = bt_xml_reserve(p, sizeof(bt_node_t), ptrs);
+    if (ok) {
+      frame->node = p->front;
+      p->front += sizeof(bt_node_t);
+      if (ptrs > 0U) {
+        if (p->arena != BT_NULL) {
+          *bt_xml_slot(p, p->back) = bt_xml_node_at(p, frame->node);
+        } else {
+          /* No action */
+        }
+        p->back++;
+      } else {
+        p->root = frame->node;
+      }
+      p->nodes++;
+    } else {
+      /* No action */
+    }
+  } else {
+    /* No action */
+  }
+
+  return ok;
+}
+
+static bool bt_xml_open(bt_xml_parser_t* p, bt_xml_span_t tag, const bt_xml_attrs_t* attrs) {
+  bool ok = true;
+  const bt_xml_frame_t* parent = (p->depth > 0U) ? &p->frames[p->depth - 1U] : BT_NULL;
+  bt_xml_frame_t* frame = &p->frames[p->depth];
+
+  if (p->depth >= BT_XML_MAX_DEPTH) {
+    ok = bt_xml_fail(p, "nesting too deep");
+  } else {
+    frame->tag = tag;
+    frame->type = BT_SEQUENCE;
+    frame->entry = BT_NULL;
+    frame->base = p->back;
+    if ((parent == BT_NULL) || (parent->kind == BT_XML_ROOT)) {
+      if (p->top_closed) {
+        ok = bt_xml_fail(p, "content after the top-level element");
+      } else if ((parent == BT_NULL) && bt_xml_eq(tag, "root")) {
+        frame->kind = BT_XML_ROOT;
+        p->main = attrs->main;
+      } else if (bt_xml_eq(tag, "BehaviorTree")) {
+        const bool selected =
+            (!p->loaded) && ((p->main.s == BT_NULL) || ((attrs->id.s != BT_NULL) && (attrs->id.n == p->main.n) &&
+                                                         (memcmp(attrs->id.s, p->main.s, p->main.n) == 0)));
+
+        frame->kind = selected ? BT_XML_TREE : BT_XML_SKIP;
+      } else if (parent == BT_NULL) {
+        ok = bt_xml_fail(p, "expected <root> or <BehaviorTree>");
+      } else {
+        frame->kind = BT_XML_SKIP; /* TreeNodesModel and the like */
+      }
+    } else if (parent->kind == BT_XML_SKIP) {
+      frame->kind = BT_XML_SKIP;
+    } else {
+      frame->kind = BT_XML_NODE;
+      ok = bt_xml_classify(p, frame, attrs) && bt_xml_open_node(p, frame, parent);
+      frame->base = p->back;
+    }
+    if (ok) {
+      p->depth++;
+    } else {
+      /* No action */
+    }
+  }
+
+  return ok;
+}
+
+/* Wire a node whose element just closed. */
+static bool bt_xml_close_node(bt_xml_parser_t* p, const bt_xml_frame_t* frame) {
+  const size_t n = p->back - frame->base;
+  const size_t state = (frame->type == BT_PARALLEL) ? BT_XML_PARALLEL_BYTES
+                       : (frame->type == BT_ASYNC) ? BT_XML_ASYNC_BYTES
+                                                   : 0U;
+  bool ok = true;
+  uint16_t success = 0U;
+  uint16_t failure = 0U;
+
+  if ((frame->type == BT_INVERTER) && (n != 1U)) {
+    ok = bt_xml_fail(p, "Inverter must have exactly one child");
+  } else if (frame->type == BT_PARALLEL) {
+    success = (frame->success_count == BT_XML_ALL) ? (uint16_t)n : (uint16_t)frame->success_count;
+    failure = (frame->failure_count == BT_XML_ALL) ? (uint16_t)n : (uint16_t)frame->failure_count;
+    ok = ((n <= BT_PARALLEL_MAX_CHILDREN) && (success >= 1U) && (success <= n) && (failure >= 1U) && (failure <= n))
+             ? true
+             : bt_xml_fail(p, "invalid Parallel policy");
+  } else {
+    /* No action */
+  }
+
+  if (ok && ((n > 0U) || (state > 0U))) {
+    ok = bt_xml_reserve(p, (n * sizeof(bt_node_t*)) + state, 0U);
+  } else {
+    /* No action */
+  }
+
+  if (ok) {
+    bt_node_t** children = BT_NULL;
+    void* ext = BT_NULL;
+    size_t i;
+
+    if ((p->arena != BT_NULL) && (n > 0U)) {
+      children = (bt_node_t**)(void*)&p->arena[p->front];
+      for (i = 0U; i < n; i++) {
+        children[i] = *bt_xml_slot(p, frame->base + i);
+      }
+    } else {
+      /* No action */
+    }
+    p->front += n * sizeof(bt_node_t*);
+    if ((p->arena != BT_NULL) && (state > 0U)) {
+      ext = &p->arena[p->front];
+    } else {
+      /* No action */
+    }
+    p->front += state;
+    p->back = frame->base;
+
+    if (p->arena != BT_NULL) {
+      bt_node_t* node = bt_xml_node_at(p, frame->node);
+
+      bt_init(node, frame->type, (frame->entry != BT_NULL) ? frame->entry->tick : BT_NULL, children, (uint16_t)n,
+              (frame->entry != BT_NULL) ? frame->entry->user_data : BT_NULL);
+      node->blackboard = p->blackboard;
+      if (frame->type == BT_PARALLEL) {
+        ok = (bt_set_parallel(node, (bt_parallel_t*)ext, success, failure) == BT_SUCCESS)
+                 ? true
+                 : bt_xml_fail(p, "invalid Parallel policy");
+      } else if (frame->type == BT_ASYNC) {
+        (void)bt_set_async(node, (bt_async_op_t*)ext);
+      } else {
+        /* No action */
+      }
+    } else {
+      /* No action */
+    }
+  } else {
+    /* No action */
+  }
+
+  return ok;
+}
+
+static bool bt_xml_close(bt_xml_parser_t* p, bt_xml_span_t tag) {
+  bool ok = true;
+
+  if (p->depth == 0U) {
+    ok = bt_xml_fail(p, "unexpected closing tag");
+  } else {
+    const bt_xml_frame_t* frame = &p->frames[p->depth - 1U];
+
+    if ((tag.s != BT_NULL) && ((tag.n != frame->tag.n) || (memcmp(tag.s, frame->tag.s, tag.n) != 0))) {
+      ok = bt_xml_fail(p, "mismatched closing tag");
+    } else if (frame->kind == BT_XML_NODE) {
+      ok = bt_xml_close_node(p, frame);
+    } else if (frame->kind == BT_XML_TREE) {
+      ok = (p->nodes > 0U) ? true : bt_xml_fail(p, "BehaviorTree must have exactly one root node");
+      p->loaded = ok;
+    } else {
+      /* No action */
+    }
+    if (ok) {
+      p->depth--;
+      p->top_closed = (p->depth == 0U);
+    } else {
+      /* No action */
+    }
+  }
+
+  return ok;
+}
+
+/* One markup construct starting at '<'. */
+static bool bt_xml_markup(bt_xml_parser_t* p) {
+  bool ok = true;
+  bt_xml_span_t tag;
+
+  if (bt_xml_at(p, "<!--")) {
+    p->pos += 4U;
+    ok = bt_xml_skip_past(p, "-->");
+  } else if (bt_xml_at(p, "<?")) {
+    p->pos += 2U;
+    ok = bt_xml_skip_past(p, "?>");
+  } else if (bt_xml_at(p, "<!")) {
+    p->pos += 2U;
+    ok = bt_xml_skip_past(p, ">");
+  } else if (bt_xml_at(p, "</")) {
+    p->pos += 2U;
+    ok = bt_xml_name(p, &tag);
+    bt_xml_skip_space(p);
+    if (ok && ((p->pos >= p->len) || (p->text[p->pos] != '>'))) {
+      ok = bt_xml_fail(p, "expected '>'");
+    } else if (ok) {
+      p->pos++;
+      ok = bt_xml_close(p, tag);
+    } else {
+      /* No action */
+    }
+  } else {
+    bt_xml_attrs_t attrs;
+    bool self_closing = false;
+
+    p->pos++;
+    ok = bt_xml_name(p, &tag) && bt_xml_attrs(p, &attrs, &self_closing) && bt_xml_open(p, tag, &attrs);
+    if (ok && self_closing) {
+      ok = bt_xml_close(p, tag);
+    } else {
+      /* No action */
+    }
+  }
+
+  return ok;
+}
+
+/* 1-based line of text[pos]. */
+static uint32_t bt_xml_line(const char* text, size_t pos) {
+  uint32_t line = 1U;
+  size_t i;
+
+  for (i = 0U; i < pos; i++) {
+    if (text[i] == '\n') {
+      line++;
+    } else {
+      /* No action */
+    }
+  }
+
+  return line;
+}
+
+/* ===== Public API ===== */
+
+bt_status_t bt_xml_load(const char* text, size_t len, const bt_registry_t* reg, void* blackboard, void* arena,
+                        size_t arena_size, bt_xml_result_t* result) {
+  bt_status_t status = BT_ERROR;
+
+  if ((text != BT_NULL) && (reg != BT_NULL) && (result != BT_NULL) &&
+      (((uintptr_t)arena % BT_XML_ALIGN) == 0U)) {
+    bt_xml_parser_t p;
+    bool ok = true;
+
+    (void)memset(&p, 0, sizeof(p));
+    p.text = text;
+    p.len = len;
+    p.reg = reg;
+    p.blackboard = blackboard;
+    p.arena = (uint8_t*)arena;
+    p.cap = arena_size / sizeof(bt_node_t*);
+
+    while (ok && (p.pos < p.len)) {
+      if (p.text[p.pos] == '<') {
+        ok = bt_xml_markup(&p);
+      } else {
+        p.pos++; /* Text content is ignored */
+      }
+    }
+
+    if (ok && (p.depth > 0U)) {
+      ok = bt_xml_fail(&p, "unexpected end of text");
+    } else if (ok && (!p.loaded)) {
+      ok = bt_xml_fail(&p, (p.main.s != BT_NULL) ? "main tree not found" : "no BehaviorTree found");
+    } else {
+      /* No action */
+    }
+
+    if (ok && (p.arena != BT_NULL)) {
+      (void)bt_assign_ids(bt_xml_node_at(&p, p.root));
+      ok = (bt_validate(bt_xml_node_at(&p, p.root)) == BT_SUCCESS) ? true : bt_xml_fail(&p, "invalid tree");
+    } else {
+      /* No action */
+    }
+
+    result->root = BT_NULL;
+    result->nodes = (uint16_t)p.nodes;
+    result->used = p.peak;
+    if (ok) {
+      result->root = (p.arena != BT_NULL) ? bt_xml_node_at(&p, p.root) : BT_NULL;
+      result->line = 0U;
+      result->error = BT_NULL;
+      status = BT_SUCCESS;
+    } else {
+      result->line = bt_xml_line(text, p.pos);
+      result->error = p.error;
+      status = BT_ERROR;
+    }
+  } else {
+    if (result != BT_NULL) {
+      (void)memset(result, 0, sizeof(*result));
+      result->error = "invalid arguments";
+    } else {
+      /* No action */
+    }
+    status = BT_ERROR;
+  }
+
+  return status;
+}
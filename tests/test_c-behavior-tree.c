@@ -1,4 +1,4 @@
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 200809L
 /* test_c-behavior-tree.c
  * RT-Thread test suite for c-behavior-tree (MISRA-style).
  *
@@ -9,6 +9,20 @@
  */
 
 #include "bt.h"
+#include "bt_async.h"
+#include "bt_blackboard.h"
+#include "bt_co.h"
+#include "bt_codegen.h"
+#include "bt_exec.h"
+#include "bt_executor.h"
+#include "bt_flat.h"
+#include "bt_image.h"
+#include "bt_profile.h"
+#include "bt_rom.h"
+#include "bt_timer.h"
+#include "bt_trace.h"
+#include "bt_watch.h"
+#include "bt_xml.h"
 
 #include <stdint.h>
 #include <stdio.h>
@@ -50,6 +64,10 @@ static inline void rt_thread_mdelay(unsigned ms) {
 #define BT_MAX_TEST_NODES (16U)
 #define BT_TEST_TICKS_SHORT (8U)
 #define BT_TEST_TICKS_LONG (64U)
+#define BT_TEST_DEEP_LEVELS (48U)
+#define BT_TEST_AGENTS (8U)
+#define BT_TEST_POPULATION (1000U)
+#define BT_TEST_WORKERS (4U)
 
 /* ===== Test blackboard/context ===== */
 typedef struct {
@@ -167,6 +185,125 @@ static bt_status_t leaf_action_fail_then_success(bt_node_t* node) {
   return result;
 }
 
+/* Script for leaf_countdown: RUNNING for `running` ticks, then `final` */
+typedef struct {
+  uint32_t running;
+  bt_status_t final;
+  uint32_t ticks; /* Number of times the leaf was ticked */
+} bt_test_countdown_t;
+
+/* ACTION: follows the bt_test_countdown_t script in user_data */
+static bt_status_t leaf_countdown(bt_node_t* node) {
+  bt_status_t result = BT_ERROR;
+
+  if ((node != BT_NULL) && (node->user_data != BT_NULL)) {
+    bt_test_countdown_t* cd = (bt_test_countdown_t*)node->user_data;
+
+    cd->ticks++;
+    result = (cd->ticks <= cd->running) ? BT_RUNNING : cd->final;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Script for leaf_sleep_once: sleep delay_ms on the first call, then succeed */
+typedef struct {
+  const bt_timer_wheel_t* wheel;
+  uint32_t delay_ms;
+  uint32_t calls;
+} bt_test_sleeper_t;
+
+/* ACTION: arms its time anchor on the first call, SUCCESS on the next one */
+static bt_status_t leaf_sleep_once(bt_node_t* node) {
+  bt_status_t result = BT_ERROR;
+
+  if ((node != BT_NULL) && (node->user_data != BT_NULL)) {
+    bt_test_sleeper_t* sl = (bt_test_sleeper_t*)node->user_data;
+
+    sl->calls++;
+    if (sl->calls == 1U) {
+      node->time_anchor_ms = sl->wheel->now + sl->delay_ms;
+      result = BT_RUNNING;
+    } else {
+      result = BT_SUCCESS;
+    }
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Operation handed out by leaf_async_start */
+typedef struct {
+  bt_async_token_t token; /* Token of the latest operation */
+  uint32_t starts;        /* Number of operations started */
+} bt_test_async_t;
+
+/* ASYNC: starts an operation and leaves its completion to the test */
+static bt_status_t leaf_async_start(bt_node_t* node) {
+  bt_status_t result = BT_ERROR;
+
+  if ((node != BT_NULL) && (node->user_data != BT_NULL)) {
+    bt_test_async_t* op = (bt_test_async_t*)node->user_data;
+
+    op->token = bt_async_token(node);
+    op->starts++;
+    result = BT_RUNNING;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Work for a completion thread: post SUCCESS for every operation in ops */
+typedef struct {
+  bt_async_queue_t* queue;
+  const bt_test_async_t* ops;
+  uint32_t count;
+  uint32_t retries; /* Posts repeated because the queue was full */
+} bt_test_producer_t;
+
+static void* bt_test_producer(void* arg) {
+  bt_test_producer_t* p = (bt_test_producer_t*)arg;
+  uint32_t i;
+
+  for (i = 0U; i < p->count; i++) {
+    while (bt_async_complete(p->queue, p->ops[i].token, BT_SUCCESS) == BT_FAILURE) {
+      p->retries++;
+    }
+  }
+
+  return BT_NULL;
+}
+
+/* Script for leaf_co_steps */
+typedef struct {
+  uint32_t steps;    /* Steps to run, one per tick */
+  uint32_t fail_at;  /* Step that fails the leaf (steps + 1 = never) */
+  uint32_t ready;    /* Final wait ends once non-zero */
+  uint32_t done;     /* Steps run so far, over all runs */
+} bt_test_co_t;
+
+/* ACTION coroutine: one step per tick, then wait for ready */
+static bt_status_t leaf_co_steps(bt_node_t* node) {
+  bt_test_co_t* co = (bt_test_co_t*)node->user_data;
+
+  BT_CO_BEGIN(node);
+  for (BT_CO_VAR(node, 0U) = 0U; BT_CO_VAR(node, 0U) < co->steps; BT_CO_VAR(node, 0U)++) {
+    co->done++;
+    if (BT_CO_VAR(node, 0U) == co->fail_at) {
+      BT_CO_RETURN(node, BT_FAILURE);
+    }
+    BT_CO_YIELD(node);
+  }
+  BT_CO_WAIT_UNTIL(node, co->ready != 0U);
+  BT_CO_END(node, BT_SUCCESS);
+}
+
 /* ===== Helpers to (re)build small trees for each test ===== */
 
 typedef struct {
@@ -180,6 +317,10 @@ typedef struct {
   bt_node_t n_cond_counter;
   bt_node_t n_action_progress;
   bt_node_t n_action_fail_succ;
+
+  /* Leaf parameters (user_data must outlive bt_build_tree) */
+  uint32_t threshold;
+  uint32_t progress_ticks;
 } bt_test_tree_t;
 
 static void bt_test_reset_ctx(void) {
@@ -212,11 +353,14 @@ static void bt_build_tree(bt_test_tree_t* t, uint32_t threshold, uint32_t progre
   static bt_node_t* seq_outer_children[2];
   static bt_node_t* root_children[2];
 
+  t->threshold = threshold;
+  t->progress_ticks = progress_ticks;
+
   /* Init leaves */
   bt_init(&t->n_cond_true, BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
   bt_init(&t->n_cond_false, BT_CONDITION, leaf_cond_false, BT_NULL, 0U, BT_NULL);
-  bt_init(&t->n_cond_counter, BT_CONDITION, leaf_cond_counter_gt, BT_NULL, 0U, &threshold);
-  bt_init(&t->n_action_progress, BT_ACTION, leaf_action_progress, BT_NULL, 0U, &progress_ticks);
+  bt_init(&t->n_cond_counter, BT_CONDITION, leaf_cond_counter_gt, BT_NULL, 0U, &t->threshold);
+  bt_init(&t->n_action_progress, BT_ACTION, leaf_action_progress, BT_NULL, 0U, &t->progress_ticks);
   bt_init(&t->n_action_fail_succ, BT_ACTION, leaf_action_fail_then_success, BT_NULL, 0U, BT_NULL);
 
   /* Compose selector child: (cond_false, action_fail_then_success) */
@@ -473,7 +617,2623 @@ static rt_err_t test_performance(void) {
   return rc;
 }
 
-/* ===== Test runner & shell commands ===== */
+static rt_err_t test_compiled_equivalence(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_test_tree_t tree;
+  bt_flat_node_t flat[BT_MAX_TEST_NODES];
+  bt_flat_tree_t compiled;
+  bt_instance_t inst;
+  uint8_t inst_status[BT_MAX_TEST_NODES];
+  uint16_t inst_cursor[BT_MAX_TEST_NODES];
+  bt_status_t expected[BT_TEST_TICKS_LONG];
+  uint32_t expected_enter = 0U;
+  uint32_t expected_exit = 0U;
+  uint32_t i;
+
+  /* Reference run through the recursive engine */
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    g_ctx.counter = (i / 5U) & 1U; /* Switch between work and fallback branches */
+    expected[i] = bt_tick(&tree.n_root);
+  }
+  expected_enter = g_ctx.last_enter_calls;
+  expected_exit = g_ctx.last_exit_calls;
+
+  /* Same scenario through the compiled tree */
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  if (bt_count_nodes(&tree.n_root) != 9U) {
+    rt_kprintf("[E] compiled: expected 9 nodes, got %u\n", (unsigned)bt_count_nodes(&tree.n_root));
+    return rc;
+  }
+  if ((bt_compile(&tree.n_root, flat, BT_MAX_TEST_NODES, &compiled) != BT_SUCCESS) ||
+      (bt_instance_init(&compiled, &inst, inst_status, inst_cursor) != BT_SUCCESS) || (compiled.slots != 4U)) {
+    rt_kprintf("[E] compiled: bt_compile failed\n");
+    return rc;
+  }
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    g_ctx.counter = (i / 5U) & 1U;
+    {
+      const bt_status_t s = bt_tick_instance(&compiled, &inst, BT_NULL);
+      if (s != expected[i]) {
+        rt_kprintf("[E] compiled: tick %u expected %u, got %u\n", (unsigned)i, (unsigned)expected[i], (unsigned)s);
+        return rc;
+      }
+    }
+  }
+  if ((g_ctx.last_enter_calls != expected_enter) || (g_ctx.last_exit_calls != expected_exit)) {
+    rt_kprintf("[E] compiled: hook calls differ (enter %u/%u, exit %u/%u)\n", (unsigned)g_ctx.last_enter_calls,
+               (unsigned)expected_enter, (unsigned)g_ctx.last_exit_calls, (unsigned)expected_exit);
+    return rc;
+  }
+
+  /* Too little storage and malformed trees are rejected */
+  if (bt_compile(&tree.n_root, flat, 4U, &compiled) != BT_ERROR) {
+    rt_kprintf("[E] compiled: expected BT_ERROR for short storage\n");
+    return rc;
+  }
+  {
+    bt_node_t inv_bad;
+    bt_init(&inv_bad, BT_INVERTER, BT_NULL, BT_NULL, 0U, BT_NULL);
+    if (bt_compile(&inv_bad, flat, BT_MAX_TEST_NODES, &compiled) != BT_ERROR) {
+      rt_kprintf("[E] compiled: expected BT_ERROR for inverter without child\n");
+      return rc;
+    }
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Build a chain of BT_TEST_DEEP_LEVELS composites (alternating single-child
+ * SEQUENCE and double INVERTER pairs) above a progress action.
+ */
+static bt_node_t* bt_build_deep_chain(bt_node_t nodes[], bt_node_t* links[], uint32_t* need_ticks) {
+  uint32_t i;
+
+  bt_init(&nodes[BT_TEST_DEEP_LEVELS], BT_ACTION, leaf_action_progress, BT_NULL, 0U, need_ticks);
+  nodes[BT_TEST_DEEP_LEVELS].blackboard = &g_ctx;
+
+  for (i = BT_TEST_DEEP_LEVELS; i > 0U; i--) {
+    const bt_node_type_t type = ((i % 3U) == 0U) ? BT_SEQUENCE : BT_INVERTER;
+
+    links[i - 1U] = &nodes[i];
+    bt_init(&nodes[i - 1U], type, BT_NULL, &links[i - 1U], 1U, BT_NULL);
+    nodes[i - 1U].on_enter = hook_on_enter;
+    nodes[i - 1U].on_exit = hook_on_exit;
+  }
+
+  return &nodes[0];
+}
+
+static rt_err_t test_exec_iterative(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_test_tree_t tree;
+  bt_exec_t exec;
+  BT_EXEC_FRAMES(frames, BT_EXEC_MAX_DEPTH);
+  bt_node_t deep[BT_TEST_DEEP_LEVELS + 1U];
+  bt_node_t* deep_links[BT_TEST_DEEP_LEVELS];
+  bt_node_t* deep_root = BT_NULL;
+  bt_status_t expected[BT_TEST_TICKS_LONG];
+  uint32_t expected_enter = 0U;
+  uint32_t expected_exit = 0U;
+  uint32_t need_ticks = 2U;
+  uint32_t i;
+
+  if (BT_EXEC_INIT(&exec, frames) != BT_SUCCESS) {
+    rt_kprintf("[E] exec: init failed\n");
+    return rc;
+  }
+
+  /* Reference run through the recursive engine */
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    g_ctx.counter = (i / 5U) & 1U;
+    expected[i] = bt_tick(&tree.n_root);
+  }
+  expected_enter = g_ctx.last_enter_calls;
+  expected_exit = g_ctx.last_exit_calls;
+
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    g_ctx.counter = (i / 5U) & 1U;
+    {
+      const bt_status_t s = bt_tick_exec(&exec, &tree.n_root);
+      if (s != expected[i]) {
+        rt_kprintf("[E] exec: tick %u expected %u, got %u\n", (unsigned)i, (unsigned)expected[i], (unsigned)s);
+        return rc;
+      }
+    }
+  }
+  if ((g_ctx.last_enter_calls != expected_enter) || (g_ctx.last_exit_calls != expected_exit)) {
+    rt_kprintf("[E] exec: hook calls differ\n");
+    return rc;
+  }
+
+  /* Deep chain: same statuses and hook counts as bt_tick */
+  bt_test_reset_ctx();
+  deep_root = bt_build_deep_chain(deep, deep_links, &need_ticks);
+  for (i = 0U; i < BT_TEST_TICKS_SHORT; i++) {
+    expected[i] = bt_tick(deep_root);
+  }
+  expected_enter = g_ctx.last_enter_calls;
+  expected_exit = g_ctx.last_exit_calls;
+
+  bt_test_reset_ctx();
+  deep_root = bt_build_deep_chain(deep, deep_links, &need_ticks);
+  for (i = 0U; i < BT_TEST_TICKS_SHORT; i++) {
+    const bt_status_t s = bt_tick_exec(&exec, deep_root);
+    if (s != expected[i]) {
+      rt_kprintf("[E] exec: deep tick %u expected %u, got %u\n", (unsigned)i, (unsigned)expected[i], (unsigned)s);
+      return rc;
+    }
+  }
+  if ((g_ctx.last_enter_calls != expected_enter) || (g_ctx.last_exit_calls != expected_exit) ||
+      (expected_exit == 0U)) {
+    rt_kprintf("[E] exec: deep hook calls differ\n");
+    return rc;
+  }
+
+  /* A frame stack shallower than the tree reports BT_ERROR instead of overflowing */
+  if (bt_exec_init(&exec, frames, 16U) != BT_SUCCESS) {
+    return rc;
+  }
+  if (bt_tick_exec(&exec, bt_build_deep_chain(deep, deep_links, &need_ticks)) != BT_ERROR) {
+    rt_kprintf("[E] exec: expected BT_ERROR for a too-small frame stack\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Status planted in the ancestors of a cached leaf: a tick that walks back up
+ * through an ancestor stores a real status over it */
+#define BT_TEST_UNVISITED ((bt_status_t)0x7FU)
+
+static rt_err_t test_resume_running_path(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_exec_t exec;
+  BT_EXEC_FRAMES(frames, BT_EXEC_MAX_DEPTH);
+  bt_node_t deep[BT_TEST_DEEP_LEVELS + 1U];
+  bt_node_t* deep_links[BT_TEST_DEEP_LEVELS];
+  bt_node_t* deep_root = BT_NULL;
+  bt_flat_node_t flat[BT_TEST_DEEP_LEVELS + 1U];
+  bt_flat_tree_t compiled;
+  bt_instance_t inst;
+  uint8_t inst_status[BT_TEST_DEEP_LEVELS + 1U];
+  uint16_t inst_cursor[BT_TEST_DEEP_LEVELS];
+  uint32_t need_ticks = 3U;
+  uint32_t visits = 0U;
+  uint32_t i;
+  uint32_t j;
+
+  (void)BT_EXEC_INIT(&exec, frames);
+
+  /* Engine: the leaf keeps the root RUNNING, so the whole path is cached */
+  bt_test_reset_ctx();
+  deep_root = bt_build_deep_chain(deep, deep_links, &need_ticks);
+  for (i = 0U; i < need_ticks; i++) {
+    for (j = 1U; (i > 0U) && (j < BT_TEST_DEEP_LEVELS); j++) {
+      deep[j].status = BT_TEST_UNVISITED;
+    }
+    if ((bt_tick_exec(&exec, deep_root) != BT_RUNNING) || (exec.path_len != (BT_TEST_DEEP_LEVELS + 1U))) {
+      rt_kprintf("[E] resume: exec tick %u should cache a %u-frame path (got %u)\n", (unsigned)i,
+                 (unsigned)(BT_TEST_DEEP_LEVELS + 1U), (unsigned)exec.path_len);
+      return rc;
+    }
+    /* Resumed ticks whose leaf stays RUNNING must not visit any ancestor */
+    for (j = 1U, visits = 0U; j < BT_TEST_DEEP_LEVELS; j++) {
+      visits += (deep[j].status != BT_TEST_UNVISITED) ? 1U : 0U;
+    }
+    if ((i > 0U) && (visits != 0U)) {
+      rt_kprintf("[E] resume: exec tick %u visited %u ancestors\n", (unsigned)i, (unsigned)visits);
+      return rc;
+    }
+  }
+  for (j = 1U; j < BT_TEST_DEEP_LEVELS; j++) {
+    deep[j].status = BT_RUNNING;
+  }
+  /* Leaf completes: the path unwinds through every ancestor and is dropped */
+  if ((bt_tick_exec(&exec, deep_root) == BT_RUNNING) || (exec.path_len != 0U) ||
+      (g_ctx.last_exit_calls != BT_TEST_DEEP_LEVELS) || (g_ctx.last_enter_calls != BT_TEST_DEEP_LEVELS)) {
+    rt_kprintf("[E] resume: exec did not unwind the path (exit=%u)\n", (unsigned)g_ctx.last_exit_calls);
+    return rc;
+  }
+
+  /* Compiled tree: same through the cached active leaf */
+  bt_test_reset_ctx();
+  deep_root = bt_build_deep_chain(deep, deep_links, &need_ticks);
+  if ((bt_compile(deep_root, flat, BT_COUNT_OF(flat), &compiled) != BT_SUCCESS) ||
+      (bt_instance_init(&compiled, &inst, inst_status, inst_cursor) != BT_SUCCESS)) {
+    rt_kprintf("[E] resume: compile failed\n");
+    return rc;
+  }
+  for (i = 0U; i < need_ticks; i++) {
+    for (j = 1U; (i > 0U) && (j < BT_TEST_DEEP_LEVELS); j++) {
+      inst_status[j] = (uint8_t)BT_TEST_UNVISITED;
+    }
+    if ((bt_tick_instance(&compiled, &inst, BT_NULL) != BT_RUNNING) || (inst.active != BT_TEST_DEEP_LEVELS)) {
+      rt_kprintf("[E] resume: compiled tick %u should cache leaf %u (got %u)\n", (unsigned)i,
+                 (unsigned)BT_TEST_DEEP_LEVELS, (unsigned)inst.active);
+      return rc;
+    }
+    for (j = 1U, visits = 0U; j < BT_TEST_DEEP_LEVELS; j++) {
+      visits += (inst_status[j] != (uint8_t)BT_TEST_UNVISITED) ? 1U : 0U;
+    }
+    if ((i > 0U) && (visits != 0U)) {
+      rt_kprintf("[E] resume: compiled tick %u visited %u ancestors\n", (unsigned)i, (unsigned)visits);
+      return rc;
+    }
+  }
+  for (j = 1U; j < BT_TEST_DEEP_LEVELS; j++) {
+    inst_status[j] = (uint8_t)BT_RUNNING;
+  }
+  if ((bt_tick_instance(&compiled, &inst, BT_NULL) == BT_RUNNING) || (inst.active != BT_FLAT_NONE) ||
+      (g_ctx.last_exit_calls != BT_TEST_DEEP_LEVELS) || (g_ctx.last_enter_calls != BT_TEST_DEEP_LEVELS)) {
+    rt_kprintf("[E] resume: compiled did not unwind the path (exit=%u)\n", (unsigned)g_ctx.last_exit_calls);
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+static rt_err_t test_shared_definition(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_test_tree_t tree;
+  bt_flat_node_t flat[BT_MAX_TEST_NODES];
+  bt_flat_tree_t def;
+  bt_test_ctx_t bb[2];
+  bt_instance_t inst[2];
+  uint8_t status[2][BT_MAX_TEST_NODES];
+  uint16_t cursor[2][BT_MAX_TEST_NODES];
+  uint32_t i;
+
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  if (bt_compile(&tree.n_root, flat, BT_MAX_TEST_NODES, &def) != BT_SUCCESS) {
+    rt_kprintf("[E] shared: compile failed\n");
+    return rc;
+  }
+
+  /* Two agents share the definition; only their state and blackboard differ */
+  (void)memset(bb, 0, sizeof(bb));
+  bb[0].counter = 1U; /* Takes the work branch */
+  bb[1].counter = 0U; /* Falls back to cond_true */
+  for (i = 0U; i < 2U; i++) {
+    if (bt_instance_init(&def, &inst[i], status[i], cursor[i]) != BT_SUCCESS) {
+      rt_kprintf("[E] shared: instance init failed\n");
+      return rc;
+    }
+  }
+
+  for (i = 0U; i < 2U; i++) {
+    const bt_status_t s0 = bt_tick_instance(&def, &inst[0], &bb[0]);
+    const bt_status_t s1 = bt_tick_instance(&def, &inst[1], &bb[1]);
+    if ((s0 != BT_RUNNING) || (s1 != BT_SUCCESS) || (bb[0].progress != (i + 1U)) || (bb[1].progress != 0U)) {
+      rt_kprintf("[E] shared: tick %u got %u/%u\n", (unsigned)i, (unsigned)s0, (unsigned)s1);
+      return rc;
+    }
+  }
+
+  /* Agent 0 finishes its progress action; the shared source nodes never changed */
+  if ((bt_tick_instance(&def, &inst[0], &bb[0]) != BT_SUCCESS) || (tree.n_root.status != BT_FAILURE) ||
+      (g_ctx.progress != 0U)) {
+    rt_kprintf("[E] shared: agent 0 should finish without touching the source tree\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+static rt_err_t test_batch_tick(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_test_tree_t tree;
+  bt_flat_node_t flat[BT_MAX_TEST_NODES];
+  bt_flat_tree_t def;
+  bt_test_ctx_t bb_batch[BT_TEST_AGENTS];
+  bt_test_ctx_t bb_single[BT_TEST_AGENTS];
+  void* bb_ptrs[BT_TEST_AGENTS];
+  bt_instance_t batch[BT_TEST_AGENTS];
+  bt_instance_t single[BT_TEST_AGENTS];
+  uint8_t status[2U * BT_TEST_AGENTS][BT_MAX_TEST_NODES];
+  uint16_t cursor[2U * BT_TEST_AGENTS][BT_MAX_TEST_NODES];
+  bt_status_t results[BT_TEST_AGENTS];
+  uint32_t a;
+  uint32_t t;
+
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  if (bt_compile(&tree.n_root, flat, BT_MAX_TEST_NODES, &def) != BT_SUCCESS) {
+    rt_kprintf("[E] batch: compile failed\n");
+    return rc;
+  }
+
+  (void)memset(bb_batch, 0, sizeof(bb_batch));
+  (void)memset(bb_single, 0, sizeof(bb_single));
+  for (a = 0U; a < BT_TEST_AGENTS; a++) {
+    bb_ptrs[a] = &bb_batch[a];
+    (void)bt_instance_init(&def, &batch[a], status[a], cursor[a]);
+    (void)bt_instance_init(&def, &single[a], status[BT_TEST_AGENTS + a], cursor[BT_TEST_AGENTS + a]);
+  }
+
+  /* One batch call per frame must match ticking each agent on its own */
+  for (t = 0U; t < BT_TEST_TICKS_SHORT; t++) {
+    for (a = 0U; a < BT_TEST_AGENTS; a++) {
+      bb_batch[a].counter = ((a + t) / 3U) & 1U;
+      bb_single[a].counter = bb_batch[a].counter;
+    }
+
+    if (bt_tick_batch(&def, batch, bb_ptrs, results, BT_TEST_AGENTS) != BT_SUCCESS) {
+      rt_kprintf("[E] batch: bt_tick_batch failed\n");
+      return rc;
+    }
+
+    for (a = 0U; a < BT_TEST_AGENTS; a++) {
+      const bt_status_t s = bt_tick_instance(&def, &single[a], &bb_single[a]);
+      if ((s != results[a]) || (bb_single[a].progress != bb_batch[a].progress)) {
+        rt_kprintf("[E] batch: agent %u frame %u got %u, expected %u\n", (unsigned)a, (unsigned)t,
+                   (unsigned)results[a], (unsigned)s);
+        return rc;
+      }
+    }
+  }
+
+  if (bt_tick_batch(&def, batch, bb_ptrs, BT_NULL, BT_TEST_AGENTS) != BT_ERROR) {
+    rt_kprintf("[E] batch: expected BT_ERROR without a results array\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+static rt_err_t test_executor(void) {
+  rt_err_t rc = -RT_ERROR;
+  static bt_executor_t ex;
+  static bt_test_ctx_t bb_pool[BT_TEST_POPULATION];
+  static bt_test_ctx_t bb_ref[BT_TEST_POPULATION];
+  static void* bb_ptrs[BT_TEST_POPULATION];
+  static bt_instance_t pool[BT_TEST_POPULATION];
+  static bt_instance_t ref[BT_TEST_POPULATION];
+  static uint8_t status[2U * BT_TEST_POPULATION][BT_MAX_TEST_NODES];
+  static uint16_t cursor[2U * BT_TEST_POPULATION][BT_MAX_TEST_NODES];
+  static bt_status_t results[BT_TEST_POPULATION];
+  static bt_status_t expected[BT_TEST_POPULATION];
+  bt_test_tree_t tree;
+  bt_flat_node_t flat[BT_MAX_TEST_NODES];
+  bt_flat_tree_t def;
+  uint32_t agents = 0U;
+  uint32_t rounds_ok = 1U;
+  uint32_t a;
+  uint32_t t;
+  uint16_t w;
+
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  /* The lifecycle hooks count into g_ctx, which workers would share */
+  tree.n_seq_inner.on_enter = BT_NULL;
+  tree.n_seq_inner.on_exit = BT_NULL;
+  if (bt_compile(&tree.n_root, flat, BT_MAX_TEST_NODES, &def) != BT_SUCCESS) {
+    rt_kprintf("[E] executor: compile failed\n");
+    return rc;
+  }
+
+  (void)memset(bb_pool, 0, sizeof(bb_pool));
+  (void)memset(bb_ref, 0, sizeof(bb_ref));
+  for (a = 0U; a < BT_TEST_POPULATION; a++) {
+    bb_ptrs[a] = &bb_pool[a];
+    (void)bt_instance_init(&def, &pool[a], status[a], cursor[a]);
+    (void)bt_instance_init(&def, &ref[a], status[BT_TEST_POPULATION + a], cursor[BT_TEST_POPULATION + a]);
+  }
+
+  /* Small chunks so that stealing actually happens */
+  if (bt_executor_start(&ex, BT_TEST_WORKERS, &def, pool, bb_ptrs, results, BT_TEST_POPULATION, 16U) !=
+      BT_SUCCESS) {
+    rt_kprintf("[E] executor: start failed\n");
+    return rc;
+  }
+
+  /* Every round must match a sequential batch over a copy of the population */
+  for (t = 0U; (t < BT_TEST_TICKS_SHORT) && (rounds_ok != 0U); t++) {
+    for (a = 0U; a < BT_TEST_POPULATION; a++) {
+      bb_pool[a].counter = ((a + t) / 3U) & 1U;
+      bb_ref[a].counter = bb_pool[a].counter;
+      (void)bt_tick_instance(&def, &ref[a], &bb_ref[a]);
+    }
+    for (a = 0U; a < BT_TEST_POPULATION; a++) {
+      expected[a] = (bt_status_t)ref[a].status[0];
+    }
+
+    if (bt_executor_tick_all(&ex) != BT_SUCCESS) {
+      rt_kprintf("[E] executor: tick_all failed\n");
+      rounds_ok = 0U;
+    }
+
+    for (a = 0U; (a < BT_TEST_POPULATION) && (rounds_ok != 0U); a++) {
+      if ((results[a] != expected[a]) || (bb_pool[a].progress != bb_ref[a].progress)) {
+        rt_kprintf("[E] executor: agent %u round %u got %u, expected %u\n", (unsigned)a, (unsigned)t,
+                   (unsigned)results[a], (unsigned)expected[a]);
+        rounds_ok = 0U;
+      }
+    }
+  }
+
+  /* Each agent is ticked exactly once per round, whoever runs its chunk */
+  for (w = 0U; w < BT_TEST_WORKERS; w++) {
+    bt_worker_stats_t st;
+    if ((bt_executor_stats(&ex, w, &st) != BT_SUCCESS) || (st.rounds != BT_TEST_TICKS_SHORT) ||
+        (st.busy_ns > st.wall_ns)) {
+      rt_kprintf("[E] executor: bad stats for worker %u\n", (unsigned)w);
+      rounds_ok = 0U;
+    } else {
+      agents += st.agents;
+    }
+  }
+  bt_executor_stop(&ex);
+
+  if ((rounds_ok != 0U) && (agents == (BT_TEST_TICKS_SHORT * BT_TEST_POPULATION))) {
+    rc = RT_EOK;
+  } else if (rounds_ok != 0U) {
+    rt_kprintf("[E] executor: %u agent ticks, expected %u\n", (unsigned)agents,
+               (unsigned)(BT_TEST_TICKS_SHORT * BT_TEST_POPULATION));
+  } else {
+    /* Already reported */
+  }
+
+  return rc;
+}
+
+/* Build:
+ *   root = SEQUENCE(
+ *             PARALLEL(success 2, failure 2)(
+ *               A: SUCCESS at once,
+ *               B: RUNNING x2 then SUCCESS,
+ *               INVERTER(C: RUNNING x1 then SUCCESS)
+ *             ),
+ *             cond_true
+ *          )
+ */
+static void bt_build_parallel(bt_node_t n[7], bt_test_countdown_t cd[3], bt_parallel_t* par) {
+  static bt_node_t* par_children[3];
+  static bt_node_t* inv_children[1];
+  static bt_node_t* root_children[2];
+
+  cd[0] = (bt_test_countdown_t){0U, BT_SUCCESS, 0U};
+  cd[1] = (bt_test_countdown_t){2U, BT_SUCCESS, 0U};
+  cd[2] = (bt_test_countdown_t){1U, BT_SUCCESS, 0U};
+
+  bt_init(&n[3], BT_ACTION, leaf_countdown, BT_NULL, 0U, &cd[0]);
+  bt_init(&n[4], BT_ACTION, leaf_countdown, BT_NULL, 0U, &cd[1]);
+  bt_init(&n[5], BT_ACTION, leaf_countdown, BT_NULL, 0U, &cd[2]);
+  bt_init(&n[6], BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+
+  inv_children[0] = &n[5];
+  BT_INIT(&n[2], BT_INVERTER, BT_NULL, inv_children, BT_NULL);
+
+  par_children[0] = &n[3];
+  par_children[1] = &n[4];
+  par_children[2] = &n[2];
+  BT_INIT(&n[1], BT_PARALLEL, BT_NULL, par_children, BT_NULL);
+  (void)bt_set_parallel(&n[1], par, 2U, 2U);
+  n[1].on_enter = hook_on_enter;
+  n[1].on_exit = hook_on_exit;
+
+  root_children[0] = &n[1];
+  root_children[1] = &n[6];
+  BT_INIT(&n[0], BT_SEQUENCE, BT_NULL, root_children, BT_NULL);
+}
+
+/* Build:
+ *   root = PARALLEL(success 1, failure 1)(
+ *             SEQUENCE[hooks](B: RUNNING x5 then SUCCESS),
+ *             A: RUNNING x1 then SUCCESS
+ *          )
+ */
+static void bt_build_parallel_halt(bt_node_t n[4], bt_test_countdown_t cd[2], bt_parallel_t* par) {
+  static bt_node_t* par_children[2];
+  static bt_node_t* seq_children[1];
+
+  cd[0] = (bt_test_countdown_t){5U, BT_SUCCESS, 0U};
+  cd[1] = (bt_test_countdown_t){1U, BT_SUCCESS, 0U};
+
+  bt_init(&n[2], BT_ACTION, leaf_countdown, BT_NULL, 0U, &cd[0]);
+  bt_init(&n[3], BT_ACTION, leaf_countdown, BT_NULL, 0U, &cd[1]);
+
+  seq_children[0] = &n[2];
+  BT_INIT(&n[1], BT_SEQUENCE, BT_NULL, seq_children, BT_NULL);
+  n[1].on_enter = hook_on_enter;
+  n[1].on_exit = hook_on_exit;
+
+  par_children[0] = &n[1];
+  par_children[1] = &n[3];
+  BT_INIT(&n[0], BT_PARALLEL, BT_NULL, par_children, BT_NULL);
+  (void)bt_set_parallel(&n[0], par, 1U, 1U);
+}
+
+static rt_err_t test_parallel(void) {
+  rt_err_t rc = -RT_ERROR;
+  static const bt_status_t expected[3] = {BT_RUNNING, BT_RUNNING, BT_SUCCESS};
+  bt_node_t n[7];
+  bt_parallel_t par;
+  bt_test_countdown_t cd[3];
+  bt_flat_node_t flat[BT_MAX_TEST_NODES];
+  bt_flat_tree_t def;
+  bt_instance_t inst;
+  uint8_t status[BT_MAX_TEST_NODES];
+  uint16_t cursor[BT_MAX_TEST_NODES];
+  BT_EXEC_FRAMES(frames, 4U);
+  bt_exec_t exec;
+  uint32_t engine;
+  uint32_t t;
+
+  /* Same scenario through bt_tick, bt_tick_exec, bt_tick_instance and bt_tick on a validated tree */
+  for (engine = 0U; engine < 4U; engine++) {
+    bt_test_reset_ctx();
+    bt_build_parallel(n, cd, &par);
+    (void)BT_EXEC_INIT(&exec, frames);
+    if ((bt_compile(&n[0], flat, BT_MAX_TEST_NODES, &def) != BT_SUCCESS) ||
+        (bt_instance_init(&def, &inst, status, cursor) != BT_SUCCESS) ||
+        ((engine == 3U) && (bt_validate(&n[0]) != BT_SUCCESS))) {
+      rt_kprintf("[E] parallel: compile failed\n");
+      return rc;
+    }
+
+    for (t = 0U; t < 3U; t++) {
+      bt_status_t s = BT_ERROR;
+
+      if ((engine == 0U) || (engine == 3U)) {
+        s = bt_tick(&n[0]);
+      } else if (engine == 1U) {
+        s = bt_tick_exec(&exec, &n[0]);
+      } else {
+        s = bt_tick_instance(&def, &inst, BT_NULL);
+      }
+
+      if (s != expected[t]) {
+        rt_kprintf("[E] parallel: engine %u tick %u got %u\n", (unsigned)engine, (unsigned)t, (unsigned)s);
+        return rc;
+      }
+    }
+
+    /* Finished children are not ticked again */
+    if ((cd[0].ticks != 1U) || (cd[1].ticks != 3U) || (cd[2].ticks != 2U) || (g_ctx.last_enter_calls != 1U) ||
+        (g_ctx.last_exit_calls != 1U)) {
+      rt_kprintf("[E] parallel: engine %u ticks %u/%u/%u\n", (unsigned)engine, (unsigned)cd[0].ticks,
+                 (unsigned)cd[1].ticks, (unsigned)cd[2].ticks);
+      return rc;
+    }
+  }
+
+  /* A child still RUNNING when the parallel settles is halted: the next entry starts it afresh */
+  for (engine = 0U; engine < 4U; engine++) {
+    static const bt_status_t halt_expected[3] = {BT_RUNNING, BT_SUCCESS, BT_SUCCESS};
+
+    bt_test_reset_ctx();
+    bt_build_parallel_halt(n, cd, &par);
+    (void)BT_EXEC_INIT(&exec, frames);
+    if ((bt_compile(&n[0], flat, BT_MAX_TEST_NODES, &def) != BT_SUCCESS) ||
+        (bt_instance_init(&def, &inst, status, cursor) != BT_SUCCESS) ||
+        ((engine == 3U) && (bt_validate(&n[0]) != BT_SUCCESS))) {
+      rt_kprintf("[E] parallel: halt tree compile failed\n");
+      return rc;
+    }
+
+    for (t = 0U; t < 3U; t++) {
+      bt_status_t s = BT_ERROR;
+
+      if ((engine == 0U) || (engine == 3U)) {
+        s = bt_tick(&n[0]);
+      } else if (engine == 1U) {
+        s = bt_tick_exec(&exec, &n[0]);
+      } else {
+        s = bt_tick_instance(&def, &inst, BT_NULL);
+      }
+
+      if (s != halt_expected[t]) {
+        rt_kprintf("[E] parallel: halt engine %u tick %u got %u\n", (unsigned)engine, (unsigned)t, (unsigned)s);
+        return rc;
+      }
+    }
+
+    if ((g_ctx.last_enter_calls != 2U) || (g_ctx.last_exit_calls != 2U)) {
+      rt_kprintf("[E] parallel: halt engine %u enter %u exit %u\n", (unsigned)engine,
+                 (unsigned)g_ctx.last_enter_calls, (unsigned)g_ctx.last_exit_calls);
+      return rc;
+    }
+  }
+
+  /* Default policy: the first failure ends the parallel, B is halted */
+  bt_build_parallel(n, cd, &par);
+  (void)bt_set_parallel(&n[1], &par, 3U, 1U);
+  if ((bt_tick(&n[1]) != BT_RUNNING) || (bt_tick(&n[1]) != BT_FAILURE) || (n[4].status != BT_FAILURE)) {
+    rt_kprintf("[E] parallel: expected FAILURE on the first failed child\n");
+    return rc;
+  }
+
+  /* Outcome known early: later children are not ticked */
+  bt_build_parallel(n, cd, &par);
+  (void)bt_set_parallel(&n[1], &par, 1U, 3U);
+  if ((bt_tick(&n[1]) != BT_SUCCESS) || (cd[1].ticks != 0U) || (cd[2].ticks != 0U)) {
+    rt_kprintf("[E] parallel: expected SUCCESS after the first child\n");
+    return rc;
+  }
+
+  if ((bt_set_parallel(&n[1], &par, 0U, 1U) != BT_ERROR) || (bt_set_parallel(&n[1], &par, 1U, 4U) != BT_ERROR) ||
+      (bt_set_parallel(&n[0], &par, 1U, 1U) != BT_ERROR) || (bt_set_parallel(&n[1], BT_NULL, 1U, 1U) != BT_ERROR) ||
+      (par.success_threshold != 1U) || (par.failure_threshold != 3U)) {
+    rt_kprintf("[E] parallel: invalid thresholds accepted\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+static rt_err_t test_timer_wheel(void) {
+  rt_err_t rc = -RT_ERROR;
+  /* Delays covering every level, the clamp beyond the top level and a 0xFFFFFFFF wrap */
+  static const uint32_t delays[] = {1U, 63U, 64U, 100U, 4095U, 4096U, 300000U, 20000000U, 40000000U};
+  static bt_timer_wheel_t wheel;
+  static bt_timer_entry_t entries[BT_COUNT_OF(delays)];
+  static bt_node_t sleepers[BT_COUNT_OF(delays)];
+  bt_test_sleeper_t script = {&wheel, 50U, 0U};
+  bt_node_t n_sleep;
+  bt_node_t n_after;
+  bt_node_t* seq_children[2];
+  bt_node_t n_seq;
+  BT_EXEC_FRAMES(frames, 2U);
+  bt_exec_t exec;
+  const uint32_t start = 0xFFFFFF00U;
+  uint32_t now = start;
+  uint32_t step = 1U;
+  uint32_t i;
+
+  (void)BT_TIMER_INIT(&wheel, entries, start);
+  for (i = 0U; i < BT_COUNT_OF(delays); i++) {
+    bt_init(&sleepers[i], BT_ACTION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+    sleepers[i].time_anchor_ms = start + delays[i];
+    if (!bt_timer_park(&wheel, &sleepers[i])) {
+      rt_kprintf("[E] timer: node %u not parked\n", (unsigned)i);
+      return rc;
+    }
+  }
+
+  /* Advance in growing, uneven steps: each node must expire exactly once its anchor is reached */
+  while (wheel.parked > 0U) {
+    now += step;
+    step = (step * 3U) + 1U;
+    (void)bt_timer_advance(&wheel, now);
+
+    for (i = 0U; i < BT_COUNT_OF(delays); i++) {
+      const bool due = (now - start) >= delays[i];
+      if (due == bt_timer_is_parked(&sleepers[i])) {
+        rt_kprintf("[E] timer: node %u (delay %u) wrong state at +%u\n", (unsigned)i, (unsigned)delays[i],
+                   (unsigned)(now - start));
+        return rc;
+      }
+    }
+  }
+
+  /* Cancel leaves the anchor alone; a due anchor is consumed instead of parked */
+  sleepers[0].time_anchor_ms = now + 10U;
+  (void)bt_timer_park(&wheel, &sleepers[0]);
+  bt_timer_cancel(&wheel, &sleepers[0]);
+  if ((wheel.parked != 0U) || bt_timer_is_parked(&sleepers[0]) || (sleepers[0].time_anchor_ms != (now + 10U)) ||
+      bt_timer_park(&wheel, &sleepers[1]) || (bt_timer_advance(&wheel, now + 20U) != 0U)) {
+    rt_kprintf("[E] timer: cancel/park bookkeeping\n");
+    return rc;
+  }
+  sleepers[0].time_anchor_ms = now;
+  if (bt_timer_park(&wheel, &sleepers[0]) || (sleepers[0].time_anchor_ms != 0U)) {
+    rt_kprintf("[E] timer: due anchor should run now\n");
+    return rc;
+  }
+
+  /* A full pool refuses to park and keeps the anchor; a freed entry is reused */
+  (void)bt_timer_init(&wheel, entries, 1U, now);
+  sleepers[0].time_anchor_ms = now + 10U;
+  sleepers[1].time_anchor_ms = now + 20U;
+  if (!bt_timer_park(&wheel, &sleepers[0]) || bt_timer_park(&wheel, &sleepers[1]) ||
+      (sleepers[1].time_anchor_ms != (now + 20U)) || (bt_timer_advance(&wheel, now + 10U) != 1U) ||
+      !bt_timer_park(&wheel, &sleepers[1]) || (bt_timer_init(&wheel, entries, 0U, now) != BT_ERROR)) {
+    rt_kprintf("[E] timer: entry pool bookkeeping\n");
+    return rc;
+  }
+  bt_timer_cancel(&wheel, &sleepers[1]);
+
+  /* Engine: a parked leaf is not ticked until its anchor expires */
+  (void)BT_TIMER_INIT(&wheel, entries, 1000U);
+  bt_init(&n_sleep, BT_ACTION, leaf_sleep_once, BT_NULL, 0U, &script);
+  bt_init(&n_after, BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  seq_children[0] = &n_sleep;
+  seq_children[1] = &n_after;
+  BT_INIT(&n_seq, BT_SEQUENCE, BT_NULL, seq_children, BT_NULL);
+  (void)BT_EXEC_INIT(&exec, frames);
+  bt_exec_set_timers(&exec, &wheel);
+
+  for (i = 0U; i < 10U; i++) {
+    (void)bt_timer_advance(&wheel, 1000U + (i * 5U));
+    if (bt_tick_exec(&exec, &n_seq) != BT_RUNNING) {
+      rt_kprintf("[E] timer: expected RUNNING while asleep\n");
+      return rc;
+    }
+  }
+  if ((script.calls != 1U) || !bt_timer_is_parked(&n_sleep)) {
+    rt_kprintf("[E] timer: sleeping leaf was ticked %u times\n", (unsigned)script.calls);
+    return rc;
+  }
+
+  (void)bt_timer_advance(&wheel, 1000U + script.delay_ms);
+  if ((bt_tick_exec(&exec, &n_seq) != BT_SUCCESS) || (script.calls != 2U)) {
+    rt_kprintf("[E] timer: leaf should finish once its anchor expired\n");
+    return rc;
+  }
+
+  /* Halting through the engine frees the entry and drops the abandoned wait */
+  script.calls = 0U;
+  if ((bt_tick_exec(&exec, &n_seq) != BT_RUNNING) || (wheel.parked != 1U) || (bt_exec_halt(BT_NULL, &n_seq) != 0U) ||
+      (bt_exec_halt(&exec, &n_seq) != 2U) || (wheel.parked != 0U) || bt_timer_is_parked(&n_sleep) ||
+      (n_sleep.time_anchor_ms != 0U)) {
+    rt_kprintf("[E] timer: halted leaf left in the wheel\n");
+    return rc;
+  }
+  if ((bt_tick_exec(&exec, &n_seq) != BT_SUCCESS) || (script.calls != 2U)) {
+    rt_kprintf("[E] timer: halted leaf not entered afresh\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+static rt_err_t test_tickless(void) {
+  rt_err_t rc = -RT_ERROR;
+  static bt_timer_wheel_t wheel;
+  static bt_timer_entry_t entries[4];
+  bt_test_sleeper_t script = {&wheel, 50U, 0U};
+  bt_node_t n_sleep;
+  bt_node_t n_after;
+  bt_node_t n_far;
+  bt_node_t* seq_children[2];
+  bt_node_t n_seq;
+  bt_test_tree_t tree;
+  BT_EXEC_FRAMES(frames, 4U);
+  bt_exec_t exec;
+  bt_wake_t wake;
+  uint32_t deadline = 0U;
+
+  (void)BT_TIMER_INIT(&wheel, entries, 5000U);
+  bt_init(&n_sleep, BT_ACTION, leaf_sleep_once, BT_NULL, 0U, &script);
+  bt_init(&n_after, BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  seq_children[0] = &n_sleep;
+  seq_children[1] = &n_after;
+  BT_INIT(&n_seq, BT_SEQUENCE, BT_NULL, seq_children, BT_NULL);
+  (void)BT_EXEC_INIT(&exec, frames);
+  bt_exec_set_timers(&exec, &wheel);
+
+  /* A node parked further away does not hide the nearer deadline */
+  bt_init(&n_far, BT_ACTION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  n_far.time_anchor_ms = 5000U + 100000U;
+  (void)bt_timer_park(&wheel, &n_far);
+
+  /* The leaf arms its anchor and is parked in the same tick */
+  if ((bt_tick_exec_next(&exec, &n_seq, &wake) != BT_RUNNING) || (wake.kind != BT_WAKE_TIMER) ||
+      (wake.deadline_ms != 5050U) || !bt_timer_is_parked(&n_sleep)) {
+    rt_kprintf("[E] tickless: expected a timer wake-up at 5050, got kind %u at %u\n", (unsigned)wake.kind,
+               (unsigned)wake.deadline_ms);
+    return rc;
+  }
+
+  /* Waking early changes nothing */
+  (void)bt_timer_advance(&wheel, 5020U);
+  if ((bt_tick_exec_next(&exec, &n_seq, &wake) != BT_RUNNING) || (wake.kind != BT_WAKE_TIMER) ||
+      (wake.deadline_ms != 5050U) || (script.calls != 1U)) {
+    rt_kprintf("[E] tickless: early wake-up should keep the deadline\n");
+    return rc;
+  }
+
+  (void)bt_timer_advance(&wheel, 5050U);
+  if ((bt_tick_exec_next(&exec, &n_seq, &wake) != BT_SUCCESS) || (wake.kind != BT_WAKE_POLL) ||
+      (script.calls != 2U)) {
+    rt_kprintf("[E] tickless: expected SUCCESS at the deadline\n");
+    return rc;
+  }
+
+  if ((!bt_timer_next_deadline(&wheel, &deadline)) || (deadline != (5000U + 100000U))) {
+    rt_kprintf("[E] tickless: far node deadline %u\n", (unsigned)deadline);
+    return rc;
+  }
+  bt_timer_cancel(&wheel, &n_far);
+
+  /* A polling leaf needs the host's regular period */
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 3U);
+  g_ctx.counter = 1U;
+  bt_exec_reset(&exec);
+  if ((bt_tick_exec_next(&exec, &tree.n_root, &wake) != BT_RUNNING) || (wake.kind != BT_WAKE_POLL)) {
+    rt_kprintf("[E] tickless: polling leaf should ask for BT_WAKE_POLL\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Coroutine leaves keep their resume point across ticks in every engine */
+static rt_err_t test_coroutine_leaf(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_test_co_t co = {3U, 4U, 0U, 0U};
+  bt_co_t co_state;
+  bt_node_t n_co;
+  bt_node_t n_after;
+  bt_node_t* seq_children[2];
+  bt_node_t n_seq;
+  bt_flat_node_t flat[3];
+  bt_flat_tree_t compiled;
+  BT_EXEC_FRAMES(frames, 4U);
+  bt_exec_t exec;
+  uint32_t engine;
+  uint32_t i;
+
+  bt_init(&n_co, BT_ACTION, leaf_co_steps, BT_NULL, 0U, &co);
+  bt_init(&n_after, BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  /* Without state the coroutine reports BT_ERROR before running a step */
+  if ((bt_tick(&n_co) != BT_ERROR) || (co.done != 0U) || (bt_set_co(&n_co, BT_NULL) != BT_ERROR) ||
+      (bt_set_co(&n_co, &co_state) != BT_SUCCESS)) {
+    rt_kprintf("[E] coroutine: leaf without state accepted\n");
+    return rc;
+  }
+  seq_children[0] = &n_co;
+  seq_children[1] = &n_after;
+  BT_INIT(&n_seq, BT_SEQUENCE, BT_NULL, seq_children, BT_NULL);
+  (void)BT_EXEC_INIT(&exec, frames);
+
+  /* One resume point cannot serve every instance of a compiled tree */
+  if (bt_compile(&n_seq, flat, BT_COUNT_OF(flat), &compiled) != BT_ERROR) {
+    rt_kprintf("[E] coroutine: compiled tree accepted a coroutine leaf\n");
+    return rc;
+  }
+
+  for (engine = 0U; engine < 2U; engine++) {
+    co.done = 0U;
+    co.ready = 0U;
+
+    /* Three steps and one wait, each a RUNNING tick */
+    for (i = 0U; i < 5U; i++) {
+      const bt_status_t s = (engine == 0U) ? bt_tick(&n_seq) : bt_tick_exec(&exec, &n_seq);
+
+      if ((s != BT_RUNNING) || (co.done != ((i < 3U) ? (i + 1U) : 3U))) {
+        rt_kprintf("[E] coroutine: engine %u tick %u status %u, %u steps\n", (unsigned)engine, (unsigned)i,
+                   (unsigned)s, (unsigned)co.done);
+        return rc;
+      }
+    }
+
+    co.ready = 1U;
+    if ((((engine == 0U) ? bt_tick(&n_seq) : bt_tick_exec(&exec, &n_seq)) != BT_SUCCESS) || (co_state.line != 0U)) {
+      rt_kprintf("[E] coroutine: engine %u did not finish after the wait\n", (unsigned)engine);
+      return rc;
+    }
+  }
+
+  /* A finished leaf starts over; so does one entered after it was reset */
+  co.done = 0U;
+  co.ready = 0U;
+  (void)bt_tick(&n_seq);
+  (void)bt_tick(&n_seq);
+  n_co.status = BT_FAILURE;
+  n_seq.status = BT_FAILURE;
+  if ((bt_tick(&n_seq) != BT_RUNNING) || (co.done != 3U) || (BT_CO_VAR(&n_co, 0U) != 0U)) {
+    rt_kprintf("[E] coroutine: re-entered leaf did not restart (%u steps)\n", (unsigned)co.done);
+    return rc;
+  }
+
+  /* Early BT_CO_RETURN */
+  co.fail_at = 1U;
+  if ((bt_tick(&n_seq) != BT_FAILURE) || (co.done != 4U) || (co_state.line != 0U)) {
+    rt_kprintf("[E] coroutine: BT_CO_RETURN did not end the leaf\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+#define BT_TEST_ASYNC_LEAVES (8U)
+
+/* ASYNC leaves resume from posted completions only, from any thread */
+static rt_err_t test_async_completion(void) {
+  rt_err_t rc = -RT_ERROR;
+  static bt_async_slot_t slots[4];
+  bt_async_queue_t queue;
+  bt_test_async_t op = {{BT_NULL, 0U}, 0U};
+  bt_test_async_t ops[BT_TEST_ASYNC_LEAVES];
+  bt_test_async_t stale;
+  bt_async_op_t op_state;
+  bt_async_op_t op_states[BT_TEST_ASYNC_LEAVES];
+  bt_parallel_t par;
+  bt_node_t n_async;
+  bt_node_t n_after;
+  bt_node_t* seq_children[2];
+  bt_node_t n_seq;
+  bt_node_t n_leaves[BT_TEST_ASYNC_LEAVES];
+  bt_node_t* par_children[BT_TEST_ASYNC_LEAVES];
+  bt_node_t n_par;
+  bt_test_producer_t producers[2];
+  pthread_t threads[2];
+  BT_EXEC_FRAMES(frames, 4U);
+  bt_exec_t exec;
+  bt_wake_t wake;
+  uint32_t i;
+
+  if ((bt_async_init(&queue, slots, 3U) != BT_ERROR) || (BT_ASYNC_INIT(&queue, slots) != BT_SUCCESS)) {
+    rt_kprintf("[E] async: capacity must be a power of two\n");
+    return rc;
+  }
+
+  bt_init(&n_async, BT_ASYNC, leaf_async_start, BT_NULL, 0U, &op);
+  bt_init(&n_after, BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  /* Operation state is required, and only ASYNC leaves take it */
+  if ((bt_tick(&n_async) != BT_ERROR) || (bt_validate(&n_async) != BT_ERROR) || (op.starts != 0U) ||
+      (bt_set_async(&n_after, &op_state) != BT_ERROR) || (bt_set_async(&n_async, BT_NULL) != BT_ERROR) ||
+      (bt_set_async(&n_async, &op_state) != BT_SUCCESS) || (bt_validate(&n_async) != BT_SUCCESS)) {
+    rt_kprintf("[E] async: leaf without operation state accepted\n");
+    return rc;
+  }
+  seq_children[0] = &n_async;
+  seq_children[1] = &n_after;
+  BT_INIT(&n_seq, BT_SEQUENCE, BT_NULL, seq_children, BT_NULL);
+  (void)BT_EXEC_INIT(&exec, frames);
+  bt_exec_set_async(&exec, &queue);
+
+  /* Started once, then idle (not polling) until the completion arrives */
+  for (i = 0U; i < 3U; i++) {
+    if ((bt_tick_exec_next(&exec, &n_seq, &wake) != BT_RUNNING) || (wake.kind != BT_WAKE_IDLE) ||
+        (op.starts != 1U) || !bt_async_pending(&n_async)) {
+      rt_kprintf("[E] async: pending leaf restarted or polled (tick %u, starts %u)\n", (unsigned)i,
+                 (unsigned)op.starts);
+      return rc;
+    }
+  }
+
+  if ((bt_async_complete(&queue, op.token, BT_RUNNING) != BT_ERROR) ||
+      (bt_async_complete(&queue, op.token, BT_SUCCESS) != BT_SUCCESS) ||
+      (bt_tick_exec(&exec, &n_seq) != BT_SUCCESS) || (op.starts != 1U)) {
+    rt_kprintf("[E] async: completion was not delivered\n");
+    return rc;
+  }
+
+  /* A completion for an abandoned operation is dropped */
+  stale = op;
+  if (bt_tick_exec(&exec, &n_seq) != BT_RUNNING) {
+    rt_kprintf("[E] async: restart failed\n");
+    return rc;
+  }
+  (void)bt_async_complete(&queue, stale.token, BT_FAILURE);
+  if ((bt_tick_exec(&exec, &n_seq) != BT_RUNNING) || (op.starts != 2U)) {
+    rt_kprintf("[E] async: stale completion was delivered\n");
+    return rc;
+  }
+
+  /* Same leaf with bt_tick(): the host drains */
+  (void)bt_async_complete(&queue, op.token, BT_FAILURE);
+  if ((bt_async_drain(&queue) != 1U) || (bt_tick(&n_seq) != BT_FAILURE)) {
+    rt_kprintf("[E] async: bt_tick did not see the drained FAILURE\n");
+    return rc;
+  }
+
+  /* A full queue rejects posts instead of blocking */
+  for (i = 0U; i < BT_COUNT_OF(slots); i++) {
+    (void)bt_async_complete(&queue, stale.token, BT_SUCCESS);
+  }
+  if ((bt_async_complete(&queue, stale.token, BT_SUCCESS) != BT_FAILURE) || (bt_async_drain(&queue) != 0U)) {
+    rt_kprintf("[E] async: full queue accepted a post\n");
+    return rc;
+  }
+
+  /* Several producer threads complete the leaves of a PARALLEL */
+  for (i = 0U; i < BT_TEST_ASYNC_LEAVES; i++) {
+    ops[i].starts = 0U;
+    bt_init(&n_leaves[i], BT_ASYNC, leaf_async_start, BT_NULL, 0U, &ops[i]);
+    (void)bt_set_async(&n_leaves[i], &op_states[i]);
+    par_children[i] = &n_leaves[i];
+  }
+  BT_INIT(&n_par, BT_PARALLEL, BT_NULL, par_children, BT_NULL);
+  (void)bt_set_parallel(&n_par, &par, BT_TEST_ASYNC_LEAVES, 1U);
+  bt_exec_reset(&exec);
+  if (bt_tick_exec(&exec, &n_par) != BT_RUNNING) {
+    rt_kprintf("[E] async: PARALLEL did not start its leaves\n");
+    return rc;
+  }
+
+  for (i = 0U; i < 2U; i++) {
+    producers[i].queue = &queue;
+    producers[i].ops = &ops[i * (BT_TEST_ASYNC_LEAVES / 2U)];
+    producers[i].count = BT_TEST_ASYNC_LEAVES / 2U;
+    producers[i].retries = 0U;
+    (void)pthread_create(&threads[i], BT_NULL, bt_test_producer, &producers[i]);
+  }
+
+  /* Tick while the producers post; the queue is smaller than the population */
+  i = 0U;
+  while ((bt_tick_exec(&exec, &n_par) == BT_RUNNING) && (i < 1000000U)) {
+    i++;
+  }
+  for (i = 0U; i < 2U; i++) {
+    (void)pthread_join(threads[i], BT_NULL);
+  }
+
+  if (n_par.status != BT_SUCCESS) {
+    rt_kprintf("[E] async: PARALLEL ended %u\n", (unsigned)n_par.status);
+    return rc;
+  }
+  for (i = 0U; i < BT_TEST_ASYNC_LEAVES; i++) {
+    if (ops[i].starts != 1U) {
+      rt_kprintf("[E] async: leaf %u started %u times\n", (unsigned)i, (unsigned)ops[i].starts);
+      return rc;
+    }
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+#define BT_TEST_TRACE_SLOTS (64U)
+#define BT_TEST_TRACE_WRITES (200000U)
+
+/* Writer thread for the concurrent snapshot check: node id = low bits of seq */
+static void* bt_test_trace_writer(void* arg) {
+  uint32_t i;
+
+  bt_trace_attach((bt_trace_ring_t*)arg);
+  for (i = 0U; i < BT_TEST_TRACE_WRITES; i++) {
+    bt_trace_emit((uint16_t)i, BT_RUNNING, BT_SUCCESS);
+  }
+  bt_trace_attach(BT_NULL);
+
+  return BT_NULL;
+}
+
+/* Compare the (node, from, to) part of two record lists */
+static bool bt_test_same_trace(const bt_trace_rec_t a[], uint32_t na, const bt_trace_rec_t b[], uint32_t nb) {
+  bool same = (na == nb);
+  uint32_t i;
+
+  for (i = 0U; same && (i < na); i++) {
+    same = (a[i].node == b[i].node) && (a[i].from == b[i].from) && (a[i].to == b[i].to);
+  }
+
+  return same;
+}
+
+/* Status transitions land in the calling thread's ring, identically per engine */
+static rt_err_t test_trace_ring(void) {
+  rt_err_t rc = -RT_ERROR;
+  static bt_trace_slot_t slots[BT_TEST_TRACE_SLOTS];
+  static bt_trace_rec_t recs[3][BT_TEST_TRACE_SLOTS];
+  bt_trace_ring_t ring;
+  uint32_t counts[3];
+  bt_test_tree_t tree;
+  bt_flat_node_t flat[BT_MAX_TEST_NODES];
+  bt_flat_tree_t def;
+  uint8_t st[BT_MAX_TEST_NODES];
+  uint16_t cur[BT_MAX_TEST_NODES];
+  bt_instance_t inst;
+  BT_EXEC_FRAMES(frames, 8U);
+  bt_exec_t exec;
+  pthread_t writer;
+  uint32_t engine;
+  uint32_t i;
+  uint32_t n;
+  uint16_t nodes = 0U;
+  FILE* f = BT_NULL;
+  uint32_t tag = 0U;
+  uint64_t hz = 0U;
+  uint64_t count = 0U;
+  bt_trace_rec_t rec;
+
+  if ((bt_trace_init(&ring, slots, 48U, 0U) != BT_ERROR) || (BT_TRACE_INIT(&ring, slots, 7U) != BT_SUCCESS)) {
+    rt_kprintf("[E] trace: capacity must be a power of two\n");
+    return rc;
+  }
+
+  /* Same tree and script through the three engines */
+  for (engine = 0U; engine < 3U; engine++) {
+    bt_test_reset_ctx();
+    bt_build_tree(&tree, 1U, 2U);
+    nodes = bt_assign_ids(&tree.n_root);
+    (void)BT_TRACE_INIT(&ring, slots, 7U);
+    bt_trace_attach(&ring);
+
+    if (engine == 2U) {
+      if ((bt_compile(&tree.n_root, flat, BT_MAX_TEST_NODES, &def) != BT_SUCCESS) ||
+          (bt_instance_init(&def, &inst, st, cur) != BT_SUCCESS)) {
+        bt_trace_attach(BT_NULL);
+        rt_kprintf("[E] trace: compile failed\n");
+        return rc;
+      }
+    } else {
+      (void)BT_EXEC_INIT(&exec, frames);
+    }
+
+    for (i = 0U; i < BT_TEST_TICKS_SHORT; i++) {
+      g_ctx.counter++;
+      if (engine == 0U) {
+        (void)bt_tick(&tree.n_root);
+      } else if (engine == 1U) {
+        (void)bt_tick_exec(&exec, &tree.n_root);
+      } else {
+        (void)bt_tick_instance(&def, &inst, BT_NULL);
+      }
+    }
+    bt_trace_attach(BT_NULL);
+    counts[engine] = bt_trace_snapshot(&ring, recs[engine], BT_TEST_TRACE_SLOTS);
+  }
+
+  if ((counts[0] == 0U) || (counts[0] == BT_TEST_TRACE_SLOTS) || !bt_test_same_trace(recs[0], counts[0], recs[1], counts[1]) ||
+      !bt_test_same_trace(recs[0], counts[0], recs[2], counts[2])) {
+    rt_kprintf("[E] trace: engines disagree (%u/%u/%u records)\n", (unsigned)counts[0], (unsigned)counts[1],
+               (unsigned)counts[2]);
+    return rc;
+  }
+  for (i = 1U; i < counts[0]; i++) {
+    if ((recs[0][i].seq != (recs[0][i - 1U].seq + 1U)) || (recs[0][i].time < recs[0][i - 1U].time) ||
+        (recs[0][i].from == recs[0][i].to) || (recs[0][i].node >= nodes)) {
+      rt_kprintf("[E] trace: bad record %u\n", (unsigned)i);
+      return rc;
+    }
+  }
+
+  /* File round trip */
+  f = tmpfile();
+  if ((f == BT_NULL) || (bt_trace_write(f, ring.tag, 1000000000ULL, recs[0], counts[0]) != BT_SUCCESS)) {
+    rt_kprintf("[E] trace: write failed\n");
+    return rc;
+  }
+  rewind(f);
+  if ((bt_trace_read_header(f, &tag, &hz, &count) != BT_SUCCESS) || (tag != 7U) || (hz != 1000000000ULL) ||
+      (count != counts[0])) {
+    (void)fclose(f);
+    rt_kprintf("[E] trace: header mismatch\n");
+    return rc;
+  }
+  for (i = 0U; i < counts[0]; i++) {
+    if ((bt_trace_read_rec(f, &rec) != BT_SUCCESS) || (rec.time != recs[0][i].time) ||
+        (rec.seq != recs[0][i].seq) || !bt_test_same_trace(&rec, 1U, &recs[0][i], 1U)) {
+      (void)fclose(f);
+      rt_kprintf("[E] trace: record %u did not round-trip\n", (unsigned)i);
+      return rc;
+    }
+  }
+  n = (bt_trace_read_rec(f, &rec) == BT_FAILURE) ? 1U : 0U;
+  (void)fclose(f);
+  if (n != 1U) {
+    rt_kprintf("[E] trace: data after the last record\n");
+    return rc;
+  }
+
+  /* Snapshots taken while another thread wraps the ring are never torn */
+  (void)BT_TRACE_INIT(&ring, slots, 1U);
+  (void)pthread_create(&writer, BT_NULL, bt_test_trace_writer, &ring);
+  do {
+    n = bt_trace_snapshot(&ring, recs[0], BT_TEST_TRACE_SLOTS);
+    for (i = 0U; i < n; i++) {
+      if ((recs[0][i].node != (uint16_t)recs[0][i].seq) ||
+          ((i > 0U) && (recs[0][i].seq != (recs[0][i - 1U].seq + 1U)))) {
+        (void)pthread_join(writer, BT_NULL);
+        rt_kprintf("[E] trace: torn snapshot at %u\n", (unsigned)i);
+        return rc;
+      }
+    }
+  } while (atomic_load_explicit(&ring.head, memory_order_relaxed) < BT_TEST_TRACE_WRITES);
+  (void)pthread_join(writer, BT_NULL);
+
+  n = bt_trace_snapshot(&ring, recs[0], BT_TEST_TRACE_SLOTS);
+  if ((n != (BT_TEST_TRACE_SLOTS - 1U)) || (recs[0][n - 1U].seq != (BT_TEST_TRACE_WRITES - 1U))) {
+    rt_kprintf("[E] trace: wrapped ring should yield the newest %u records\n", (unsigned)(BT_TEST_TRACE_SLOTS - 1U));
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Sum of a node's histogram buckets */
+static uint64_t bt_test_hist_total(const bt_profile_node_t* entry) {
+  uint64_t total = 0U;
+  uint32_t b;
+
+  for (b = 0U; b < BT_PROFILE_BUCKETS; b++) {
+    total += entry->hist[b];
+  }
+
+  return total;
+}
+
+/* Per-node counters of the recursive dispatcher (or none when compiled out) */
+static rt_err_t test_profile_counters(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_test_countdown_t cd = {2U, BT_FAILURE, 0U};
+  bt_node_t n_cond;
+  bt_node_t n_work;
+  bt_node_t* seq_children[2];
+  bt_node_t n_seq;
+  bt_profile_node_t table[3];
+  bt_profile_node_t out[3];
+  bt_profile_t prof;
+  uint32_t i;
+
+  bt_init(&n_cond, BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  bt_init(&n_work, BT_ACTION, leaf_countdown, BT_NULL, 0U, &cd);
+  seq_children[0] = &n_cond;
+  seq_children[1] = &n_work;
+  BT_INIT(&n_seq, BT_SEQUENCE, BT_NULL, seq_children, BT_NULL);
+  (void)bt_assign_ids(&n_seq);
+
+  if ((bt_profile_init(&prof, table, 0U) != BT_ERROR) || (BT_PROFILE_INIT(&prof, table) != BT_SUCCESS)) {
+    rt_kprintf("[E] profile: init checks failed\n");
+    return rc;
+  }
+
+  /* RUNNING, RUNNING, FAILURE; the condition is only ticked on entry */
+  bt_profile_attach(&prof);
+  for (i = 0U; i < 3U; i++) {
+    (void)bt_tick(&n_seq);
+  }
+  bt_profile_attach(BT_NULL);
+  (void)bt_tick(&n_seq); /* Detached: not counted */
+
+  if (bt_profile_snapshot(&prof, out, 8U) != 3U) {
+    rt_kprintf("[E] profile: snapshot size\n");
+    return rc;
+  }
+
+#if BT_PROFILE
+  if ((out[0].ticks != 3U) || (out[0].running != 2U) || (out[0].failure != 1U) || (out[1].ticks != 1U) ||
+      (out[1].success != 1U) || (out[2].ticks != 3U) || (out[2].running != 2U) || (out[2].failure != 1U) ||
+      (out[2].error != 0U)) {
+    rt_kprintf("[E] profile: tick/outcome counts %u %u %u\n", (unsigned)out[0].ticks, (unsigned)out[1].ticks,
+               (unsigned)out[2].ticks);
+    return rc;
+  }
+
+  /* Exclusive time is what the children did not use; leaves are all exclusive */
+  if ((out[0].inclusive != (out[0].exclusive + out[1].inclusive + out[2].inclusive)) ||
+      (out[1].exclusive != out[1].inclusive) || (out[2].exclusive != out[2].inclusive)) {
+    rt_kprintf("[E] profile: inclusive/exclusive mismatch\n");
+    return rc;
+  }
+
+  for (i = 0U; i < 3U; i++) {
+    if ((bt_test_hist_total(&out[i]) != out[i].ticks) || (out[i].max > out[i].inclusive) ||
+        ((out[i].max * out[i].ticks) < out[i].inclusive)) {
+      rt_kprintf("[E] profile: node %u histogram/max inconsistent\n", (unsigned)i);
+      return rc;
+    }
+  }
+
+  /* Nodes outside the table count as their parent's exclusive time */
+  prof.count = 2U;
+  bt_profile_reset(&prof);
+  n_seq.status = BT_FAILURE;
+  cd.ticks = 0U;
+  bt_profile_attach(&prof);
+  (void)bt_tick(&n_seq);
+  bt_profile_attach(BT_NULL);
+  if ((bt_profile_snapshot(&prof, out, 3U) != 2U) || (out[0].ticks != 1U) ||
+      (out[0].exclusive != (out[0].inclusive - out[1].inclusive)) || (table[2].ticks != 3U)) {
+    rt_kprintf("[E] profile: partial table\n");
+    return rc;
+  }
+#else
+  for (i = 0U; i < 3U; i++) {
+    if ((out[i].ticks != 0U) || (out[i].inclusive != 0U) || (bt_test_hist_total(&out[i]) != 0U)) {
+      rt_kprintf("[E] profile: counters changed with BT_PROFILE=0\n");
+      return rc;
+    }
+  }
+#endif
+
+  /* Reset clears every counter */
+  prof.count = 3U;
+  bt_profile_reset(&prof);
+  (void)bt_profile_snapshot(&prof, out, 3U);
+  for (i = 0U; i < 3U; i++) {
+    if ((out[i].ticks != 0U) || (out[i].exclusive != 0U) || (out[i].max != 0U)) {
+      rt_kprintf("[E] profile: reset left node %u counters\n", (unsigned)i);
+      return rc;
+    }
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Binding table for bt_build_tree(): copies of the bound source nodes */
+static uint16_t bt_test_bindings(const bt_test_tree_t* t, bt_node_t bindings[]) {
+  bindings[0] = t->n_cond_true;
+  bindings[1] = t->n_cond_false;
+  bindings[2] = t->n_cond_counter;
+  bindings[3] = t->n_action_progress;
+  bindings[4] = t->n_action_fail_succ;
+  bindings[5] = t->n_seq_inner; /* Hooks only */
+  return 6U;
+}
+
+/* Images load in place and tick like the compiled tree they were written from */
+static rt_err_t test_image_load(void) {
+  rt_err_t rc = -RT_ERROR;
+  static _Alignas(16) uint8_t copy[512];
+  bt_test_tree_t tree;
+  bt_flat_node_t flat[BT_MAX_TEST_NODES];
+  bt_flat_tree_t compiled;
+  bt_flat_tree_t image;
+  bt_flat_tree_t other;
+  bt_node_t bindings[6];
+  uint16_t binding_count = 0U;
+  bt_image_map_t map;
+  bt_instance_t inst;
+  uint8_t st[BT_MAX_TEST_NODES];
+  uint16_t cur[BT_MAX_TEST_NODES];
+  bt_status_t expected[BT_TEST_TICKS_LONG];
+  uint32_t expected_enter = 0U;
+  uint32_t expected_exit = 0U;
+  char path[] = "/tmp/bt_imageXXXXXX";
+  const int fd = mkstemp(path);
+  FILE* f = (fd >= 0) ? fdopen(fd, "w+b") : BT_NULL;
+  size_t size = 0U;
+  uint32_t i;
+
+  if (f == BT_NULL) {
+    rt_kprintf("[E] image: cannot create %s\n", path);
+    return rc;
+  }
+
+  /* Reference run through the recursive engine */
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    g_ctx.counter = (i / 5U) & 1U;
+    expected[i] = bt_tick(&tree.n_root);
+  }
+  expected_enter = g_ctx.last_enter_calls;
+  expected_exit = g_ctx.last_exit_calls;
+
+  /* A leaf without a binding cannot be written */
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  binding_count = bt_test_bindings(&tree, bindings);
+  (void)bt_compile(&tree.n_root, flat, BT_MAX_TEST_NODES, &compiled);
+  if (bt_image_write(f, &compiled, bindings, 4U) != BT_ERROR) {
+    rt_kprintf("[E] image: written with a leaf left unbound\n");
+    (void)fclose(f);
+    (void)unlink(path);
+    return rc;
+  }
+  rewind(f);
+  if ((bt_image_write(f, &compiled, bindings, binding_count) != BT_SUCCESS) || (fflush(f) != 0)) {
+    rt_kprintf("[E] image: write failed\n");
+    (void)fclose(f);
+    (void)unlink(path);
+    return rc;
+  }
+  rewind(f);
+  size = fread(copy, 1U, sizeof(copy), f);
+  (void)fclose(f);
+
+  /* Map, verify and tick the image */
+  if ((bt_image_open(path, &map, bindings, binding_count, &image) != BT_SUCCESS) || (image.count != 9U) ||
+      (image.slots != compiled.slots) || (bt_image_verify(&image) != BT_SUCCESS) ||
+      (bt_instance_init(&image, &inst, st, cur) != BT_SUCCESS)) {
+    rt_kprintf("[E] image: open/verify failed (%u bytes)\n", (unsigned)size);
+    (void)unlink(path);
+    return rc;
+  }
+  (void)unlink(path); /* The mapping outlives the name */
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    bt_status_t s;
+
+    g_ctx.counter = (i / 5U) & 1U;
+    s = bt_tick_instance(&image, &inst, BT_NULL);
+    if (s != expected[i]) {
+      rt_kprintf("[E] image: tick %u expected %u, got %u\n", (unsigned)i, (unsigned)expected[i], (unsigned)s);
+      bt_image_close(&map);
+      return rc;
+    }
+  }
+  bt_image_close(&map);
+  if ((g_ctx.last_enter_calls != expected_enter) || (g_ctx.last_exit_calls != expected_exit) ||
+      (map.base != BT_NULL)) {
+    rt_kprintf("[E] image: hook calls differ (enter %u/%u, exit %u/%u)\n", (unsigned)g_ctx.last_enter_calls,
+               (unsigned)expected_enter, (unsigned)g_ctx.last_exit_calls, (unsigned)expected_exit);
+    return rc;
+  }
+
+  /* Header checks: truncation, misalignment, short binding table, bad magic */
+  if ((bt_image_load(copy, size, bindings, binding_count, &other) != BT_SUCCESS) ||
+      (bt_image_load(copy, size - 1U, bindings, binding_count, &other) != BT_ERROR) ||
+      (bt_image_load(&copy[8], size - 8U, bindings, binding_count, &other) != BT_ERROR) ||
+      (bt_image_load(copy, size, bindings, 5U, &other) != BT_ERROR)) {
+    rt_kprintf("[E] image: header checks\n");
+    return rc;
+  }
+  copy[0] ^= 0xFFU;
+  if (bt_image_load(copy, size, bindings, binding_count, &other) != BT_ERROR) {
+    rt_kprintf("[E] image: bad magic accepted\n");
+    return rc;
+  }
+  copy[0] ^= 0xFFU;
+
+  /* Structural damage is caught by bt_image_verify() */
+  copy[sizeof(bt_image_header_t) + 2U] ^= 0x01U; /* Root's next */
+  if ((bt_image_load(copy, size, bindings, binding_count, &other) != BT_SUCCESS) ||
+      (bt_image_verify(&other) != BT_ERROR)) {
+    rt_kprintf("[E] image: corrupted node passed verification\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Same shape as bt_build_tree(), plus a tree and a model the loader must skip */
+static const char g_xml_tree[] =
+    "<?xml version=\"1.0\"?>\n"
+    "<root BTCPP_format=\"4\" main_tree_to_execute=\"Main\">\n"
+    "  <BehaviorTree ID=\"Other\">\n"
+    "    <Condition ID=\"NoSuchLeaf\"/>\n"
+    "  </BehaviorTree>\n"
+    "  <BehaviorTree ID=\"Main\">\n"
+    "    <!-- Fallback to <AlwaysTrue/> -->\n"
+    "    <Fallback name=\"root\">\n"
+    "      <Sequence>\n"
+    "        <CounterAbove/>\n"
+    "        <Sequence>\n"
+    "          <Action ID=\"Progress\" goal=\"{target}\"/>\n"
+    "          <Selector>\n"
+    "            <Condition ID='AlwaysFalse'/>\n"
+    "            <FailThenSucceed></FailThenSucceed>\n"
+    "          </Selector>\n"
+    "        </Sequence>\n"
+    "      </Sequence>\n"
+    "      <AlwaysTrue/>\n"
+    "    </Fallback>\n"
+    "  </BehaviorTree>\n"
+    "  <TreeNodesModel><Action ID=\"Progress\"/></TreeNodesModel>\n"
+    "</root>\n";
+
+/* Load text into arena and expect an error on the given line */
+static bool bt_test_xml_rejects(const char* text, const bt_registry_t* reg, uint32_t line) {
+  static void* arena[256];
+  bt_xml_result_t res;
+
+  return (bt_xml_load(text, strlen(text), reg, &g_ctx, arena, sizeof(arena), &res) == BT_ERROR) &&
+         (res.root == BT_NULL) && (res.error != BT_NULL) && (res.line == line);
+}
+
+/* XML trees resolve leaves through the registry and tick like hand-wired ones */
+static rt_err_t test_xml_loader(void) {
+  rt_err_t rc = -RT_ERROR;
+  static void* arena[256];
+  bt_registry_entry_t entries[8];
+  bt_registry_t reg;
+  bt_test_tree_t tree;
+  bt_xml_result_t res;
+  bt_status_t expected[BT_TEST_TICKS_LONG];
+  uint32_t threshold = 0U;
+  uint32_t progress = 2U;
+  size_t need = 0U;
+  uint32_t i;
+
+  if ((BT_REGISTRY_INIT(&reg, entries) != BT_SUCCESS) ||
+      (bt_registry_add(&reg, "AlwaysTrue", BT_CONDITION, leaf_cond_true, BT_NULL) != BT_SUCCESS) ||
+      (bt_registry_add(&reg, "AlwaysFalse", BT_CONDITION, leaf_cond_false, BT_NULL) != BT_SUCCESS) ||
+      (bt_registry_add(&reg, "CounterAbove", BT_CONDITION, leaf_cond_counter_gt, &threshold) != BT_SUCCESS) ||
+      (bt_registry_add(&reg, "Progress", BT_ACTION, leaf_action_progress, &progress) != BT_SUCCESS) ||
+      (bt_registry_add(&reg, "FailThenSucceed", BT_ACTION, leaf_action_fail_then_success, BT_NULL) != BT_SUCCESS)) {
+    rt_kprintf("[E] xml: registry setup failed\n");
+    return rc;
+  }
+  if ((bt_registry_add(&reg, "AlwaysTrue", BT_ACTION, leaf_cond_true, BT_NULL) != BT_ERROR) ||
+      (bt_registry_add(&reg, "Tree", BT_SEQUENCE, leaf_cond_true, BT_NULL) != BT_ERROR) ||
+      (bt_registry_find(&reg, "AlwaysTrue", 10U) == BT_NULL) ||
+      (bt_registry_find(&reg, "AlwaysTrueX", 10U) != bt_registry_find(&reg, "AlwaysTrue", 10U)) ||
+      (bt_registry_find(&reg, "Always", 6U) != BT_NULL)) {
+    rt_kprintf("[E] xml: registry accepted a duplicate or bad type, or lookup failed\n");
+    return rc;
+  }
+
+  /* Reference run through the hand-wired tree, without its hooks */
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, threshold, progress);
+  tree.n_seq_inner.on_enter = BT_NULL;
+  tree.n_seq_inner.on_exit = BT_NULL;
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    g_ctx.counter = (i / 5U) & 1U;
+    expected[i] = bt_tick(&tree.n_root);
+  }
+
+  /* Measure, then load into exactly that much arena */
+  if ((bt_xml_load(g_xml_tree, strlen(g_xml_tree), &reg, &g_ctx, BT_NULL, 0U, &res) != BT_SUCCESS) ||
+      (res.nodes != 9U) || (res.used == 0U) || (res.used > sizeof(arena))) {
+    rt_kprintf("[E] xml: measuring failed (%s at line %u)\n", (res.error != BT_NULL) ? res.error : "-",
+               (unsigned)res.line);
+    return rc;
+  }
+  need = res.used;
+  if ((bt_xml_load(g_xml_tree, strlen(g_xml_tree), &reg, &g_ctx, arena, need - sizeof(void*), &res) != BT_ERROR) ||
+      (bt_xml_load(g_xml_tree, strlen(g_xml_tree), &reg, &g_ctx, arena, need, &res) != BT_SUCCESS) ||
+      (res.root == BT_NULL) || (res.used != need) || (res.root->type != BT_SELECTOR) ||
+      (res.root->children[0]->children[0]->user_data != &threshold) || (res.root->children[1]->id != 8U)) {
+    rt_kprintf("[E] xml: load into a %u byte arena failed\n", (unsigned)need);
+    return rc;
+  }
+
+  bt_test_reset_ctx();
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    bt_status_t s;
+
+    g_ctx.counter = (i / 5U) & 1U;
+    s = bt_tick(res.root);
+    if (s != expected[i]) {
+      rt_kprintf("[E] xml: tick %u expected %u, got %u\n", (unsigned)i, (unsigned)expected[i], (unsigned)s);
+      return rc;
+    }
+  }
+
+  /* PARALLEL policy from success_count/failure_count */
+  {
+    static const char par[] = "<BehaviorTree><Parallel success_count=\"-1\" failure_count=\"2\">"
+                              "<AlwaysTrue/><AlwaysFalse/><AlwaysTrue/></Parallel></BehaviorTree>";
+
+    if ((bt_xml_load(par, strlen(par), &reg, &g_ctx, arena, sizeof(arena), &res) != BT_SUCCESS) ||
+        (res.root->type != BT_PARALLEL) || (res.root->ext == BT_NULL) ||
+        (((const bt_parallel_t*)res.root->ext)->success_threshold != 3U) ||
+        (((const bt_parallel_t*)res.root->ext)->failure_threshold != 2U) || (bt_tick(res.root) != BT_FAILURE)) {
+      rt_kprintf("[E] xml: Parallel policy not applied\n");
+      return rc;
+    }
+  }
+
+  /* BT_ASYNC leaves get their operation state from the arena */
+  {
+    static const char async[] = "<BehaviorTree><Sequence><Fetch/><AlwaysTrue/></Sequence></BehaviorTree>";
+    static bt_async_slot_t slots[4];
+    bt_async_queue_t queue;
+    bt_test_async_t op = {{BT_NULL, 0U}, 0U};
+
+    if ((bt_registry_add(&reg, "Fetch", BT_ASYNC, leaf_async_start, &op) != BT_SUCCESS) ||
+        (BT_ASYNC_INIT(&queue, slots) != BT_SUCCESS) ||
+        (bt_xml_load(async, strlen(async), &reg, &g_ctx, arena, sizeof(arena), &res) != BT_SUCCESS) ||
+        (res.root->children[0]->type != BT_ASYNC) || (res.root->children[0]->ext == BT_NULL) ||
+        (bt_validate(res.root) != BT_SUCCESS) || (bt_tick(res.root) != BT_RUNNING) || (op.starts != 1U) ||
+        (bt_async_complete(&queue, op.token, BT_SUCCESS) != BT_SUCCESS) || (bt_async_drain(&queue) != 1U) ||
+        (bt_tick(res.root) != BT_SUCCESS)) {
+      rt_kprintf("[E] xml: async leaf not loaded with operation state\n");
+      return rc;
+    }
+  }
+
+  /* Errors carry the line they were found on */
+  if ((!bt_test_xml_rejects("<root>\n<BehaviorTree>\n<Sequence>\n<Missing/>\n</Sequence>\n</BehaviorTree>\n</root>",
+                            &reg, 4U)) ||
+      (!bt_test_xml_rejects("<BehaviorTree>\n<Sequence>\n<AlwaysTrue/>\n</Fallback>\n</BehaviorTree>", &reg, 4U)) ||
+      (!bt_test_xml_rejects("<BehaviorTree>\n<Inverter><AlwaysTrue/><AlwaysTrue/></Inverter></BehaviorTree>", &reg,
+                            2U)) ||
+      (!bt_test_xml_rejects("<BehaviorTree>\n<AlwaysTrue/>\n<AlwaysTrue/></BehaviorTree>", &reg, 3U)) ||
+      (!bt_test_xml_rejects("<BehaviorTree><Parallel success_count=\"3\"><AlwaysTrue/></Parallel></BehaviorTree>",
+                            &reg, 1U)) ||
+      (!bt_test_xml_rejects("<root main_tree_to_execute=\"Main\"><BehaviorTree ID=\"Other\"><AlwaysTrue/>"
+                            "</BehaviorTree></root>",
+                            &reg, 1U)) ||
+      (!bt_test_xml_rejects("<BehaviorTree>\n<Sequence>\n<AlwaysTrue/>\n", &reg, 4U))) {
+    rt_kprintf("[E] xml: malformed input accepted or wrong error line\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* bt_validate() rejects malformed trees and its fast path ticks like bt_tick() */
+static rt_err_t test_validate(void) {
+  rt_err_t rc = -RT_ERROR;
+  static bt_node_t chain[BT_VALIDATE_MAX_DEPTH];
+  static bt_node_t* links[BT_VALIDATE_MAX_DEPTH];
+  bt_test_tree_t tree;
+  bt_node_t* kids[2];
+  bt_node_t n[3];
+  bt_parallel_t par;
+  bt_status_t expected[BT_TEST_TICKS_LONG];
+  uint32_t expected_enter = 0U;
+  uint32_t expected_exit = 0U;
+  uint32_t i;
+
+  /* Reference run through the checked path */
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    g_ctx.counter = (i / 5U) & 1U;
+    expected[i] = bt_tick(&tree.n_root);
+  }
+  expected_enter = g_ctx.last_enter_calls;
+  expected_exit = g_ctx.last_exit_calls;
+
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  if ((tree.n_root.validated) || (bt_validate(&tree.n_root) != BT_SUCCESS) || (!tree.n_root.validated) ||
+      (!tree.n_action_fail_succ.validated) || (!tree.n_selector.validated)) {
+    rt_kprintf("[E] validate: well-formed tree not flagged\n");
+    return rc;
+  }
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    bt_status_t s;
+
+    g_ctx.counter = (i / 5U) & 1U;
+    s = bt_tick(&tree.n_root);
+    if (s != expected[i]) {
+      rt_kprintf("[E] validate: tick %u expected %u, got %u\n", (unsigned)i, (unsigned)expected[i], (unsigned)s);
+      return rc;
+    }
+  }
+  if ((g_ctx.last_enter_calls != expected_enter) || (g_ctx.last_exit_calls != expected_exit)) {
+    rt_kprintf("[E] validate: hook calls differ (enter %u/%u, exit %u/%u)\n", (unsigned)g_ctx.last_enter_calls,
+               (unsigned)expected_enter, (unsigned)g_ctx.last_exit_calls, (unsigned)expected_exit);
+    return rc;
+  }
+  bt_init(&tree.n_root, BT_SELECTOR, BT_NULL, tree.n_root.children, 2U, BT_NULL);
+  if (tree.n_root.validated) {
+    rt_kprintf("[E] validate: bt_init kept the flag\n");
+    return rc;
+  }
+
+  /* Each malformed shape is rejected and leaves the root unflagged */
+  bt_init(&n[1], BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  bt_init(&n[2], BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  kids[0] = &n[1];
+  kids[1] = BT_NULL;
+  BT_INIT(&n[0], BT_SEQUENCE, BT_NULL, kids, BT_NULL);
+  if (bt_validate(&n[0]) != BT_ERROR) {
+    rt_kprintf("[E] validate: NULL child accepted\n");
+    return rc;
+  }
+  kids[1] = &n[2];
+  n[0].type = BT_INVERTER;
+  if (bt_validate(&n[0]) != BT_ERROR) {
+    rt_kprintf("[E] validate: INVERTER with two children accepted\n");
+    return rc;
+  }
+  n[0].type = (bt_node_type_t)42;
+  if (bt_validate(&n[0]) != BT_ERROR) {
+    rt_kprintf("[E] validate: unknown type accepted\n");
+    return rc;
+  }
+  n[0].type = BT_PARALLEL;
+  if (bt_validate(&n[0]) != BT_ERROR) {
+    rt_kprintf("[E] validate: PARALLEL without state accepted\n");
+    return rc;
+  }
+  (void)bt_set_parallel(&n[0], &par, 2U, 1U);
+  par.success_threshold = 3U;
+  if (bt_validate(&n[0]) != BT_ERROR) {
+    rt_kprintf("[E] validate: PARALLEL threshold above child count accepted\n");
+    return rc;
+  }
+  n[0].ext = BT_NULL;
+  n[0].type = BT_SELECTOR;
+  n[2].tick = BT_NULL;
+  if (bt_validate(&n[0]) != BT_ERROR) {
+    rt_kprintf("[E] validate: leaf without callback accepted\n");
+    return rc;
+  }
+  kids[1] = &n[0];
+  if ((bt_validate(&n[0]) != BT_ERROR) || (n[0].validated)) {
+    rt_kprintf("[E] validate: cycle accepted\n");
+    return rc;
+  }
+  kids[1] = &n[1]; /* The same node twice is not a cycle */
+  if (bt_validate(&n[0]) != BT_SUCCESS) {
+    rt_kprintf("[E] validate: shared leaf rejected\n");
+    return rc;
+  }
+
+  /* Depth: BT_VALIDATE_MAX_DEPTH levels pass, one more does not */
+  for (i = 0U; i < BT_VALIDATE_MAX_DEPTH; i++) {
+    links[i] = ((i + 1U) < BT_VALIDATE_MAX_DEPTH) ? &chain[i + 1U] : &n[1];
+    bt_init(&chain[i], BT_INVERTER, BT_NULL, &links[i], 1U, BT_NULL);
+  }
+  chain[BT_VALIDATE_MAX_DEPTH - 1U].type = BT_CONDITION;
+  chain[BT_VALIDATE_MAX_DEPTH - 1U].tick = leaf_cond_true;
+  if ((bt_validate(&chain[0]) != BT_SUCCESS) || (bt_tick(&chain[0]) != BT_FAILURE)) {
+    rt_kprintf("[E] validate: %u-level chain rejected\n", (unsigned)BT_VALIDATE_MAX_DEPTH);
+    return rc;
+  }
+  chain[BT_VALIDATE_MAX_DEPTH - 1U].type = BT_INVERTER;
+  if (bt_validate(&chain[0]) != BT_ERROR) {
+    rt_kprintf("[E] validate: chain deeper than BT_VALIDATE_MAX_DEPTH accepted\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* bt_build_tree() and bt_build_parallel() (without hooks) as constant data */
+static uint32_t g_rom_threshold = 0U;
+static uint32_t g_rom_progress = 2U;
+static bt_test_countdown_t g_rom_cd[3];
+
+#define BT_TEST_ROM_TREE(t)                                                     \
+  BT_ROM_COMPOSITE(t, root, BT_SELECTOR)                                        \
+  BT_ROM_COMPOSITE(t, outer, BT_SEQUENCE)                                       \
+  BT_ROM_LEAF(t, counter, BT_CONDITION, leaf_cond_counter_gt, &g_rom_threshold) \
+  BT_ROM_COMPOSITE(t, inner, BT_SEQUENCE)                                       \
+  BT_ROM_LEAF(t, progress, BT_ACTION, leaf_action_progress, &g_rom_progress)    \
+  BT_ROM_COMPOSITE(t, sel, BT_SELECTOR)                                         \
+  BT_ROM_LEAF(t, no, BT_CONDITION, leaf_cond_false, BT_NULL)                    \
+  BT_ROM_LEAF(t, retry, BT_ACTION, leaf_action_fail_then_success, BT_NULL)      \
+  BT_ROM_END(t, sel)                                                            \
+  BT_ROM_END(t, inner)                                                          \
+  BT_ROM_END(t, outer)                                                          \
+  BT_ROM_LEAF(t, yes, BT_CONDITION, leaf_cond_true, BT_NULL)                    \
+  BT_ROM_END(t, root)
+
+#define BT_TEST_ROM_PARALLEL(t)                              \
+  BT_ROM_COMPOSITE(t, root, BT_SEQUENCE)                     \
+  BT_ROM_PARALLEL(t, par, 2, 2)                              \
+  BT_ROM_LEAF(t, a, BT_ACTION, leaf_countdown, &g_rom_cd[0]) \
+  BT_ROM_LEAF(t, b, BT_ACTION, leaf_countdown, &g_rom_cd[1]) \
+  BT_ROM_COMPOSITE(t, inv, BT_INVERTER)                      \
+  BT_ROM_LEAF(t, c, BT_ACTION, leaf_countdown, &g_rom_cd[2]) \
+  BT_ROM_END(t, inv)                                         \
+  BT_ROM_END(t, par)                                         \
+  BT_ROM_LEAF(t, yes, BT_CONDITION, leaf_cond_true, BT_NULL) \
+  BT_ROM_END(t, root)
+
+BT_ROM_TREE(g_rom_tree, BT_TEST_ROM_TREE);
+BT_ROM_TREE(g_rom_parallel, BT_TEST_ROM_PARALLEL);
+
+/* True when a ROM tree has the layout bt_compile() gives the wired tree */
+static bool bt_test_rom_matches(const bt_flat_tree_t* rom, bt_node_t* root) {
+  bt_flat_node_t flat[BT_MAX_TEST_NODES];
+  bt_flat_tree_t compiled;
+  bool ok = (bt_compile(root, flat, BT_MAX_TEST_NODES, &compiled) == BT_SUCCESS) && (rom->count == compiled.count) &&
+            (rom->slots == compiled.slots);
+  uint16_t i;
+
+  for (i = 0U; ok && (i < rom->count); i++) {
+    const bt_flat_link_t* a = &rom->image[i].link;
+
+    ok = (a->parent == flat[i].parent) && (a->next == flat[i].next) && (a->slot == flat[i].slot) &&
+         (a->type == flat[i].type) && (a->ordinal == flat[i].ordinal) &&
+         ((a->type != (uint8_t)BT_PARALLEL) ||
+          ((rom->image[i].success_threshold == ((const bt_parallel_t*)flat[i].src->ext)->success_threshold) &&
+           (rom->image[i].failure_threshold == ((const bt_parallel_t*)flat[i].src->ext)->failure_threshold) &&
+           (rom->image[i].children == flat[i].src->children_count))) &&
+         ((rom->image[i].ref == BT_FLAT_NONE) || (rom->bindings[rom->image[i].ref].tick == flat[i].src->tick));
+  }
+
+  return ok;
+}
+
+/* Trees declared with bt_rom.h match compiled trees and tick from constant data */
+static rt_err_t test_rom_tree(void) {
+  rt_err_t rc = -RT_ERROR;
+  static const bt_status_t par_expected[3] = {BT_RUNNING, BT_RUNNING, BT_SUCCESS};
+  static uint8_t st[BT_ROM_COUNT(g_rom_tree)];
+  static uint16_t cur[BT_ROM_SLOTS(g_rom_tree)];
+  static uint8_t par_st[BT_ROM_COUNT(g_rom_parallel)];
+  static uint16_t par_cur[BT_ROM_SLOTS(g_rom_parallel)];
+  bt_test_tree_t tree;
+  bt_node_t n[7];
+  bt_parallel_t par;
+  bt_test_countdown_t cd[3];
+  bt_instance_t inst;
+  bt_status_t expected[BT_TEST_TICKS_LONG];
+  uint32_t i;
+
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, g_rom_threshold, g_rom_progress);
+  tree.n_seq_inner.on_enter = BT_NULL;
+  tree.n_seq_inner.on_exit = BT_NULL;
+  bt_build_parallel(n, cd, &par);
+  if ((!bt_test_rom_matches(&g_rom_tree, &tree.n_root)) || (!bt_test_rom_matches(&g_rom_parallel, &n[0])) ||
+      (g_rom_tree.binding_count != 5U) || (g_rom_parallel.binding_count != 4U)) {
+    rt_kprintf("[E] rom: layout differs from bt_compile()\n");
+    return rc;
+  }
+
+  /* Same statuses as the wired tree */
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    g_ctx.counter = (i / 5U) & 1U;
+    expected[i] = bt_tick(&tree.n_root);
+  }
+  bt_test_reset_ctx();
+  if (bt_instance_init(&g_rom_tree, &inst, st, cur) != BT_SUCCESS) {
+    rt_kprintf("[E] rom: instance init failed\n");
+    return rc;
+  }
+  for (i = 0U; i < BT_TEST_TICKS_LONG; i++) {
+    bt_status_t s;
+
+    g_ctx.counter = (i / 5U) & 1U;
+    s = bt_tick_instance(&g_rom_tree, &inst, &g_ctx);
+    if (s != expected[i]) {
+      rt_kprintf("[E] rom: tick %u expected %u, got %u\n", (unsigned)i, (unsigned)expected[i], (unsigned)s);
+      return rc;
+    }
+  }
+
+  /* PARALLEL policy and INVERTER from the table */
+  g_rom_cd[0] = (bt_test_countdown_t){0U, BT_SUCCESS, 0U};
+  g_rom_cd[1] = (bt_test_countdown_t){2U, BT_SUCCESS, 0U};
+  g_rom_cd[2] = (bt_test_countdown_t){1U, BT_SUCCESS, 0U};
+  if (bt_instance_init(&g_rom_parallel, &inst, par_st, par_cur) != BT_SUCCESS) {
+    rt_kprintf("[E] rom: parallel instance init failed\n");
+    return rc;
+  }
+  for (i = 0U; i < 3U; i++) {
+    const bt_status_t s = bt_tick_instance(&g_rom_parallel, &inst, BT_NULL);
+
+    if (s != par_expected[i]) {
+      rt_kprintf("[E] rom: parallel tick %u got %u\n", (unsigned)i, (unsigned)s);
+      return rc;
+    }
+  }
+  if ((g_rom_cd[0].ticks != 1U) || (g_rom_cd[1].ticks != 3U) || (g_rom_cd[2].ticks != 2U)) {
+    rt_kprintf("[E] rom: parallel ticks %u/%u/%u\n", (unsigned)g_rom_cd[0].ticks, (unsigned)g_rom_cd[1].ticks,
+               (unsigned)g_rom_cd[2].ticks);
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Generated code names every leaf callback and keeps the hooks */
+static rt_err_t test_codegen(void) {
+  rt_err_t rc = -RT_ERROR;
+  static char text[16384];
+  const bt_codegen_symbol_t symbols[5] = {{leaf_cond_true, BT_NULL, "leaf_cond_true"},
+                                          {leaf_cond_false, BT_NULL, "leaf_cond_false"},
+                                          {leaf_action_progress, BT_NULL, "leaf_action_progress"},
+                                          {leaf_action_fail_then_success, BT_NULL, "leaf_action_fail_then_success"},
+                                          {leaf_cond_counter_gt, BT_NULL, "leaf_cond_counter_gt"}};
+  const bt_codegen_symbol_t bad_symbol = {leaf_cond_true, BT_NULL, "1leaf"};
+  bt_test_tree_t tree;
+  bt_node_t n_async;
+  bt_test_async_t op;
+  FILE* f = tmpfile();
+  size_t size = 0U;
+
+  if (f == BT_NULL) {
+    rt_kprintf("[E] codegen: cannot create a temporary file\n");
+    return rc;
+  }
+
+  bt_test_reset_ctx();
+  bt_build_tree(&tree, 0U, 2U);
+  if ((bt_codegen_write(f, "bt_test", &tree.n_root, symbols, 4U) != BT_ERROR) ||
+      (bt_codegen_write(f, "bt-test", &tree.n_root, symbols, 5U) != BT_ERROR) ||
+      (bt_codegen_write(f, "bt_test", &tree.n_root, &bad_symbol, 1U) != BT_ERROR)) {
+    rt_kprintf("[E] codegen: unmatched leaf or bad identifier accepted\n");
+    (void)fclose(f);
+    return rc;
+  }
+  (void)memset(&op, 0, sizeof(op));
+  bt_init(&n_async, BT_ASYNC, leaf_async_start, BT_NULL, 0U, &op);
+  if (bt_codegen_write(f, "bt_async", &n_async, symbols, 5U) != BT_ERROR) {
+    rt_kprintf("[E] codegen: ASYNC leaf accepted\n");
+    (void)fclose(f);
+    return rc;
+  }
+
+  rewind(f);
+  if (bt_codegen_write(f, "bt_test", &tree.n_root, symbols, 5U) != BT_SUCCESS) {
+    rt_kprintf("[E] codegen: write failed\n");
+    (void)fclose(f);
+    return rc;
+  }
+  rewind(f);
+  size = fread(text, 1U, sizeof(text) - 1U, f);
+  (void)fclose(f);
+  text[size] = '\0';
+
+  if ((strstr(text, "#define bt_test_NODES (9U)") == BT_NULL) ||
+      (strstr(text, "= leaf_action_progress(node);") == BT_NULL) ||
+      (strstr(text, "(n[8]->tick == leaf_cond_true)") == BT_NULL) ||
+      (strstr(text, "node->on_enter(node);") == BT_NULL) || (strstr(text, "node->on_exit(node);") == BT_NULL) ||
+      (strstr(text, "bt_status_t bt_test_tick(bt_node_t* const n[bt_test_NODES])") == BT_NULL)) {
+    rt_kprintf("[E] codegen: unexpected output (%u bytes)\n", (unsigned)size);
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* The threaded interpreter ticks exactly like the switch engine */
+static rt_err_t test_threaded(void) {
+  rt_err_t rc = -RT_ERROR;
+  static bt_node_t deep[BT_TEST_DEEP_LEVELS + 1U];
+  static bt_node_t* deep_links[BT_TEST_DEEP_LEVELS];
+  static bt_flat_node_t flat[BT_TEST_DEEP_LEVELS + 1U];
+  static uint8_t status[BT_TEST_DEEP_LEVELS + 1U];
+  static uint8_t expected_status[BT_TEST_DEEP_LEVELS + 1U];
+  static uint16_t cursor[BT_TEST_DEEP_LEVELS + 1U];
+  bt_test_tree_t tree;
+  bt_node_t par[7];
+  bt_parallel_t par_state;
+  bt_test_countdown_t cd[3];
+  bt_flat_tree_t def;
+  bt_instance_t inst;
+  bt_status_t expected[BT_TEST_TICKS_LONG];
+  uint32_t expected_enter = 0U;
+  uint32_t expected_exit = 0U;
+  uint32_t need_ticks = 2U;
+  uint32_t shape;
+  uint32_t engine;
+  uint32_t i;
+
+  /* Mixed tree with hooks, SEQUENCE/INVERTER chain, PARALLEL; engine 0 is the reference */
+  for (shape = 0U; shape < 3U; shape++) {
+    const uint32_t ticks = (shape == 2U) ? 3U : BT_TEST_TICKS_LONG;
+
+    for (engine = 0U; engine < 3U; engine++) {
+      bt_node_t* root = BT_NULL;
+
+      bt_test_reset_ctx();
+      if (shape == 0U) {
+        bt_build_tree(&tree, 0U, 2U);
+        root = &tree.n_root;
+      } else if (shape == 1U) {
+        need_ticks = 2U;
+        root = bt_build_deep_chain(deep, deep_links, &need_ticks);
+      } else {
+        bt_build_parallel(par, cd, &par_state);
+        root = &par[0];
+      }
+      if ((bt_compile(root, flat, (uint16_t)BT_COUNT_OF(flat), &def) != BT_SUCCESS) ||
+          (bt_instance_init(&def, &inst, status, cursor) != BT_SUCCESS)) {
+        rt_kprintf("[E] threaded: shape %u compile failed\n", (unsigned)shape);
+        return rc;
+      }
+
+      for (i = 0U; i < ticks; i++) {
+        bt_status_t s = BT_ERROR;
+
+        g_ctx.counter = (i / 5U) & 1U;
+        if (engine == 0U) {
+          expected[i] = bt_tick_instance(&def, &inst, BT_NULL);
+          s = expected[i];
+        } else if (engine == 1U) {
+          s = bt_tick_instance_threaded(&def, &inst, BT_NULL);
+        } else if (bt_tick_batch_threaded(&def, &inst, BT_NULL, &s, 1U) != BT_SUCCESS) {
+          s = BT_ERROR;
+        } else {
+          /* s holds the root status */
+        }
+        if (s != expected[i]) {
+          rt_kprintf("[E] threaded: shape %u engine %u tick %u expected %u, got %u\n", (unsigned)shape,
+                     (unsigned)engine, (unsigned)i, (unsigned)expected[i], (unsigned)s);
+          return rc;
+        }
+      }
+
+      if (engine == 0U) {
+        (void)memcpy(expected_status, status, def.count);
+        expected_enter = g_ctx.last_enter_calls;
+        expected_exit = g_ctx.last_exit_calls;
+      } else if ((memcmp(expected_status, status, def.count) != 0) || (g_ctx.last_enter_calls != expected_enter) ||
+                 (g_ctx.last_exit_calls != expected_exit)) {
+        rt_kprintf("[E] threaded: shape %u engine %u node states or hook calls differ\n", (unsigned)shape,
+                   (unsigned)engine);
+        return rc;
+      } else {
+        /* Same end state */
+      }
+    }
+  }
+
+  if ((bt_tick_instance_threaded(BT_NULL, &inst, BT_NULL) != BT_ERROR) ||
+      (bt_tick_batch_threaded(&def, BT_NULL, BT_NULL, expected, 1U) != BT_ERROR)) {
+    rt_kprintf("[E] threaded: invalid arguments accepted\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* ===== Test runner & shell commands ===== */
+
+/* Tick root with bt_tick_exec() when exec is set, bt_tick() otherwise */
+static bt_status_t bt_test_tick_with(bt_exec_t* exec, bt_node_t* root) {
+  return (exec != BT_NULL) ? bt_tick_exec(exec, root) : bt_tick(root);
+}
+
+/* Guarded work under a reactive SEQUENCE, checked (engine 0), validated (1)
+ * or with bt_tick_exec() (2):
+ *   REACTIVE_SEQUENCE(guard, setup, SEQUENCE(work))
+ * The guard is re-ticked while work runs, setup is not; when the guard fails
+ * the work subtree is halted and its exit hook fires.
+ */
+static bool bt_test_reactive_sequence(uint32_t engine) {
+  bool ok = false;
+  bt_test_countdown_t guard = {0U, BT_SUCCESS, 0U};
+  bt_test_countdown_t setup = {0U, BT_SUCCESS, 0U};
+  bt_test_countdown_t work = {100U, BT_SUCCESS, 0U};
+  bt_node_t n[5];
+  bt_node_t* inner[1] = {&n[4]};
+  bt_node_t* kids[3] = {&n[1], &n[2], &n[3]};
+  bt_status_t s[3];
+  BT_EXEC_FRAMES(frames, 3U);
+  bt_exec_t exec;
+  bt_exec_t* const with = (engine == 2U) ? &exec : BT_NULL;
+
+  bt_test_reset_ctx();
+  (void)BT_EXEC_INIT(&exec, frames);
+  BT_INIT(&n[0], BT_REACTIVE_SEQUENCE, BT_NULL, kids, BT_NULL);
+  bt_init(&n[1], BT_CONDITION, leaf_countdown, BT_NULL, 0U, &guard);
+  bt_init(&n[2], BT_ACTION, leaf_countdown, BT_NULL, 0U, &setup);
+  BT_INIT(&n[3], BT_SEQUENCE, BT_NULL, inner, BT_NULL);
+  bt_init(&n[4], BT_ACTION, leaf_countdown, BT_NULL, 0U, &work);
+  n[3].on_enter = hook_on_enter;
+  n[3].on_exit = hook_on_exit;
+  if ((engine == 1U) && (bt_validate(&n[0]) != BT_SUCCESS)) {
+    rt_kprintf("[E] reactive: tree not validated\n");
+    return ok;
+  }
+
+  s[0] = bt_test_tick_with(with, &n[0]);
+  s[1] = bt_test_tick_with(with, &n[0]);
+  if ((s[0] != BT_RUNNING) || (s[1] != BT_RUNNING) || (guard.ticks != 2U) ||
+      (setup.ticks != 1U) || (work.ticks != 2U) || (g_ctx.last_enter_calls != 1U)) {
+    rt_kprintf("[E] reactive: engine %u guard not re-checked alone (guard %u, setup %u, work %u)\n",
+               (unsigned)engine, (unsigned)guard.ticks, (unsigned)setup.ticks, (unsigned)work.ticks);
+    return ok;
+  }
+
+  guard.final = BT_FAILURE;
+  s[2] = bt_test_tick_with(with, &n[0]);
+  if ((s[2] != BT_FAILURE) || (n[0].status != BT_FAILURE) || (n[0].current_child != 0U) || (work.ticks != 2U) ||
+      (n[3].status == BT_RUNNING) || (n[4].status == BT_RUNNING) || (n[3].current_child != 0U) ||
+      (g_ctx.last_exit_calls != 1U)) {
+    rt_kprintf("[E] reactive: engine %u failed guard did not halt the running child (%u)\n", (unsigned)engine,
+               (unsigned)s[2]);
+    return ok;
+  }
+
+  /* Next tick enters afresh */
+  guard.final = BT_SUCCESS;
+  if ((bt_test_tick_with(with, &n[0]) != BT_RUNNING) || (setup.ticks != 2U) || (work.ticks != 3U) ||
+      (g_ctx.last_enter_calls != 2U)) {
+    rt_kprintf("[E] reactive: sequence not re-entered after the halt\n");
+    return ok;
+  }
+
+  ok = true;
+  return ok;
+}
+
+/* Reactive composites re-check their CONDITION children while a later child runs */
+static rt_err_t test_reactive(void) {
+  rt_err_t rc = -RT_ERROR;
+  static void* arena[256];
+  bt_test_countdown_t danger = {0U, BT_FAILURE, 0U};
+  bt_test_countdown_t patrol = {100U, BT_SUCCESS, 0U};
+  bt_registry_entry_t entries[4];
+  bt_registry_t reg;
+  bt_xml_result_t res;
+  bt_flat_node_t flat[4];
+  bt_flat_tree_t compiled;
+  bt_node_t* frames[4];
+  bt_exec_t exec;
+  bt_wake_t wake;
+  bt_test_countdown_t last = {1U, BT_SUCCESS, 0U};
+  bt_node_t wide[BT_PARALLEL_MAX_CHILDREN + 9U];
+  bt_node_t* wide_kids[BT_PARALLEL_MAX_CHILDREN + 8U];
+  bt_node_t n[3];
+  bt_node_t* kids[2] = {&n[1], &n[2]};
+  const bt_codegen_symbol_t symbol = {leaf_countdown, BT_NULL, "leaf_countdown"};
+  FILE* f = BT_NULL;
+  uint32_t i;
+
+  for (i = 0U; i < 3U; i++) {
+    if (!bt_test_reactive_sequence(i)) {
+      return rc;
+    }
+  }
+
+  /* REACTIVE_SELECTOR(danger, patrol): danger appearing preempts the patrol */
+  BT_INIT(&n[0], BT_REACTIVE_SELECTOR, BT_NULL, kids, BT_NULL);
+  bt_init(&n[1], BT_CONDITION, leaf_countdown, BT_NULL, 0U, &danger);
+  bt_init(&n[2], BT_ACTION, leaf_countdown, BT_NULL, 0U, &patrol);
+  if ((bt_tick(&n[0]) != BT_RUNNING) || (bt_tick(&n[0]) != BT_RUNNING) || (danger.ticks != 2U)) {
+    rt_kprintf("[E] reactive: selector did not keep patrolling\n");
+    return rc;
+  }
+  danger.final = BT_SUCCESS;
+  if ((bt_tick(&n[0]) != BT_SUCCESS) || (n[0].current_child != 0U) || (n[2].status != BT_FAILURE) ||
+      (patrol.ticks != 2U)) {
+    rt_kprintf("[E] reactive: guard success did not preempt the running child\n");
+    return rc;
+  }
+
+  /* bt_tick_exec() re-checks the guard on each tick and asks to be polled */
+  danger.final = BT_FAILURE;
+  danger.ticks = 0U;
+  patrol.ticks = 0U;
+  (void)BT_EXEC_INIT(&exec, frames);
+  if ((bt_tick_exec_next(&exec, &n[0], &wake) != BT_RUNNING) ||
+      (bt_tick_exec_next(&exec, &n[0], &wake) != BT_RUNNING) || (wake.kind != BT_WAKE_POLL) || (danger.ticks != 2U) ||
+      (patrol.ticks != 2U)) {
+    rt_kprintf("[E] reactive: bt_tick_exec() skipped the guard\n");
+    return rc;
+  }
+  danger.final = BT_SUCCESS;
+  if ((bt_tick_exec(&exec, &n[0]) != BT_SUCCESS) || (n[2].status != BT_FAILURE) || (patrol.ticks != 2U)) {
+    rt_kprintf("[E] reactive: bt_tick_exec() guard did not preempt the running child\n");
+    return rc;
+  }
+
+  /* Compiled trees and generated code reject them */
+  f = tmpfile();
+  if ((bt_compile(&n[0], flat, BT_COUNT_OF(flat), &compiled) != BT_ERROR) ||
+      (f == BT_NULL) || (bt_codegen_write(f, "bt_test", &n[0], &symbol, 1U) != BT_ERROR)) {
+    rt_kprintf("[E] reactive: unsupported engine accepted the tree\n");
+    if (f != BT_NULL) {
+      (void)fclose(f);
+    }
+    return rc;
+  }
+  (void)fclose(f);
+
+  /* No child cap: a guard past BT_PARALLEL_MAX_CHILDREN is re-checked by both engines */
+  for (i = 0U; i < BT_COUNT_OF(wide_kids); i++) {
+    bt_init(&wide[i + 1U], BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+    wide_kids[i] = &wide[i + 1U];
+  }
+  bt_init(&wide[BT_COUNT_OF(wide_kids)], BT_ACTION, leaf_countdown, BT_NULL, 0U, &last);
+  BT_INIT(&wide[0], BT_REACTIVE_SEQUENCE, BT_NULL, wide_kids, BT_NULL);
+  for (i = 0U; i < 2U; i++) {
+    last.ticks = 0U;
+    wide[BT_PARALLEL_MAX_CHILDREN + 4U].tick = leaf_cond_true;
+    if ((bt_validate(&wide[0]) != BT_SUCCESS) ||
+        (((i == 0U) ? bt_tick(&wide[0]) : bt_tick_exec(&exec, &wide[0])) != BT_RUNNING)) {
+      rt_kprintf("[E] reactive: %u children rejected\n", (unsigned)BT_COUNT_OF(wide_kids));
+      return rc;
+    }
+    wide[BT_PARALLEL_MAX_CHILDREN + 4U].tick = leaf_cond_false;
+    if ((((i == 0U) ? bt_tick(&wide[0]) : bt_tick_exec(&exec, &wide[0])) != BT_FAILURE) ||
+        (wide[0].current_child != (uint16_t)(BT_PARALLEL_MAX_CHILDREN + 3U)) || (last.ticks != 1U)) {
+      rt_kprintf("[E] reactive: guard %u not re-checked\n", (unsigned)(BT_PARALLEL_MAX_CHILDREN + 3U));
+      return rc;
+    }
+  }
+
+  /* XML elements */
+  {
+    static const char xml[] = "<BehaviorTree><ReactiveFallback><Danger/><ReactiveSequence><Danger/><Patrol/>"
+                              "</ReactiveSequence></ReactiveFallback></BehaviorTree>";
+
+    if ((BT_REGISTRY_INIT(&reg, entries) != BT_SUCCESS) ||
+        (bt_registry_add(&reg, "Danger", BT_CONDITION, leaf_countdown, &danger) != BT_SUCCESS) ||
+        (bt_registry_add(&reg, "Patrol", BT_ACTION, leaf_countdown, &patrol) != BT_SUCCESS) ||
+        (bt_xml_load(xml, strlen(xml), &reg, &g_ctx, arena, sizeof(arena), &res) != BT_SUCCESS) ||
+        (res.root->type != BT_REACTIVE_SELECTOR) || (res.root->children[1]->type != BT_REACTIVE_SEQUENCE)) {
+      rt_kprintf("[E] reactive: XML elements not loaded\n");
+      return rc;
+    }
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* bt_halt() resets only the RUNNING path and fires its exit hooks */
+static rt_err_t test_halt(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_test_co_t co = {5U, 6U, 0U, 0U};
+  bt_co_t co_state;
+  bt_test_countdown_t work = {100U, BT_SUCCESS, 0U};
+  bt_test_countdown_t tail = {0U, BT_SUCCESS, 0U};
+  bt_node_t n[7];
+  bt_parallel_t par;
+  bt_node_t* root_kids[3] = {&n[1], &n[2], &n[6]};
+  bt_node_t* par_kids[2] = {&n[3], &n[4]};
+  bt_node_t* seq_kids[1] = {&n[5]};
+  bt_node_t* frames[4];
+  bt_exec_t exec;
+  uint32_t i;
+
+  /* SEQUENCE(cond_true, PARALLEL(coroutine, SEQUENCE(work)), tail), hooks on composites */
+  bt_test_reset_ctx();
+  BT_INIT(&n[0], BT_SEQUENCE, BT_NULL, root_kids, BT_NULL);
+  bt_init(&n[1], BT_CONDITION, leaf_cond_true, BT_NULL, 0U, BT_NULL);
+  BT_INIT(&n[2], BT_PARALLEL, BT_NULL, par_kids, BT_NULL);
+  (void)bt_set_parallel(&n[2], &par, 2U, 1U);
+  bt_init(&n[3], BT_ACTION, leaf_co_steps, BT_NULL, 0U, &co);
+  (void)bt_set_co(&n[3], &co_state);
+  BT_INIT(&n[4], BT_SEQUENCE, BT_NULL, seq_kids, BT_NULL);
+  bt_init(&n[5], BT_ACTION, leaf_countdown, BT_NULL, 0U, &work);
+  bt_init(&n[6], BT_ACTION, leaf_countdown, BT_NULL, 0U, &tail);
+  for (i = 0U; i < 7U; i++) {
+    n[i].on_enter = hook_on_enter;
+    n[i].on_exit = hook_on_exit;
+  }
+
+  if ((bt_tick(&n[0]) != BT_RUNNING) || (bt_tick(&n[0]) != BT_RUNNING) || (co.done != 2U) ||
+      (n[0].current_child != 1U) || (g_ctx.last_enter_calls != 3U)) {
+    rt_kprintf("[E] halt: tree did not start running\n");
+    return rc;
+  }
+  if ((bt_halt(&n[0]) != 5U) || (g_ctx.last_exit_calls != 3U) || (n[1].status != BT_SUCCESS) ||
+      (n[6].status != BT_FAILURE) || (tail.ticks != 0U)) {
+    rt_kprintf("[E] halt: walked more than the RUNNING path (exits %u)\n", (unsigned)g_ctx.last_exit_calls);
+    return rc;
+  }
+  for (i = 0U; i < 7U; i++) {
+    if ((n[i].status == BT_RUNNING) || (n[i].current_child != 0U) || (par.done_mask != 0U)) {
+      rt_kprintf("[E] halt: node %u left RUNNING or with progress\n", (unsigned)i);
+      return rc;
+    }
+  }
+  if ((bt_halt(&n[0]) != 0U) || (bt_halt(BT_NULL) != 0U) || (g_ctx.last_exit_calls != 3U)) {
+    rt_kprintf("[E] halt: idle tree halted again\n");
+    return rc;
+  }
+
+  /* The next tick enters everything afresh; the coroutine restarts */
+  if ((bt_tick(&n[0]) != BT_RUNNING) || (g_ctx.last_enter_calls != 6U) || (co.done != 3U) ||
+      (BT_CO_VAR(&n[3], 0U) != 0U)) {
+    rt_kprintf("[E] halt: halted tree not re-entered\n");
+    return rc;
+  }
+
+  /* Halting a branch leaves its RUNNING parent to re-enter it */
+  if ((bt_halt(&n[4]) != 2U) || (n[2].status != BT_RUNNING) || (g_ctx.last_exit_calls != 4U) ||
+      (bt_tick(&n[0]) != BT_RUNNING) || (g_ctx.last_enter_calls != 7U) || (n[4].status != BT_RUNNING)) {
+    rt_kprintf("[E] halt: branch halt did not re-enter the branch\n");
+    return rc;
+  }
+  (void)bt_halt(&n[0]);
+
+  /* bt_tick_exec() does not resume a cached path through a halted leaf */
+  if ((bt_exec_init(&exec, frames, BT_COUNT_OF(frames)) != BT_SUCCESS) || (bt_tick_exec(&exec, &n[4]) != BT_RUNNING) ||
+      (exec.path_len != 2U) || (bt_halt(&n[4]) != 2U) || (bt_tick_exec(&exec, &n[4]) != BT_RUNNING) ||
+      (g_ctx.last_enter_calls != 9U)) {
+    rt_kprintf("[E] halt: iterative engine resumed a halted path\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* bt_watch_round() ticks only trees whose keys changed, that poll, whose
+ * timer is due or that were woken */
+static rt_err_t test_watch(void) {
+  rt_err_t rc = -RT_ERROR;
+  static bt_timer_wheel_t wheel;
+  static bt_timer_entry_t entries[4];
+  bt_test_sleeper_t sleeper = {&wheel, 50U, 0U};
+  bt_test_countdown_t attack = {2U, BT_SUCCESS, 0U};
+  bt_test_countdown_t idle = {0U, BT_FAILURE, 0U};
+  uint32_t threshold = 0U;
+  bt_node_t a[3];
+  bt_node_t* a_kids[2] = {&a[1], &a[2]};
+  bt_node_t b;
+  bt_node_t c;
+  bt_node_t* frames[3][4];
+  bt_exec_t exec[3];
+  bt_watch_tree_t trees[3];
+  bt_watch_t watch;
+  /* Trees ticked by rounds 1..7 */
+  static const uint32_t expected[7] = {3U, 0U, 1U, 1U, 1U, 0U, 1U};
+  uint32_t got[7];
+  uint32_t i;
+
+  /* a: SEQUENCE(counter > 0 reading key 0, attack); b: condition on key 1;
+   * c: action sleeping 50 ms on the wheel */
+  bt_test_reset_ctx();
+  (void)BT_TIMER_INIT(&wheel, entries, 1000U);
+  BT_INIT(&a[0], BT_SEQUENCE, BT_NULL, a_kids, BT_NULL);
+  bt_init(&a[1], BT_CONDITION, leaf_cond_counter_gt, BT_NULL, 0U, &threshold);
+  bt_init(&a[2], BT_ACTION, leaf_countdown, BT_NULL, 0U, &attack);
+  a[1].blackboard = &g_ctx;
+  a[1].reads = BT_KEY(0U);
+  bt_init(&b, BT_CONDITION, leaf_countdown, BT_NULL, 0U, &idle);
+  b.reads = BT_KEY(1U);
+  bt_init(&c, BT_ACTION, leaf_sleep_once, BT_NULL, 0U, &sleeper);
+  for (i = 0U; i < 3U; i++) {
+    (void)bt_exec_init(&exec[i], frames[i], 4U);
+  }
+  bt_exec_set_timers(&exec[2], &wheel);
+  if ((bt_watch_bind(&trees[0], &exec[0], &a[0]) != BT_SUCCESS) ||
+      (bt_watch_bind(&trees[1], &exec[1], &b) != BT_SUCCESS) ||
+      (bt_watch_bind(&trees[2], &exec[2], &c) != BT_SUCCESS) ||
+      (bt_watch_bind(&trees[0], BT_NULL, &a[0]) != BT_ERROR) || (bt_watch_init(&watch, BT_NULL, 1U) != BT_ERROR) ||
+      (bt_watch_init(&watch, trees, 3U) != BT_SUCCESS) || (trees[0].watched != BT_KEY(0U)) ||
+      (bt_watch_keys(&c) != 0U) || (bt_watch_round(BT_NULL) != 0U)) {
+    rt_kprintf("[E] watch: setup failed\n");
+    return rc;
+  }
+
+  got[0] = bt_watch_round(&watch); /* First tick of every tree; c parks */
+  got[1] = bt_watch_round(&watch); /* Quiet */
+  g_ctx.counter = 1U;
+  bt_watch_touch(&watch, BT_KEY(0U));
+  got[2] = bt_watch_round(&watch); /* a starts attacking */
+  got[3] = bt_watch_round(&watch); /* a polls */
+  got[4] = bt_watch_round(&watch); /* a finishes */
+  got[5] = bt_watch_round(&watch); /* Quiet again */
+  (void)bt_timer_advance(&wheel, 1050U);
+  got[6] = bt_watch_round(&watch); /* c's anchor expired */
+  for (i = 0U; i < 7U; i++) {
+    if (got[i] != expected[i]) {
+      rt_kprintf("[E] watch: round %u ticked %u trees, expected %u\n", (unsigned)(i + 1U), (unsigned)got[i],
+                 (unsigned)expected[i]);
+      return rc;
+    }
+  }
+  if ((trees[0].status != BT_SUCCESS) || (attack.ticks != 3U) || (idle.ticks != 1U) ||
+      (trees[2].status != BT_SUCCESS) || (sleeper.calls != 2U) || (watch.ticked != 7U) || (watch.skipped != 14U)) {
+    rt_kprintf("[E] watch: wrong statuses or counters (attack %u, idle %u, sleeper %u)\n", (unsigned)attack.ticks,
+               (unsigned)idle.ticks, (unsigned)sleeper.calls);
+    return rc;
+  }
+
+  /* Wake-ups (as from an async queue's notify hook) and aliased keys */
+  bt_watch_notify(&trees[1]);
+  if ((bt_watch_round(&watch) != 1U) || (idle.ticks != 2U) || (bt_watch_round(&watch) != 0U)) {
+    rt_kprintf("[E] watch: woken tree not ticked once\n");
+    return rc;
+  }
+  bt_watch_touch(&watch, BT_KEY(65U));
+  if ((bt_watch_round(&watch) != 1U) || (idle.ticks != 3U) || (attack.ticks != 3U)) {
+    rt_kprintf("[E] watch: key 65 did not map onto key 1\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Keys of the typed blackboard test, in declaration order */
+enum { BT_TEST_KEY_DIST = 0, BT_TEST_KEY_HP, BT_TEST_KEY_ALERT, BT_TEST_KEY_TARGET };
+
+/* CONDITION: SUCCESS while the typed blackboard's distance is below 10 */
+static bt_status_t leaf_bb_near(bt_node_t* node) {
+  bt_status_t result = BT_ERROR;
+  float dist = 0.0f;
+
+  if (bt_blackboard_get_f32((const bt_blackboard_t*)node->blackboard, BT_TEST_KEY_DIST, &dist) == BT_SUCCESS) {
+    result = (dist < 10.0f) ? BT_SUCCESS : BT_FAILURE;
+  } else {
+    result = BT_ERROR;
+  }
+
+  return result;
+}
+
+/* Typed blackboard: ids, interning, typed access and change tracking */
+static rt_err_t test_blackboard(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_bb_slot_t slots[4];
+  bt_bb_name_t names[8];
+  bt_blackboard_t bb;
+  bt_node_t cond;
+  float dist = 0.0f;
+  int32_t hp = 0;
+  bool alert = false;
+  void* target = BT_NULL;
+  uint32_t version = 0U;
+
+  if ((bt_blackboard_init(&bb, slots, 4U, names, 4U) != BT_ERROR) ||
+      (bt_blackboard_init(&bb, slots, 4U, names, 6U) != BT_ERROR) ||
+      (bt_blackboard_init(&bb, slots, 0U, BT_NULL, 0U) != BT_ERROR) ||
+      (BT_BLACKBOARD_INIT(&bb, slots, names) != BT_SUCCESS)) {
+    rt_kprintf("[E] blackboard: init accepted a bad name index\n");
+    return rc;
+  }
+
+  /* Ids follow declaration order; a name is interned once per type */
+  if ((bt_blackboard_declare(&bb, "dist", BT_BB_F32) != BT_TEST_KEY_DIST) ||
+      (bt_blackboard_declare(&bb, "hp", BT_BB_I32) != BT_TEST_KEY_HP) ||
+      (bt_blackboard_declare(&bb, "alert", BT_BB_BOOL) != BT_TEST_KEY_ALERT) ||
+      (bt_blackboard_declare(&bb, "hp", BT_BB_I32) != BT_TEST_KEY_HP) ||
+      (bt_blackboard_declare(&bb, "hp", BT_BB_F32) != BT_BB_NO_KEY) ||
+      (bt_blackboard_declare(&bb, "", BT_BB_F32) != BT_BB_NO_KEY) ||
+      (bt_blackboard_declare(&bb, "bad", (bt_bb_type_t)0) != BT_BB_NO_KEY) ||
+      (bt_blackboard_declare(&bb, BT_NULL, BT_BB_PTR) != BT_TEST_KEY_TARGET) ||
+      (bt_blackboard_declare(&bb, "full", BT_BB_U32) != BT_BB_NO_KEY) ||
+      (bt_blackboard_find(&bb, "alertness", 5U) != BT_TEST_KEY_ALERT) ||
+      (bt_blackboard_find(&bb, "target", 6U) != BT_BB_NO_KEY)) {
+    rt_kprintf("[E] blackboard: key ids not assigned or interned as declared\n");
+    return rc;
+  }
+
+  /* Typed access; a change bumps the version and marks the key */
+  if ((bt_blackboard_version(&bb, BT_TEST_KEY_DIST) != 0U) || (bt_blackboard_changes(&bb) != 0U) ||
+      (bt_blackboard_set_f32(&bb, BT_TEST_KEY_DIST, 12.5f) != BT_SUCCESS) ||
+      (bt_blackboard_set_i32(&bb, BT_TEST_KEY_HP, -3) != BT_SUCCESS) ||
+      (bt_blackboard_set_bool(&bb, BT_TEST_KEY_ALERT, true) != BT_SUCCESS) ||
+      (bt_blackboard_set_ptr(&bb, BT_TEST_KEY_TARGET, &cond) != BT_SUCCESS) ||
+      (bt_blackboard_set_u32(&bb, BT_TEST_KEY_HP, 3U) != BT_ERROR) ||
+      (bt_blackboard_set_f32(&bb, BT_TEST_KEY_TARGET + 1U, 1.0f) != BT_ERROR) ||
+      (bt_blackboard_get_f32(&bb, BT_TEST_KEY_DIST, &dist) != BT_SUCCESS) || (dist != 12.5f) ||
+      (bt_blackboard_get_i32(&bb, BT_TEST_KEY_HP, &hp) != BT_SUCCESS) || (hp != -3) ||
+      (bt_blackboard_get_bool(&bb, BT_TEST_KEY_ALERT, &alert) != BT_SUCCESS) || (!alert) ||
+      (bt_blackboard_get_ptr(&bb, BT_TEST_KEY_TARGET, &target) != BT_SUCCESS) || (target != &cond) ||
+      (bt_blackboard_get_i32(&bb, BT_TEST_KEY_DIST, &hp) != BT_ERROR) || (hp != -3)) {
+    rt_kprintf("[E] blackboard: typed access failed\n");
+    return rc;
+  }
+  version = bt_blackboard_version(&bb, BT_TEST_KEY_DIST);
+  if ((version != 1U) ||
+      (bt_blackboard_changes(&bb) !=
+       (BT_KEY(BT_TEST_KEY_DIST) | BT_KEY(BT_TEST_KEY_HP) | BT_KEY(BT_TEST_KEY_ALERT) | BT_KEY(BT_TEST_KEY_TARGET))) ||
+      (bt_blackboard_set_f32(&bb, BT_TEST_KEY_DIST, 12.5f) != BT_SUCCESS) ||
+      (bt_blackboard_version(&bb, BT_TEST_KEY_DIST) != version) || (bt_blackboard_changes(&bb) != 0U) ||
+      (bt_blackboard_touch(&bb, BT_TEST_KEY_TARGET) != BT_SUCCESS) ||
+      (bt_blackboard_changes(&bb) != BT_KEY(BT_TEST_KEY_TARGET)) ||
+      (bt_blackboard_version(&bb, BT_TEST_KEY_TARGET) != 2U)) {
+    rt_kprintf("[E] blackboard: versions or change set wrong\n");
+    return rc;
+  }
+
+  /* A condition reads it through node->blackboard */
+  bt_init(&cond, BT_CONDITION, leaf_bb_near, BT_NULL, 0U, BT_NULL);
+  cond.blackboard = &bb;
+  if ((bt_tick(&cond) != BT_FAILURE) || (bt_blackboard_set_f32(&bb, BT_TEST_KEY_DIST, 4.0f) != BT_SUCCESS) ||
+      (bt_tick(&cond) != BT_SUCCESS)) {
+    rt_kprintf("[E] blackboard: condition did not see the write\n");
+    return rc;
+  }
+
+  /* Without a name index keys are used by id only */
+  if ((bt_blackboard_init(&bb, slots, 4U, BT_NULL, 0U) != BT_SUCCESS) ||
+      (bt_blackboard_declare(&bb, BT_NULL, BT_BB_U32) != 0U) ||
+      (bt_blackboard_declare(&bb, "named", BT_BB_U32) != BT_BB_NO_KEY) ||
+      (bt_blackboard_find(&bb, "named", 5U) != BT_BB_NO_KEY)) {
+    rt_kprintf("[E] blackboard: id-only blackboard misbehaved\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
+
+/* Subscriber of the blackboard subscription test */
+typedef struct {
+  uint32_t calls;
+  bt_keys_t keys;        /* Keys of the last call */
+  bt_blackboard_t* bb;   /* Written from the callback when not NULL */
+  bt_bb_sub_id_t cancel; /* Unsubscribed from the callback when valid */
+} bt_test_subscriber_t;
+
+static void bt_test_on_change(void* ctx, bt_keys_t keys) {
+  bt_test_subscriber_t* sub = (bt_test_subscriber_t*)ctx;
+
+  sub->calls++;
+  sub->keys = keys;
+  if (sub->bb != BT_NULL) {
+    (void)bt_blackboard_set_i32(sub->bb, BT_TEST_KEY_HP, (int32_t)sub->calls);
+    (void)bt_blackboard_unsubscribe(sub->bb, sub->cancel);
+  } else {
+    /* Observe only */
+  }
+}
+
+/* Blackboard subscriptions: one coalesced call per flush, waking bt_watch trees */
+static rt_err_t test_blackboard_subscribe(void) {
+  rt_err_t rc = -RT_ERROR;
+  bt_bb_slot_t slots[4];
+  bt_bb_sub_t subs[3];
+  bt_blackboard_t bb;
+  bt_test_subscriber_t dist = {0U, 0U, BT_NULL, BT_BB_NO_SUB};
+  bt_test_subscriber_t any = {0U, 0U, BT_NULL, BT_BB_NO_SUB};
+  bt_test_countdown_t idle = {0U, BT_SUCCESS, 0U};
+  bt_node_t leaf;
+  bt_node_t* frames[2];
+  bt_exec_t exec;
+  bt_watch_tree_t tree;
+  bt_watch_t watch;
+  bt_bb_sub_id_t dist_sub = BT_BB_NO_SUB;
+  bt_bb_sub_id_t any_sub = BT_BB_NO_SUB;
+  bt_keys_t batch = 0U;
+  uint32_t i;
+
+  if ((bt_blackboard_init(&bb, slots, 4U, BT_NULL, 0U) != BT_SUCCESS) ||
+      (bt_blackboard_declare(&bb, BT_NULL, BT_BB_F32) != BT_TEST_KEY_DIST) ||
+      (bt_blackboard_declare(&bb, BT_NULL, BT_BB_I32) != BT_TEST_KEY_HP) ||
+      (bt_blackboard_subscribe(&bb, BT_KEY(BT_TEST_KEY_DIST), bt_test_on_change, &dist) != BT_BB_NO_SUB) ||
+      (bt_blackboard_subscribers(&bb, subs, 0U) != BT_ERROR) ||
+      (bt_blackboard_subscribers(&bb, subs, 3U) != BT_SUCCESS) ||
+      (bt_blackboard_subscribe(&bb, 0U, bt_test_on_change, &dist) != BT_BB_NO_SUB) ||
+      (bt_blackboard_subscribe(&bb, BT_KEY(BT_TEST_KEY_DIST), BT_NULL, &dist) != BT_BB_NO_SUB)) {
+    rt_kprintf("[E] subscribe: setup accepted bad arguments\n");
+    return rc;
+  }
+  dist_sub = bt_blackboard_subscribe(&bb, BT_KEY(BT_TEST_KEY_DIST), bt_test_on_change, &dist);
+  any_sub = bt_blackboard_subscribe(&bb, BT_KEY(BT_TEST_KEY_DIST) | BT_KEY(BT_TEST_KEY_HP), bt_test_on_change, &any);
+  if ((dist_sub == BT_BB_NO_SUB) || (any_sub == BT_BB_NO_SUB) || (dist_sub == any_sub)) {
+    rt_kprintf("[E] subscribe: subscriptions not added\n");
+    return rc;
+  }
+
+  /* Many writes, one call per interested subscriber with the changed subset */
+  for (i = 0U; i < 10U; i++) {
+    (void)bt_blackboard_set_f32(&bb, BT_TEST_KEY_DIST, (float)i);
+  }
+  (void)bt_blackboard_set_i32(&bb, BT_TEST_KEY_HP, 7);
+  batch = bt_blackboard_flush(&bb);
+  if ((batch != (BT_KEY(BT_TEST_KEY_DIST) | BT_KEY(BT_TEST_KEY_HP))) || (dist.calls != 1U) ||
+      (dist.keys != BT_KEY(BT_TEST_KEY_DIST)) || (any.calls != 1U) || (any.keys != batch) ||
+      (bt_blackboard_flush(&bb) != 0U) || (dist.calls != 1U) || (any.calls != 1U)) {
+    rt_kprintf("[E] subscribe: batch not coalesced (dist %u, any %u calls)\n", (unsigned)dist.calls,
+               (unsigned)any.calls);
+    return rc;
+  }
+
+  /* Only the subscriber of a changed key is called; an unchanged write is silent */
+  (void)bt_blackboard_set_i32(&bb, BT_TEST_KEY_HP, 7);
+  (void)bt_blackboard_set_i32(&bb, BT_TEST_KEY_HP, 8);
+  if ((bt_blackboard_flush(&bb) != BT_KEY(BT_TEST_KEY_HP)) || (dist.calls != 1U) || (any.calls != 2U) ||
+      (bt_blackboard_set_i32(&bb, BT_TEST_KEY_HP, 8) != BT_SUCCESS) || (bt_blackboard_flush(&bb) != 0U) ||
+      (any.calls != 2U)) {
+    rt_kprintf("[E] subscribe: unrelated or unchanged keys notified\n");
+    return rc;
+  }
+
+  /* A callback that writes and unsubscribes a later entry: the write goes to
+   * the next batch and the removed entry is not called */
+  dist.bb = &bb;
+  dist.cancel = any_sub;
+  (void)bt_blackboard_set_f32(&bb, BT_TEST_KEY_DIST, 100.0f);
+  if ((bt_blackboard_flush(&bb) != BT_KEY(BT_TEST_KEY_DIST)) || (dist.calls != 2U) || (any.calls != 2U) ||
+      (bt_blackboard_changes(&bb) != BT_KEY(BT_TEST_KEY_HP)) ||
+      (bt_blackboard_unsubscribe(&bb, any_sub) != BT_ERROR) || (bt_blackboard_unsubscribe(&bb, 3U) != BT_ERROR) ||
+      (bt_blackboard_unsubscribe(&bb, dist_sub) != BT_SUCCESS)) {
+    rt_kprintf("[E] subscribe: reentrant write or unsubscribe mishandled\n");
+    return rc;
+  }
+
+  /* A reused entry gets a new handle; the old one no longer removes it */
+  any_sub = bt_blackboard_subscribe(&bb, BT_KEY(BT_TEST_KEY_DIST), bt_test_on_change, &any);
+  if ((any_sub == BT_BB_NO_SUB) || ((any_sub & 0xFFFFU) != (dist_sub & 0xFFFFU)) || (any_sub == dist_sub) ||
+      (bt_blackboard_unsubscribe(&bb, dist_sub) != BT_ERROR) ||
+      (bt_blackboard_unsubscribe(&bb, any_sub) != BT_SUCCESS)) {
+    rt_kprintf("[E] subscribe: stale handle removed a reused entry\n");
+    return rc;
+  }
+
+  /* A subscription wakes a finished bt_watch tree that declares no reads */
+  bt_init(&leaf, BT_ACTION, leaf_countdown, BT_NULL, 0U, &idle);
+  (void)bt_exec_init(&exec, frames, 2U);
+  if ((bt_watch_bind(&tree, &exec, &leaf) != BT_SUCCESS) || (bt_watch_init(&watch, &tree, 1U) != BT_SUCCESS) ||
+      (bt_watch_round(&watch) != 1U) || (bt_watch_round(&watch) != 0U) ||
+      (bt_blackboard_subscribe(&bb, BT_KEY(BT_TEST_KEY_HP), bt_blackboard_wake, &tree) == BT_BB_NO_SUB)) {
+    rt_kprintf("[E] subscribe: watch setup failed\n");
+    return rc;
+  }
+  (void)bt_blackboard_set_i32(&bb, BT_TEST_KEY_HP, 1);
+  bt_watch_touch(&watch, bt_blackboard_flush(&bb));
+  if ((bt_watch_round(&watch) != 1U) || (bt_watch_round(&watch) != 0U) || (idle.ticks != 2U)) {
+    rt_kprintf("[E] subscribe: notification did not wake the tree\n");
+    return rc;
+  }
+
+  rc = RT_EOK;
+  return rc;
+}
 
 typedef struct {
   const char* name;
@@ -486,7 +3246,31 @@ static const bt_case_t g_cases[] = {{"Basic Sequence", test_basic_sequence, "Bas
                                     {"Inverter", test_inverter_semantics, "INVERTER semantics"},
                                     {"Error Cases", test_error_cases, "Invalid usage handling"},
                                     {"Stress", test_stress, "Repeated ticks under variation"},
-                                    {"Performance", test_performance, "Throughput of simple SEQUENCE"}};
+                                    {"Performance", test_performance, "Throughput of simple SEQUENCE"},
+                                    {"Compiled", test_compiled_equivalence, "Flat compiled tree matches bt_tick"},
+                                    {"Exec", test_exec_iterative, "Iterative engine with bounded frame stack"},
+                                    {"Resume", test_resume_running_path, "Resume at the cached RUNNING leaf"},
+                                    {"Instances", test_shared_definition, "Per-agent state over one definition"},
+                                    {"Batch", test_batch_tick, "bt_tick_batch matches per-agent ticks"},
+                                    {"Executor", test_executor, "Work-stealing executor matches sequential ticks"},
+                                    {"Parallel", test_parallel, "PARALLEL thresholds across all engines"},
+                                    {"Timers", test_timer_wheel, "Timer wheel parks nodes until their anchor"},
+                                    {"Tickless", test_tickless, "Next wake-up deadline from the timer wheel"},
+                                    {"Async", test_async_completion, "ASYNC leaves resumed by posted completions"},
+                                    {"Coroutine", test_coroutine_leaf, "Coroutine leaves resume after each yield"},
+                                    {"Trace", test_trace_ring, "Status transitions recorded in a per-thread ring"},
+                                    {"Profile", test_profile_counters, "Per-node tick counters and timings"},
+                                    {"Image", test_image_load, "Tree images mapped and ticked in place"},
+                                    {"XML", test_xml_loader, "Trees loaded from XML through a name registry"},
+                                    {"Validate", test_validate, "Validated trees tick through the unchecked path"},
+                                    {"ROM", test_rom_tree, "Trees declared as constant data"},
+                                    {"Codegen", test_codegen, "C code generated for a fixed tree"},
+                                    {"Threaded", test_threaded, "Computed-goto interpreter matches the switch engine"},
+                                    {"Reactive", test_reactive, "Reactive composites re-check guards and halt"},
+                                    {"Halt", test_halt, "bt_halt() resets the RUNNING path only"},
+                                    {"Watch", test_watch, "Event-driven rounds skip trees with unchanged inputs"},
+                                    {"Blackboard", test_blackboard, "Typed blackboard with key ids and versions"},
+                                    {"Subscribe", test_blackboard_subscribe, "Batched blackboard notifications"}};
 
 static void bt_run_one(const bt_case_t* c) {
   if (c == BT_NULL) {
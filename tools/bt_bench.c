@@ -0,0 +1,670 @@
+/*
+ * bt_bench.c
+ *
+ * Dispatch benchmark over synthetic trees and agent populations.
+ *
+ * Usage:
+ *   bt_bench [options]
+ *     -s shape   deep | wide | balanced | degenerate | mixed | all (default all)
+ *     -e engine  flat | threaded | executor | tick | valid | iter (default flat)
+ *     -d depth   levels of deep/balanced/degenerate/mixed trees (default 32/3/32/5)
+ *     -w width   leaves of the wide tree (default 64)
+ *     -b branch  children per composite of the balanced and mixed trees (default 4, at most 32 with mixed)
+ *     -r pct     percentage of leaf ticks returning RUNNING (default 20)
+ *     -f pct     percentage of leaf ticks returning FAILURE (default 10)
+ *     -a n       single population size (default: 1, 10, ... up to -A)
+ *     -A n       largest population of the default sweep (default 1000000)
+ *     -n n       agent ticks per measurement (default 1000000)
+ *     -j n       executor workers (default: online CPUs)
+ *     -S seed    leaf outcome seed (default 1)
+ *     -o fmt     csv | json (default csv)
+ *
+ * Shapes (composites alternate SEQUENCE/SELECTOR by level):
+ *   deep        a chain of single-child composites ending in one leaf
+ *   wide        one composite over `width` leaves
+ *   balanced    every composite has `branch` children, leaves on the last level
+ *   degenerate  a comb: every composite has a leaf and the next composite
+ *   mixed       like balanced, but composites cycle SEQUENCE, SELECTOR,
+ *               PARALLEL and single-child INVERTER, and leaves alternate
+ *               ACTION/CONDITION, so consecutive nodes rarely share a type
+ *
+ * Engines: flat ticks compiled instances with bt_tick_batch(), threaded with
+ * bt_tick_batch_threaded() (computed-goto dispatch), executor
+ * spreads them over bt_executor_t workers, tick and iter run one wired tree
+ * per agent through bt_tick() and bt_tick_exec(), and valid runs bt_tick()
+ * on trees flagged by bt_validate().
+ *
+ * Each leaf draws its outcome from a per-agent xorshift generator, so a
+ * given seed yields the same tick sequence on every engine. Nodes visited
+ * counts leaf calls plus the composites on their paths; it is measured in an
+ * untimed calibration pass over the same sequence. One warm-up round precedes
+ * every measurement. Results go to stdout, one record per shape and
+ * population.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bt.h"
+#include "bt_exec.h"
+#include "bt_executor.h"
+#include "bt_flat.h"
+#include "bt_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ===== Configuration ===== */
+
+#define BENCH_FORMAT_VERSION (1U)
+#define BENCH_MAX_SWEEP (1000000U)
+
+typedef enum { BENCH_DEEP = 0, BENCH_WIDE, BENCH_BALANCED, BENCH_DEGENERATE, BENCH_MIXED, BENCH_SHAPES } bench_shape_t;
+
+typedef enum {
+  BENCH_FLAT = 0,
+  BENCH_THREADED,
+  BENCH_EXECUTOR,
+  BENCH_TICK,
+  BENCH_VALID,
+  BENCH_ITER,
+  BENCH_ENGINES
+} bench_engine_t;
+
+static const char* const g_shape_names[BENCH_SHAPES] = {"deep", "wide", "balanced", "degenerate", "mixed"};
+static const char* const g_engine_names[BENCH_ENGINES] = {"flat", "threaded", "executor", "tick", "valid", "iter"};
+
+typedef struct {
+  int shape;        /* bench_shape_t, or BENCH_SHAPES for all */
+  int engine;       /* bench_engine_t */
+  uint32_t depth;   /* 0 = shape default */
+  uint32_t width;   /* Wide tree leaves */
+  uint32_t branch;  /* Balanced tree fan-out */
+  uint32_t running; /* Percent of RUNNING leaf ticks */
+  uint32_t failure; /* Percent of FAILURE leaf ticks */
+  uint32_t agents;  /* 0 = sweep */
+  uint32_t max_agents;
+  uint64_t work;    /* Agent ticks per measurement */
+  uint16_t workers;
+  uint32_t seed;
+  int json;
+} bench_opts_t;
+
+/* One measurement */
+typedef struct {
+  bench_shape_t shape;
+  uint32_t depth;
+  uint16_t nodes;
+  uint32_t agents;
+  uint32_t rounds;
+  uint64_t ticks;
+  uint64_t visits;
+  uint64_t elapsed_ns;
+} bench_result_t;
+
+/* ===== Leaves ===== */
+
+/* Per-agent blackboard */
+typedef struct {
+  uint32_t rng; /* xorshift32 state, never 0 */
+} bench_agent_t;
+
+static uint32_t g_running_cut; /* Draws below this return RUNNING */
+static uint32_t g_failure_cut; /* Draws below this (and not RUNNING) return FAILURE */
+
+/* Calibration pass state */
+static const bt_flat_tree_t* g_calib_def;
+static uint32_t* g_stamp;
+static uint32_t g_epoch;
+static uint64_t g_visits;
+
+static bt_status_t bench_leaf(bt_node_t* node) {
+  bench_agent_t* agent = (bench_agent_t*)node->blackboard;
+  bt_status_t result = BT_SUCCESS;
+  uint32_t x = agent->rng;
+
+  x ^= x << 13U;
+  x ^= x >> 17U;
+  x ^= x << 5U;
+  agent->rng = x;
+
+  if (x < g_running_cut) {
+    result = BT_RUNNING;
+  } else if (x < g_failure_cut) {
+    result = BT_FAILURE;
+  } else {
+    result = BT_SUCCESS;
+  }
+
+  return result;
+}
+
+/* Same outcome as bench_leaf, and count this leaf and its not yet counted
+ * ancestors for the current tick.
+ */
+static bt_status_t bench_leaf_count(bt_node_t* node) {
+  uint16_t i = node->id;
+
+  while ((i != BT_FLAT_NONE) && (g_stamp[i] != g_epoch)) {
+    g_stamp[i] = g_epoch;
+    g_visits++;
+    i = g_calib_def->nodes[i].parent;
+  }
+
+  return bench_leaf(node);
+}
+
+/* ===== Tree generation ===== */
+
+/* Composite types of the mixed shape, by pre-order position */
+static const bt_node_type_t g_mixed_types[4] = {BT_SEQUENCE, BT_SELECTOR, BT_PARALLEL, BT_INVERTER};
+
+/* Node storage filled in pre-order; with nodes == NULL only counts */
+typedef struct {
+  bench_shape_t shape;
+  uint32_t depth;
+  uint32_t width;
+  uint32_t branch;
+  bt_tick_fn leaf;
+  void* blackboard;
+  bt_node_t* nodes;
+  bt_node_t** kids;
+  bt_parallel_t* pars; /* Indexed like nodes; used by PARALLEL nodes */
+  uint32_t node_count;
+  uint32_t kid_count;
+} bench_pool_t;
+
+static bt_node_t* bench_build(bench_pool_t* pool, uint32_t level) {
+  bt_node_t* node = (pool->nodes != NULL) ? &pool->nodes[pool->node_count] : NULL;
+  bt_node_t** kids = (pool->kids != NULL) ? &pool->kids[pool->kid_count] : NULL;
+  const bool last = ((level + 1U) >= pool->depth);
+  const uint32_t index = pool->node_count; /* Pre-order position */
+  bt_node_type_t type = ((level % 2U) == 0U) ? BT_SEQUENCE : BT_SELECTOR;
+  uint32_t n = 0U;
+  uint32_t i;
+
+  switch (pool->shape) {
+    case BENCH_DEEP:
+      n = last ? 0U : 1U;
+      break;
+    case BENCH_WIDE:
+      n = (level == 0U) ? pool->width : 0U;
+      break;
+    case BENCH_BALANCED:
+      n = last ? 0U : pool->branch;
+      break;
+    case BENCH_MIXED:
+      type = g_mixed_types[index % 4U];
+      n = last ? 0U : ((type == BT_INVERTER) ? 1U : pool->branch);
+      break;
+    default: /* BENCH_DEGENERATE */
+      n = last ? 0U : 2U;
+      break;
+  }
+
+  pool->node_count++;
+  pool->kid_count += n;
+
+  if (n == 0U) {
+    if (node != NULL) {
+      type = ((pool->shape == BENCH_MIXED) && ((index % 2U) != 0U)) ? BT_CONDITION : BT_ACTION;
+      bt_init(node, type, pool->leaf, BT_NULL, 0U, BT_NULL);
+    }
+  } else {
+    for (i = 0U; i < n; i++) {
+      bt_node_t* child = NULL;
+
+      if ((pool->shape == BENCH_DEGENERATE) && (i == 0U)) {
+        const uint32_t depth = pool->depth;
+
+        pool->depth = level + 2U; /* Force a leaf */
+        child = bench_build(pool, level + 1U);
+        pool->depth = depth;
+      } else {
+        child = bench_build(pool, level + 1U);
+      }
+      if (kids != NULL) {
+        kids[i] = child;
+      }
+    }
+    if (node != NULL) {
+      bt_init(node, type, BT_NULL, kids, (uint16_t)n, BT_NULL);
+      if (type == BT_PARALLEL) {
+        (void)bt_set_parallel(node, &pool->pars[index], (uint16_t)n, 1U); /* All must succeed */
+      }
+    }
+  }
+
+  if (node != NULL) {
+    node->blackboard = pool->blackboard;
+  }
+
+  return node;
+}
+
+/* Size a pool (counting pass) and allocate count copies of its storage. */
+static bool bench_pool_alloc(bench_pool_t* pool, uint32_t count) {
+  pool->nodes = NULL;
+  pool->kids = NULL;
+  pool->pars = NULL;
+  pool->node_count = 0U;
+  pool->kid_count = 0U;
+  (void)bench_build(pool, 0U);
+
+  pool->nodes = (bt_node_t*)calloc((size_t)pool->node_count * count, sizeof(bt_node_t));
+  pool->kids = (bt_node_t**)calloc(((size_t)pool->kid_count * count) + 1U, sizeof(bt_node_t*));
+  pool->pars = (bt_parallel_t*)calloc((size_t)pool->node_count * count, sizeof(bt_parallel_t));
+
+  return (pool->nodes != NULL) && (pool->kids != NULL) && (pool->pars != NULL);
+}
+
+/* Build copy k of the tree into a pool sized by bench_pool_alloc(). */
+static bt_node_t* bench_pool_tree(bench_pool_t* pool, uint32_t k, void* blackboard) {
+  bench_pool_t view = *pool;
+  bt_node_t* root = NULL;
+
+  view.nodes = &pool->nodes[(size_t)pool->node_count * k];
+  view.kids = &pool->kids[(size_t)pool->kid_count * k];
+  view.pars = &pool->pars[(size_t)pool->node_count * k];
+  view.node_count = 0U;
+  view.kid_count = 0U;
+  view.blackboard = blackboard;
+  root = bench_build(&view, 0U);
+  (void)bt_assign_ids(root);
+
+  return root;
+}
+
+static void bench_pool_free(bench_pool_t* pool) {
+  free(pool->nodes);
+  free(pool->kids);
+  free(pool->pars);
+  pool->nodes = NULL;
+  pool->kids = NULL;
+  pool->pars = NULL;
+}
+
+/* ===== Measurement ===== */
+
+static void bench_seed(bench_agent_t agents[], uint32_t count, uint32_t seed) {
+  uint32_t i;
+
+  for (i = 0U; i < count; i++) {
+    uint32_t x = (seed ^ (i * 0x9E3779B9U)) + i;
+
+    agents[i].rng = (x != 0U) ? x : 0x2545F491U;
+  }
+}
+
+static void bench_instances(const bt_flat_tree_t* def, bt_instance_t states[], uint8_t* status, uint16_t* cursor,
+                            uint32_t count) {
+  uint32_t i;
+
+  for (i = 0U; i < count; i++) {
+    (void)bt_instance_init(def, &states[i], &status[(size_t)def->count * i],
+                           (def->slots > 0U) ? &cursor[(size_t)def->slots * i] : NULL);
+  }
+}
+
+static bool bench_run(const bench_opts_t* opts, bench_shape_t shape, uint32_t agents, bench_result_t* res) {
+  static bt_executor_t executor;
+  bench_pool_t tpl;
+  bench_pool_t calib;
+  bench_pool_t wired;
+  bt_flat_node_t* flat = NULL;
+  bt_flat_node_t* calib_flat = NULL;
+  bt_flat_tree_t def;
+  bt_flat_tree_t calib_def;
+  bench_agent_t* bb = NULL;
+  void** bbs = NULL;
+  bt_instance_t* states = NULL;
+  uint8_t* status = NULL;
+  uint16_t* cursor = NULL;
+  bt_status_t* results = NULL;
+  bt_node_t** roots = NULL;
+  bt_exec_t* execs = NULL;
+  bt_node_t** frames = NULL;
+  bool ok = true;
+  uint32_t r;
+  uint32_t i;
+
+  (void)memset(&tpl, 0, sizeof(tpl));
+  tpl.shape = shape;
+  tpl.width = opts->width;
+  tpl.branch = opts->branch;
+  tpl.leaf = bench_leaf;
+  if (opts->depth != 0U) {
+    tpl.depth = opts->depth;
+  } else {
+    tpl.depth = (shape == BENCH_BALANCED) ? 3U : ((shape == BENCH_MIXED) ? 5U : 32U);
+  }
+  tpl.depth = (shape == BENCH_WIDE) ? 2U : tpl.depth;
+  calib = tpl;
+  calib.leaf = bench_leaf_count;
+  (void)memset(&wired, 0, sizeof(wired));
+  (void)memset(&def, 0, sizeof(def));
+
+  res->shape = shape;
+  res->depth = tpl.depth;
+  res->agents = agents;
+  res->rounds = (uint32_t)((opts->work > agents) ? (opts->work / agents) : 1U);
+  res->ticks = (uint64_t)res->rounds * agents;
+
+  /* Compile the timed and the calibration definitions */
+  ok = bench_pool_alloc(&tpl, 1U) && bench_pool_alloc(&calib, 1U) && (tpl.node_count < BT_FLAT_MAX_NODES);
+  if (ok) {
+    flat = (bt_flat_node_t*)calloc(tpl.node_count, sizeof(bt_flat_node_t));
+    calib_flat = (bt_flat_node_t*)calloc(tpl.node_count, sizeof(bt_flat_node_t));
+    g_stamp = (uint32_t*)calloc(tpl.node_count, sizeof(uint32_t));
+    ok = (flat != NULL) && (calib_flat != NULL) && (g_stamp != NULL) &&
+         (bt_compile(bench_pool_tree(&tpl, 0U, NULL), flat, (uint16_t)tpl.node_count, &def) == BT_SUCCESS) &&
+         (bt_compile(bench_pool_tree(&calib, 0U, NULL), calib_flat, (uint16_t)tpl.node_count, &calib_def) ==
+          BT_SUCCESS);
+  }
+  res->nodes = def.count;
+
+  /* Per-agent state */
+  if (ok) {
+    bb = (bench_agent_t*)calloc(agents, sizeof(bench_agent_t));
+    bbs = (void**)calloc(agents, sizeof(void*));
+    states = (bt_instance_t*)calloc(agents, sizeof(bt_instance_t));
+    status = (uint8_t*)calloc((size_t)def.count * agents, sizeof(uint8_t));
+    cursor = (uint16_t*)calloc(((size_t)def.slots * agents) + 1U, sizeof(uint16_t));
+    results = (bt_status_t*)calloc(agents, sizeof(bt_status_t));
+    ok = (bb != NULL) && (bbs != NULL) && (states != NULL) && (status != NULL) && (cursor != NULL) &&
+         (results != NULL);
+    for (i = 0U; ok && (i < agents); i++) {
+      bbs[i] = &bb[i];
+    }
+  }
+
+  /* Calibration: count visits over the same outcome sequence */
+  if (ok) {
+    bench_seed(bb, agents, opts->seed);
+    bench_instances(&calib_def, states, status, cursor, agents);
+    g_calib_def = &calib_def;
+    g_epoch = 0U;
+    for (r = 0U; r <= res->rounds; r++) {
+      g_visits = (r == 1U) ? 0U : g_visits; /* Round 0 is the warm-up */
+      for (i = 0U; i < agents; i++) {
+        g_epoch++;
+        (void)bt_tick_instance(&calib_def, &states[i], bbs[i]);
+      }
+    }
+    res->visits = g_visits;
+  }
+
+  /* Engine-specific setup */
+  if (ok && ((opts->engine == BENCH_TICK) || (opts->engine == BENCH_VALID) || (opts->engine == BENCH_ITER))) {
+    wired = tpl;
+    ok = bench_pool_alloc(&wired, agents);
+    roots = (bt_node_t**)calloc(agents, sizeof(bt_node_t*));
+    execs = (bt_exec_t*)calloc(agents, sizeof(bt_exec_t));
+    frames = (bt_node_t**)calloc((size_t)tpl.depth * agents, sizeof(bt_node_t*));
+    ok = ok && (roots != NULL) && (execs != NULL) && (frames != NULL);
+    for (i = 0U; ok && (i < agents); i++) {
+      roots[i] = bench_pool_tree(&wired, i, &bb[i]);
+      ok = (opts->engine != BENCH_VALID) || (bt_validate(roots[i]) == BT_SUCCESS);
+      (void)bt_exec_init(&execs[i], &frames[(size_t)tpl.depth * i], (uint16_t)tpl.depth);
+    }
+  } else if (ok && (opts->engine == BENCH_EXECUTOR)) {
+    bench_instances(&def, states, status, cursor, agents);
+    ok = (bt_executor_start(&executor, opts->workers, &def, states, bbs, results, agents, 0U) == BT_SUCCESS);
+  } else if (ok) {
+    bench_instances(&def, states, status, cursor, agents);
+  } else {
+    /* Setup failed */
+  }
+
+  /* Warm-up round, then the timed rounds */
+  if (ok) {
+    uint64_t t0 = 0U;
+
+    bench_seed(bb, agents, opts->seed);
+    for (r = 0U; r <= res->rounds; r++) {
+      t0 = (r == 1U) ? bt_trace_clock_ns() : t0;
+      switch (opts->engine) {
+        case BENCH_EXECUTOR:
+          (void)bt_executor_tick_all(&executor);
+          break;
+        case BENCH_TICK:
+        case BENCH_VALID:
+          for (i = 0U; i < agents; i++) {
+            results[i] = bt_tick(roots[i]);
+          }
+          break;
+        case BENCH_ITER:
+          for (i = 0U; i < agents; i++) {
+            results[i] = bt_tick_exec(&execs[i], roots[i]);
+          }
+          break;
+        case BENCH_THREADED:
+          (void)bt_tick_batch_threaded(&def, states, bbs, results, agents);
+          break;
+        default:
+          (void)bt_tick_batch(&def, states, bbs, results, agents);
+          break;
+      }
+    }
+    res->elapsed_ns = bt_trace_clock_ns() - t0;
+
+    if (opts->engine == BENCH_EXECUTOR) {
+      bt_executor_stop(&executor);
+    }
+  }
+
+  bench_pool_free(&tpl);
+  bench_pool_free(&calib);
+  bench_pool_free(&wired);
+  free(flat);
+  free(calib_flat);
+  free(g_stamp);
+  g_stamp = NULL;
+  free(bb);
+  free(bbs);
+  free(states);
+  free(status);
+  free(cursor);
+  free(results);
+  free(roots);
+  free(execs);
+  free(frames);
+
+  return ok;
+}
+
+/* ===== Output ===== */
+
+static void bench_print(const bench_opts_t* opts, const bench_result_t* res, bool first) {
+  const double seconds = (double)res->elapsed_ns / 1e9;
+  const double ns_tick = (double)res->elapsed_ns / (double)res->ticks;
+  const double ticks_s = (seconds > 0.0) ? ((double)res->ticks / seconds) : 0.0;
+  const double nodes_s = (seconds > 0.0) ? ((double)res->visits / seconds) : 0.0;
+
+  if (opts->json != 0) {
+    (void)printf("%s\n    {\"shape\": \"%s\", \"engine\": \"%s\", \"nodes\": %u, \"depth\": %u, \"agents\": %u, "
+                 "\"rounds\": %u, \"ticks\": %llu, \"seconds\": %.6f, \"ns_per_tick\": %.2f, "
+                 "\"ticks_per_sec\": %.0f, \"nodes_visited\": %llu, \"nodes_per_sec\": %.0f}",
+                 first ? "" : ",", g_shape_names[res->shape], g_engine_names[opts->engine], (unsigned)res->nodes,
+                 (unsigned)res->depth, (unsigned)res->agents, (unsigned)res->rounds, (unsigned long long)res->ticks,
+                 seconds, ns_tick, ticks_s, (unsigned long long)res->visits, nodes_s);
+  } else {
+    (void)printf("%s,%s,%u,%u,%u,%u,%u,%u,%llu,%.6f,%.2f,%.0f,%llu,%.0f\n", g_shape_names[res->shape],
+                 g_engine_names[opts->engine], (unsigned)res->nodes, (unsigned)res->depth, (unsigned)res->agents,
+                 (unsigned)opts->running, (unsigned)opts->failure, (unsigned)res->rounds,
+                 (unsigned long long)res->ticks, seconds, ns_tick, ticks_s, (unsigned long long)res->visits, nodes_s);
+  }
+}
+
+static void bench_usage(const char* argv0) {
+  (void)fprintf(stderr,
+                "usage: %s [-s deep|wide|balanced|degenerate|mixed|all] [-e flat|threaded|executor|tick|valid|iter] "
+                "[-d depth] [-w width] [-b branch] [-r running%%] [-f failure%%] [-a agents] [-A max_agents] "
+                "[-n ticks] [-j workers] [-S seed] [-o csv|json]\n",
+                argv0);
+}
+
+static int bench_lookup(const char* const names[], int count, const char* name) {
+  int found = -1;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    found = ((found < 0) && (strcmp(names[i], name) == 0)) ? i : found;
+  }
+
+  return found;
+}
+
+static bool bench_parse(int argc, char** argv, bench_opts_t* opts) {
+  bool ok = true;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int opt;
+
+  opts->shape = BENCH_SHAPES;
+  opts->engine = BENCH_FLAT;
+  opts->depth = 0U;
+  opts->width = 64U;
+  opts->branch = 4U;
+  opts->running = 20U;
+  opts->failure = 10U;
+  opts->agents = 0U;
+  opts->max_agents = BENCH_MAX_SWEEP;
+  opts->work = 1000000U;
+  cpus = (cpus > (long)BT_EXECUTOR_MAX_WORKERS) ? (long)BT_EXECUTOR_MAX_WORKERS : cpus;
+  opts->workers = (uint16_t)((cpus < 1L) ? 1L : cpus);
+  opts->seed = 1U;
+  opts->json = 0;
+
+  while (ok && ((opt = getopt(argc, argv, "s:e:d:w:b:r:f:a:A:n:j:S:o:")) != -1)) {
+    const unsigned long v = (optarg != NULL) ? strtoul(optarg, NULL, 0) : 0UL;
+
+    switch (opt) {
+      case 's':
+        opts->shape = (strcmp(optarg, "all") == 0) ? BENCH_SHAPES : bench_lookup(g_shape_names, BENCH_SHAPES, optarg);
+        ok = (opts->shape >= 0);
+        break;
+      case 'e':
+        opts->engine = bench_lookup(g_engine_names, BENCH_ENGINES, optarg);
+        ok = (opts->engine >= 0);
+        break;
+      case 'd':
+        opts->depth = (uint32_t)v;
+        ok = (v >= 2UL) && (v <= BT_FLAT_MAX_DEPTH) && (v <= BT_EXEC_MAX_DEPTH);
+        break;
+      case 'w':
+        opts->width = (uint32_t)v;
+        ok = (v >= 1UL) && (v < BT_FLAT_MAX_NODES);
+        break;
+      case 'b':
+        opts->branch = (uint32_t)v;
+        ok = (v >= 1UL) && (v < BT_FLAT_MAX_NODES);
+        break;
+      case 'r':
+        opts->running = (uint32_t)v;
+        ok = (v <= 100UL);
+        break;
+      case 'f':
+        opts->failure = (uint32_t)v;
+        ok = (v <= 100UL);
+        break;
+      case 'a':
+        opts->agents = (uint32_t)v;
+        ok = (v >= 1UL) && (v <= 0xFFFFFFFFUL);
+        break;
+      case 'A':
+        opts->max_agents = (uint32_t)v;
+        ok = (v >= 1UL) && (v <= 0xFFFFFFFFUL);
+        break;
+      case 'n':
+        opts->work = (uint64_t)v;
+        ok = (v >= 1UL);
+        break;
+      case 'j':
+        opts->workers = (uint16_t)v;
+        ok = (v >= 1UL) && (v <= BT_EXECUTOR_MAX_WORKERS);
+        break;
+      case 'S':
+        opts->seed = (uint32_t)v;
+        break;
+      case 'o':
+        opts->json = (strcmp(optarg, "json") == 0) ? 1 : 0;
+        ok = (opts->json != 0) || (strcmp(optarg, "csv") == 0);
+        break;
+      default:
+        ok = false;
+        break;
+    }
+  }
+
+  ok = ok && (optind == argc) && ((opts->running + opts->failure) <= 100U);
+  if (ok && (opts->branch > BT_PARALLEL_MAX_CHILDREN) &&
+      ((opts->shape == (int)BENCH_MIXED) || (opts->shape == (int)BENCH_SHAPES))) {
+    (void)fprintf(stderr, "%s: -b %u exceeds %u, the most children a PARALLEL node of the mixed shape can have\n",
+                  argv[0], (unsigned)opts->branch, (unsigned)BT_PARALLEL_MAX_CHILDREN);
+    ok = false;
+  }
+
+  return ok;
+}
+
+/* ===== Main ===== */
+
+int main(int argc, char** argv) {
+  bench_opts_t opts;
+  bool first = true;
+  int rc = 0;
+
+  if (!bench_parse(argc, argv, &opts)) {
+    bench_usage(argv[0]);
+    rc = 2;
+  } else {
+    int shape;
+
+    /* Outcome cut points on the full 32-bit range */
+    g_running_cut = (uint32_t)(((uint64_t)opts.running << 32U) / 100U);
+    g_failure_cut = (uint32_t)((((uint64_t)opts.running + opts.failure) << 32U) / 100U);
+    g_failure_cut = ((opts.running + opts.failure) >= 100U) ? 0xFFFFFFFFU : g_failure_cut;
+    g_running_cut = (opts.running >= 100U) ? 0xFFFFFFFFU : g_running_cut;
+
+    if (opts.json != 0) {
+      (void)printf("{\n  \"version\": %u,\n  \"running_pct\": %u,\n  \"failure_pct\": %u,\n  \"seed\": %u,\n"
+                   "  \"workers\": %u,\n  \"results\": [",
+                   (unsigned)BENCH_FORMAT_VERSION, (unsigned)opts.running, (unsigned)opts.failure,
+                   (unsigned)opts.seed, (unsigned)opts.workers);
+    } else {
+      (void)printf("shape,engine,nodes,depth,agents,running_pct,failure_pct,rounds,ticks,seconds,ns_per_tick,"
+                   "ticks_per_sec,nodes_visited,nodes_per_sec\n");
+    }
+
+    for (shape = 0; shape < BENCH_SHAPES; shape++) {
+      uint32_t agents = (opts.agents != 0U) ? opts.agents : 1U;
+
+      while ((opts.shape == BENCH_SHAPES) || (opts.shape == shape)) {
+        bench_result_t res;
+
+        (void)memset(&res, 0, sizeof(res));
+        if (bench_run(&opts, (bench_shape_t)shape, agents, &res)) {
+          bench_print(&opts, &res, first);
+          first = false;
+        } else {
+          (void)fprintf(stderr, "%s: %s tree with %u agents skipped (invalid tree or out of memory)\n", argv[0],
+                        g_shape_names[shape], (unsigned)agents);
+          rc = 1;
+        }
+        (void)fflush(stdout);
+
+        if ((opts.agents != 0U) || (agents >= opts.max_agents) || (agents > (0xFFFFFFFFU / 10U))) {
+          break;
+        }
+        agents = ((agents * 10U) < opts.max_agents) ? (agents * 10U) : opts.max_agents;
+      }
+    }
+
+    if (opts.json != 0) {
+      (void)printf("\n  ]\n}\n");
+    }
+  }
+
+  return rc;
+}
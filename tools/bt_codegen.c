@@ -0,0 +1,340 @@
+/*
+ * bt_codegen.c
+ *
+ * Generate C code for a tree in the XML format of bt_xml.h (see
+ * bt_codegen.h for the generated interface).
+ *
+ * Usage:
+ *   bt_codegen [-n name] [-o out.c] [-t] tree.xml Leaf[=symbol]...
+ *     -n name   prefix of the generated identifiers (default "bt_tree")
+ *     -o out.c  output file (default stdout)
+ *     -t        test mode: also emit stub leaves, the XML text and a main()
+ *               that ticks the generated code and bt_tick() side by side on
+ *               two copies of the tree, compares every node's state after
+ *               each tick and times both; it exits non-zero on a mismatch
+ *   Every leaf name used in the XML must be listed; its callback is the C
+ *   function symbol (the name itself without "=symbol").
+ *
+ * In test mode the stubs return pseudo-random statuses drawn from a
+ * per-tree generator, so both copies see the same outcomes as long as they
+ * call the same leaves in the same order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bt_codegen.h"
+#include "bt_registry.h"
+#include "bt_xml.h"
+
+/* ===== Constants ===== */
+
+#define CODEGEN_CHECK_TICKS (20000U)  /* Compared ticks in test mode */
+#define CODEGEN_BENCH_TICKS (1000000U) /* Timed ticks per engine in test mode */
+
+/* ===== Helpers ===== */
+
+/* Leaves are registered with this callback and told apart by user_data. */
+static bt_status_t codegen_leaf(bt_node_t* node) {
+  (void)node;
+  return BT_ERROR;
+}
+
+static void codegen_usage(const char* argv0) {
+  (void)fprintf(stderr, "usage: %s [-n name] [-o out.c] [-t] tree.xml Leaf[=symbol]...\n", argv0);
+}
+
+/* Read a whole file; NULL on error. */
+static char* codegen_read(const char* path, size_t* len) {
+  FILE* in = fopen(path, "rb");
+  char* text = NULL;
+  size_t size = 0U;
+  size_t cap = 0U;
+  int ok = (in != NULL);
+  int done = 0;
+
+  while (ok && (done == 0)) {
+    if (size == cap) {
+      char* grown = realloc(text, (cap == 0U) ? 4096U : (cap * 2U));
+
+      ok = (grown != NULL);
+      text = ok ? grown : text;
+      cap = ok ? ((cap == 0U) ? 4096U : (cap * 2U)) : cap;
+    } else {
+      size += fread(text + size, 1U, cap - size, in);
+      ok = (ferror(in) == 0);
+      done = (size < cap); /* Short read: end of file */
+    }
+  }
+
+  if (in != NULL) {
+    (void)fclose(in);
+  }
+  if (!ok) {
+    free(text);
+    text = NULL;
+  } else {
+    *len = size;
+  }
+
+  return text;
+}
+
+/* Write text as a C string literal. */
+static void codegen_string(FILE* out, const char* text) {
+  const char* p;
+
+  (void)fputc('"', out);
+  for (p = text; *p != '\0'; p++) {
+    if ((*p == '"') || (*p == '\\')) {
+      (void)fprintf(out, "\\%c", *p);
+    } else if ((unsigned char)*p < 0x20U) {
+      (void)fprintf(out, "\\%03o", (unsigned)(unsigned char)*p);
+    } else {
+      (void)fputc(*p, out);
+    }
+  }
+  (void)fputc('"', out);
+}
+
+/* True when symbols[i] is the first entry with its symbol. */
+static int codegen_first(const bt_codegen_symbol_t symbols[], uint16_t i) {
+  uint16_t j;
+  int first = 1;
+
+  for (j = 0U; (first != 0) && (j < i); j++) {
+    first = (strcmp(symbols[j].symbol, symbols[i].symbol) != 0);
+  }
+
+  return first;
+}
+
+/* Test mode: stub leaves, the XML as bytes and a comparing main(). */
+static void codegen_harness(FILE* out, const char* name, const char* text, size_t len,
+                            const bt_codegen_symbol_t symbols[], uint16_t count, uint32_t capacity) {
+  size_t i;
+  uint16_t k;
+
+  (void)fprintf(out,
+                "\n/* ===== Check harness (bt_codegen -t) ===== */\n\n"
+                "#include <stdio.h>\n#include <stdlib.h>\n#include <time.h>\n\n"
+                "#include \"bt_registry.h\"\n#include \"bt_xml.h\"\n\n"
+                "typedef struct {\n  uint32_t rng;\n} %s_world_t;\n\n"
+                "static bt_status_t %s_outcome(bt_node_t* node, uint32_t salt) {\n"
+                "  %s_world_t* world = (%s_world_t*)node->blackboard;\n"
+                "  uint32_t x = world->rng;\n\n"
+                "  x ^= x << 13;\n  x ^= x >> 17;\n  x ^= x << 5;\n"
+                "  world->rng = x;\n"
+                "  x = ((x ^ salt) * 2654435761U) >> 24;\n\n"
+                "  return (x < 64U) ? BT_RUNNING : ((x < 144U) ? BT_FAILURE : BT_SUCCESS);\n"
+                "}\n\n",
+                name, name, name, name);
+
+  for (k = 0U; k < count; k++) {
+    if (codegen_first(symbols, k) != 0) {
+      (void)fprintf(out, "bt_status_t %s(bt_node_t* node) { return %s_outcome(node, %uU); }\n", symbols[k].symbol,
+                    name, (unsigned)k * 0x9E3779B9U);
+    }
+  }
+
+  (void)fprintf(out, "\nstatic const char %s_xml[] = {", name);
+  for (i = 0U; i < len; i++) {
+    (void)fprintf(out, "%s%u,", ((i % 16U) == 0U) ? "\n    " : " ", (unsigned)(unsigned char)text[i]);
+  }
+  (void)fprintf(out, "\n};\n\n");
+
+  (void)fprintf(out,
+                "static bt_node_t* %s_load(const bt_registry_t* reg, void* world) {\n"
+                "  bt_xml_result_t res;\n"
+                "  void* arena = NULL;\n\n"
+                "  if (bt_xml_load(%s_xml, sizeof(%s_xml), reg, world, NULL, 0U, &res) == BT_SUCCESS) {\n"
+                "    arena = malloc(res.used);\n"
+                "  }\n"
+                "  if ((arena == NULL) || (bt_xml_load(%s_xml, sizeof(%s_xml), reg, world, arena, res.used, &res) != "
+                "BT_SUCCESS)) {\n"
+                "    (void)fprintf(stderr, \"load failed: line %%u: %%s\\n\", (unsigned)res.line,\n"
+                "                  (res.error != NULL) ? res.error : \"out of memory\");\n"
+                "    free(arena);\n"
+                "    res.root = NULL;\n"
+                "  }\n\n"
+                "  return res.root; /* Arena kept until exit */\n"
+                "}\n\n",
+                name, name, name, name, name);
+
+  (void)fprintf(out,
+                "static double %s_now(void) {\n"
+                "  struct timespec ts;\n\n"
+                "  (void)clock_gettime(CLOCK_MONOTONIC, &ts);\n"
+                "  return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;\n"
+                "}\n\n",
+                name);
+
+  (void)fprintf(out,
+                "int main(void) {\n"
+                "  static bt_registry_entry_t entries[%uU];\n"
+                "  static bt_node_t* a[%s_NODES];\n"
+                "  static bt_node_t* b[%s_NODES];\n"
+                "  %s_world_t world_a = {0x2545F491U};\n"
+                "  %s_world_t world_b = {0x2545F491U};\n"
+                "  bt_registry_t reg;\n"
+                "  bt_node_t* root_a = NULL;\n"
+                "  bt_node_t* root_b = NULL;\n"
+                "  double t0 = 0.0;\n"
+                "  double t1 = 0.0;\n"
+                "  double t2 = 0.0;\n"
+                "  unsigned t;\n"
+                "  unsigned i;\n"
+                "  int ok = (bt_registry_init(&reg, entries, %uU) == BT_SUCCESS);\n\n",
+                (unsigned)capacity, name, name, name, name, (unsigned)capacity);
+  for (k = 0U; k < count; k++) {
+    (void)fprintf(out, "  ok = ok && (bt_registry_add(&reg, ");
+    codegen_string(out, (const char*)symbols[k].user_data);
+    (void)fprintf(out, ", BT_ACTION, %s, NULL) == BT_SUCCESS);\n", symbols[k].symbol);
+  }
+  (void)fprintf(out,
+                "  root_a = ok ? %s_load(&reg, &world_a) : NULL;\n"
+                "  root_b = ok ? %s_load(&reg, &world_b) : NULL;\n"
+                "  ok = (%s_bind(root_a, a) == BT_SUCCESS) && (%s_bind(root_b, b) == BT_SUCCESS);\n"
+                "  if (!ok) {\n"
+                "    (void)fprintf(stderr, \"%s: tree does not match the generated code\\n\");\n"
+                "  }\n\n"
+                "  /* Same outcomes in the same order: every node must end each tick alike */\n"
+                "  for (t = 0U; ok && (t < %uU); t++) {\n"
+                "    const bt_status_t sa = bt_tick(root_a);\n"
+                "    const bt_status_t sb = %s_tick(b);\n\n"
+                "    ok = (sa == sb);\n"
+                "    for (i = 0U; ok && (i < %s_NODES); i++) {\n"
+                "      const bt_parallel_t* pa = (const bt_parallel_t*)a[i]->ext;\n"
+                "      const bt_parallel_t* pb = (const bt_parallel_t*)b[i]->ext;\n\n"
+                "      ok = (a[i]->status == b[i]->status) && (a[i]->current_child == b[i]->current_child) &&\n"
+                "           ((a[i]->type != BT_PARALLEL) ||\n"
+                "            ((pa->done_mask == pb->done_mask) && (pa->success_mask == pb->success_mask)));\n"
+                "    }\n"
+                "    if (!ok) {\n"
+                "      (void)fprintf(stderr, \"%s: mismatch at tick %%u\\n\", t);\n"
+                "    }\n"
+                "  }\n\n"
+                "  if (ok) {\n"
+                "    t0 = %s_now();\n"
+                "    for (t = 0U; t < %uU; t++) {\n"
+                "      (void)bt_tick(root_a);\n"
+                "    }\n"
+                "    t1 = %s_now();\n"
+                "    for (t = 0U; t < %uU; t++) {\n"
+                "      (void)%s_tick(b);\n"
+                "    }\n"
+                "    t2 = %s_now();\n"
+                "    (void)printf(\"%s: %%u ticks match; bt_tick %%.1f ns/tick, generated %%.1f ns/tick\\n\", %uU,\n"
+                "                 (t1 - t0) / %u.0, (t2 - t1) / %u.0);\n"
+                "  }\n\n"
+                "  return ok ? 0 : 1;\n"
+                "}\n",
+                name, name, name, name, name, CODEGEN_CHECK_TICKS, name, name, name, name, CODEGEN_BENCH_TICKS, name,
+                CODEGEN_BENCH_TICKS, name, name, name, CODEGEN_CHECK_TICKS, CODEGEN_BENCH_TICKS, CODEGEN_BENCH_TICKS);
+}
+
+/* ===== Main ===== */
+
+int main(int argc, char** argv) {
+  const char* name = "bt_tree";
+  const char* out_path = NULL;
+  const char* path = NULL;
+  bt_codegen_symbol_t* symbols = calloc((size_t)argc, sizeof(*symbols));
+  bt_registry_entry_t* entries = NULL;
+  uint32_t capacity = 2U;
+  uint16_t count = 0U;
+  int test = 0;
+  int rc = 1;
+  int i;
+
+  for (i = 1; (symbols != NULL) && (i < argc); i++) {
+    if (strcmp(argv[i], "-t") == 0) {
+      test = 1;
+    } else if ((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc)) {
+      name = argv[i + 1];
+      i++;
+    } else if ((strcmp(argv[i], "-o") == 0) && ((i + 1) < argc)) {
+      out_path = argv[i + 1];
+      i++;
+    } else if (path == NULL) {
+      path = argv[i];
+    } else {
+      char* eq = strchr(argv[i], '=');
+
+      /* "Leaf=symbol" is split in place; the registry keeps the name */
+      if (eq != NULL) {
+        *eq = '\0';
+      }
+      symbols[count].tick = codegen_leaf;
+      symbols[count].user_data = argv[i];
+      symbols[count].symbol = (eq != NULL) ? (eq + 1) : argv[i];
+      count++;
+    }
+  }
+
+  while (capacity <= (2U * (uint32_t)count)) {
+    capacity *= 2U;
+  }
+  entries = calloc(capacity, sizeof(*entries));
+
+  if ((path == NULL) || (symbols == NULL) || (entries == NULL)) {
+    codegen_usage(argv[0]);
+  } else {
+    bt_registry_t reg;
+    bt_xml_result_t res;
+    size_t len = 0U;
+    char* text = codegen_read(path, &len);
+    void* arena = NULL;
+    int ok = (bt_registry_init(&reg, entries, capacity) == BT_SUCCESS);
+    uint16_t k;
+
+    for (k = 0U; ok && (k < count); k++) {
+      ok = (bt_registry_add(&reg, (const char*)symbols[k].user_data, BT_ACTION, codegen_leaf,
+                            (void*)symbols[k].user_data) == BT_SUCCESS);
+      if (!ok) {
+        (void)fprintf(stderr, "%s: leaf %s listed twice\n", argv[0], (const char*)symbols[k].user_data);
+      }
+    }
+
+    if (text == NULL) {
+      (void)fprintf(stderr, "%s: cannot read %s\n", argv[0], path);
+    } else if (ok && (bt_xml_load(text, len, &reg, NULL, NULL, 0U, &res) == BT_SUCCESS) &&
+               ((arena = malloc(res.used)) != NULL) &&
+               (bt_xml_load(text, len, &reg, NULL, arena, res.used, &res) == BT_SUCCESS)) {
+      FILE* out = (out_path != NULL) ? fopen(out_path, "w") : stdout;
+
+      if (out == NULL) {
+        (void)fprintf(stderr, "%s: cannot create %s\n", argv[0], out_path);
+      } else {
+        if (test != 0) {
+          (void)fprintf(out, "#define _POSIX_C_SOURCE 200809L\n\n");
+        }
+        if (bt_codegen_write(out, name, res.root, symbols, count) != BT_SUCCESS) {
+          (void)fprintf(stderr, "%s: cannot generate code for %s (is -n a C identifier?)\n", argv[0], path);
+        } else {
+          if (test != 0) {
+            codegen_harness(out, name, text, len, symbols, count, capacity);
+          }
+          rc = (fflush(out) == 0) ? 0 : 1;
+        }
+        if (out != stdout) {
+          (void)fclose(out);
+        }
+      }
+    } else if (ok) {
+      (void)fprintf(stderr, "%s:%u: %s\n", path, (unsigned)res.line,
+                    (res.error != NULL) ? res.error : "out of memory");
+    } else {
+      /* Reported above */
+    }
+
+    free(arena);
+    free(text);
+  }
+
+  free(entries);
+  free(symbols);
+
+  return rc;
+}
@@ -0,0 +1,138 @@
+/*
+ * bt_trace_dump.c
+ *
+ * Decoder for trace files written by bt_trace_write().
+ *
+ * Usage:
+ *   bt_trace_dump [-c] [-n id] trace.bin
+ *     -c     CSV output (seq,time_ns,node,from,to)
+ *     -n id  only show transitions of node id
+ *
+ * Times are printed relative to the first record, in ns when the file
+ * carries a clock rate and in raw bt_trace_clock() ticks otherwise.
+ * Gaps in the sequence numbers (records lost to ring wrap-around before the
+ * snapshot) are reported.
+ */
+
+#include "bt_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ===== Helpers ===== */
+
+static const char* dump_status(uint8_t status) {
+  const char* name = "?";
+
+  switch (status) {
+    case BT_SUCCESS:
+      name = "SUCCESS";
+      break;
+    case BT_FAILURE:
+      name = "FAILURE";
+      break;
+    case BT_RUNNING:
+      name = "RUNNING";
+      break;
+    case BT_ERROR:
+      name = "ERROR";
+      break;
+    default:
+      name = "?";
+      break;
+  }
+
+  return name;
+}
+
+/* Convert a tick delta to ns (or keep ticks when the rate is unknown). */
+static uint64_t dump_time(uint64_t ticks, uint64_t hz) {
+  return (hz != 0U) ? (uint64_t)(((double)ticks * 1e9) / (double)hz) : ticks;
+}
+
+static void dump_usage(const char* argv0) { (void)fprintf(stderr, "usage: %s [-c] [-n id] trace.bin\n", argv0); }
+
+/* ===== Main ===== */
+
+int main(int argc, char** argv) {
+  const char* path = NULL;
+  int csv = 0;
+  long only = -1;
+  int rc = 1;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-c") == 0) {
+      csv = 1;
+    } else if ((strcmp(argv[i], "-n") == 0) && ((i + 1) < argc)) {
+      only = strtol(argv[i + 1], NULL, 0);
+      i++;
+    } else {
+      path = argv[i];
+    }
+  }
+
+  if (path == NULL) {
+    dump_usage(argv[0]);
+  } else {
+    FILE* in = fopen(path, "rb");
+    uint32_t tag = 0U;
+    uint64_t hz = 0U;
+    uint64_t count = 0U;
+
+    if (in == NULL) {
+      (void)fprintf(stderr, "%s: cannot open %s\n", argv[0], path);
+    } else if (bt_trace_read_header(in, &tag, &hz, &count) != BT_SUCCESS) {
+      (void)fprintf(stderr, "%s: %s is not a version %u trace\n", argv[0], path, (unsigned)BT_TRACE_VERSION);
+      (void)fclose(in);
+    } else {
+      bt_trace_rec_t rec;
+      uint64_t t0 = 0U;
+      uint64_t read = 0U;
+      uint32_t expect = 0U;
+
+      if (csv != 0) {
+        (void)printf("seq,time_%s,node,from,to\n", (hz != 0U) ? "ns" : "ticks");
+      } else {
+        (void)printf("# tag %u, %llu records, clock %llu Hz\n", (unsigned)tag, (unsigned long long)count,
+                     (unsigned long long)hz);
+      }
+
+      while ((read < count) && (bt_trace_read_rec(in, &rec) == BT_SUCCESS)) {
+        uint64_t t = 0U;
+
+        if (read == 0U) {
+          t0 = rec.time;
+        } else if ((rec.seq != expect) && (csv == 0)) {
+          (void)printf("# %u records missing\n", (unsigned)(rec.seq - expect));
+        } else {
+          /* In sequence */
+        }
+        t = dump_time(rec.time - t0, hz);
+        expect = rec.seq + 1U;
+        read++;
+
+        if ((only >= 0) && ((long)rec.node != only)) {
+          /* Filtered out */
+        } else if (csv != 0) {
+          (void)printf("%u,%llu,%u,%s,%s\n", (unsigned)rec.seq, (unsigned long long)t, (unsigned)rec.node,
+                       dump_status(rec.from), dump_status(rec.to));
+        } else {
+          (void)printf("%10u %14llu %s  node %5u  %-7s -> %s\n", (unsigned)rec.seq, (unsigned long long)t,
+                       (hz != 0U) ? "ns" : "ticks", (unsigned)rec.node, dump_status(rec.from), dump_status(rec.to));
+        }
+      }
+
+      if (read != count) {
+        (void)fprintf(stderr, "%s: %s truncated after %llu of %llu records\n", argv[0], path,
+                      (unsigned long long)read, (unsigned long long)count);
+      } else {
+        rc = 0;
+      }
+      (void)fclose(in);
+    }
+  }
+
+  return rc;
+}